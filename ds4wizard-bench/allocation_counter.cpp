@@ -0,0 +1,87 @@
+#include <cstdlib>
+#include <new>
+
+#include "allocation_counter.h"
+
+// Replacing the global allocation functions in the executable counts every
+// allocation made by the benchmarked code without changing how it allocates.
+
+namespace
+{
+	thread_local size_t allocations = 0;
+	thread_local size_t bytes = 0;
+
+	void* allocate(size_t size)
+	{
+		++allocations;
+		bytes += size;
+
+		void* result = std::malloc(size ? size : 1);
+
+		if (result == nullptr)
+		{
+			throw std::bad_alloc();
+		}
+
+		return result;
+	}
+}
+
+AllocationCount allocationCount()
+{
+	return { allocations, bytes };
+}
+
+void* operator new(size_t size)
+{
+	return allocate(size);
+}
+
+void* operator new[](size_t size)
+{
+	return allocate(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+	try
+	{
+		return allocate(size);
+	}
+	catch (const std::bad_alloc&)
+	{
+		return nullptr;
+	}
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept
+{
+	try
+	{
+		return allocate(size);
+	}
+	catch (const std::bad_alloc&)
+	{
+		return nullptr;
+	}
+}
+
+void operator delete(void* ptr) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept
+{
+	std::free(ptr);
+}
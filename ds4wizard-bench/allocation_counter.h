@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstddef>
+
+/**
+ * \brief Heap allocations made through the global \c operator new by the calling thread since it started.
+ * Allocations made inside other modules (e.g. Qt) are not seen.
+ */
+struct AllocationCount
+{
+	size_t allocations;
+	size_t bytes;
+};
+
+/**
+ * \brief Gets the allocation count of the calling thread.
+ * Subtract two counts to get the allocations made in between.
+ */
+AllocationCount allocationCount();
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "allocation_counter.h"
+
+/**
+ * \brief Keeps the compiler from discarding the computation of \p value.
+ */
+template <typename T>
+inline void doNotOptimize(const T& value)
+{
+	static_cast<void>(*reinterpret_cast<const volatile char*>(&value));
+	std::atomic_signal_fence(std::memory_order_seq_cst);
+}
+
+struct BenchmarkResult
+{
+	std::string name;
+	size_t iterations;
+	double nsPerOp;
+	double allocationsPerOp;
+	double bytesPerOp;
+};
+
+/**
+ * \brief Times operations in batches large enough to run for at least \c minTime,
+ * and counts the heap allocations they make.
+ */
+class BenchmarkRunner
+{
+	std::chrono::nanoseconds minTime;
+	std::string filter;
+	std::vector<BenchmarkResult> results_;
+
+public:
+	/**
+	 * \param minTime Minimum time a measured batch of iterations must take.
+	 * \param filter If not empty, only benchmarks whose name contains it are run.
+	 */
+	BenchmarkRunner(std::chrono::nanoseconds minTime, std::string filter)
+		: minTime(minTime),
+		  filter(std::move(filter))
+	{
+	}
+
+	/**
+	 * \brief Runs and prints a benchmark.
+	 * \param name Name to print and filter by.
+	 * \param op Called once per operation with the index of the iteration.
+	 */
+	template <typename F>
+	void run(const std::string& name, F&& op)
+	{
+		if (!filter.empty() && name.find(filter) == std::string::npos)
+		{
+			return;
+		}
+
+		// warm up caches and let lazily initialized state allocate outside the measurement
+		for (size_t i = 0; i < 16; ++i)
+		{
+			op(i);
+		}
+
+		size_t iterations = 1;
+
+		for (;;)
+		{
+			const AllocationCount allocStart = allocationCount();
+			const auto start = std::chrono::steady_clock::now();
+
+			for (size_t i = 0; i < iterations; ++i)
+			{
+				op(i);
+			}
+
+			const auto elapsed = std::chrono::steady_clock::now() - start;
+			const AllocationCount allocEnd = allocationCount();
+
+			if (elapsed >= minTime || iterations >= (size_t(1) << 32))
+			{
+				const auto n = static_cast<double>(iterations);
+
+				BenchmarkResult result;
+				result.name             = name;
+				result.iterations       = iterations;
+				result.nsPerOp          = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()) / n;
+				result.allocationsPerOp = static_cast<double>(allocEnd.allocations - allocStart.allocations) / n;
+				result.bytesPerOp       = static_cast<double>(allocEnd.bytes - allocStart.bytes) / n;
+
+				printf("%-48s %12zu %12.1f %12.2f %12.1f\n", result.name.c_str(), result.iterations,
+				       result.nsPerOp, result.allocationsPerOp, result.bytesPerOp);
+
+				results_.push_back(std::move(result));
+				return;
+			}
+
+			// aim a little past minTime so the next batch is very likely the last
+			const double ratio = elapsed.count() > 0
+			                     ? static_cast<double>(minTime.count()) / static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count())
+			                     : 100.0;
+
+			iterations = static_cast<size_t>(static_cast<double>(iterations) * std::min(std::max(ratio * 1.2, 2.0), 100.0));
+		}
+	}
+
+	static void printHeader()
+	{
+		printf("%-48s %12s %12s %12s %12s\n", "benchmark", "iterations", "ns/op", "allocs/op", "bytes/op");
+	}
+
+	[[nodiscard]] const std::vector<BenchmarkResult>& results() const
+	{
+		return results_;
+	}
+};
@@ -0,0 +1,725 @@
+#include "pch.h"
+
+#include <array>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include <fmt/format.h>
+#include <hid_loopback.h>
+
+#include "DeviceProfile.h"
+#include "Ds4Device.h"
+#include "IOutputSink.h"
+#include "Trackball.h"
+
+#include "allocation_counter.h"
+#include "benchmark.h"
+#include "input_benchmarks.h"
+
+namespace
+{
+	/**
+	 * \brief Number of distinct reports cycled through, enough to cover a full motion of every input.
+	 */
+	constexpr size_t reportCount = 64;
+
+	constexpr size_t usbReportSize       = 64;
+	constexpr size_t bluetoothReportSize = 547;
+	constexpr size_t usbOffset           = 1;
+	constexpr size_t bluetoothOffset     = 3;
+
+	/**
+	 * \brief Time between USB input reports of a real controller.
+	 */
+	constexpr std::chrono::milliseconds reportInterval(4);
+
+	constexpr short touchpadWidth  = 1920;
+	constexpr short touchpadHeight = 943;
+
+	constexpr std::array<Ds4Buttons::T, 16> bindingButtons = {
+		Ds4Buttons::square, Ds4Buttons::cross, Ds4Buttons::circle, Ds4Buttons::triangle,
+		Ds4Buttons::l1, Ds4Buttons::r1, Ds4Buttons::l2, Ds4Buttons::r2,
+		Ds4Buttons::share, Ds4Buttons::options, Ds4Buttons::l3, Ds4Buttons::r3,
+		Ds4Buttons::up, Ds4Buttons::down, Ds4Buttons::left, Ds4Buttons::right
+	};
+
+	constexpr std::array<Ds4Buttons::T, 4> modifierButtons = {
+		Ds4Buttons::l1, Ds4Buttons::r1, Ds4Buttons::share, Ds4Buttons::options
+	};
+
+	constexpr std::array<Ds4Axes::T, 6> bindingAxes = {
+		Ds4Axes::leftStickX, Ds4Axes::leftStickY, Ds4Axes::rightStickX, Ds4Axes::rightStickY,
+		Ds4Axes::leftTrigger, Ds4Axes::rightTrigger
+	};
+
+	class NullOutputSink : public IOutputSink
+	{
+	public:
+		void keyboardKey(int, bool) override {}
+		void mouseButton(MouseButton, bool) override {}
+		void mouseMove(int, int) override {}
+		void xinputState(const XInputGamepad&) override {}
+	};
+
+	void writeTouchPoint(uint8_t* dest, short x, short y)
+	{
+		dest[0] = static_cast<uint8_t>(x & 0xFF);
+		dest[1] = static_cast<uint8_t>(((x >> 8) & 0x0F) | ((y & 0x0F) << 4));
+		dest[2] = static_cast<uint8_t>((y >> 4) & 0xFF);
+	}
+
+	void writeShort(uint8_t* dest, int16_t value)
+	{
+		dest[0] = static_cast<uint8_t>(value & 0xFF);
+		dest[1] = static_cast<uint8_t>((value >> 8) & 0xFF);
+	}
+
+	/**
+	 * \brief Fills the input portion of a report (after the report ID and, for Bluetooth, its header)
+	 * with a controller in use: sticks circling, triggers ramping, buttons changing every few reports
+	 * and a finger dragged across the touch pad and lifted now and then.
+	 */
+	void fillInput(uint8_t* input, size_t index)
+	{
+		const float angle = static_cast<float>(index) / static_cast<float>(reportCount) * 6.2831853f;
+
+		input[0] = static_cast<uint8_t>(128.0f + 100.0f * std::cos(angle));
+		input[1] = static_cast<uint8_t>(128.0f + 100.0f * std::sin(angle));
+		input[2] = static_cast<uint8_t>(128.0f - 100.0f * std::sin(angle));
+		input[3] = static_cast<uint8_t>(128.0f + 100.0f * std::cos(angle));
+
+		// the low 4 bits are the hat switch; 8 is centered
+		Ds4ButtonsRaw_t buttons = 8;
+
+		if ((index / 8) % 2)
+		{
+			buttons |= Ds4ButtonsRaw::cross | Ds4ButtonsRaw::l1;
+		}
+
+		if ((index / 4) % 2)
+		{
+			buttons |= Ds4ButtonsRaw::square;
+		}
+
+		input[4] = static_cast<uint8_t>(buttons & 0xFF);
+		input[5] = static_cast<uint8_t>((buttons >> 8) & 0xFF);
+		input[6] = static_cast<uint8_t>(((buttons >> 16) & 0x03) | ((index & 0x3F) << 2));
+		input[7] = static_cast<uint8_t>(index * 4);
+		input[8] = static_cast<uint8_t>(255 - index * 4);
+
+		// report timestamp in 5.33 microsecond units, one report interval apart
+		writeShort(&input[9], static_cast<int16_t>(index * 750));
+
+		for (size_t i = 0; i < 6; ++i)
+		{
+			writeShort(&input[12 + i * 2], static_cast<int16_t>(1000.0f * std::sin(angle + static_cast<float>(i))));
+		}
+
+		// extensions in the high nibble, battery level in the low one
+		input[29] = static_cast<uint8_t>((Ds4Extensions::cable << 4) | 5);
+		input[32] = 1;
+		input[33] = static_cast<uint8_t>(index & 0x3F);
+
+		const bool touching = (index % 16) < 12;
+
+		input[34] = static_cast<uint8_t>(touching ? 0x01 : 0x81);
+		writeTouchPoint(&input[35], static_cast<short>((index * 30) % touchpadWidth), static_cast<short>((index * 14) % touchpadHeight));
+
+		input[38] = 0x82;
+	}
+
+	/**
+	 * \brief Input state after each of the \c reportCount reports, so binding benchmarks
+	 * can switch between states without paying for report parsing.
+	 */
+	std::vector<Ds4Input> makeInputStates()
+	{
+		std::vector<Ds4Input> states;
+		states.reserve(reportCount);
+
+		Ds4Input input;
+		std::array<uint8_t, usbReportSize> report {};
+
+		for (size_t i = 0; i < reportCount; ++i)
+		{
+			fillInput(&report[usbOffset], i);
+			input.update(gsl::span<uint8_t>(&report[usbOffset], usbReportSize - usbOffset));
+			states.push_back(input);
+		}
+
+		return states;
+	}
+
+	InputMap makeBinding(size_t index)
+	{
+		switch (index % 4)
+		{
+			case 0:
+			{
+				InputMap map(SimulatorType::input, InputType::button, OutputType::keyboard);
+				map.inputButtons = bindingButtons[index % bindingButtons.size()];
+				map.keyCode = static_cast<VirtualKeyCode>('A' + index % 26);
+				return map;
+			}
+
+			case 1:
+			{
+				InputMap map(SimulatorType::input, InputType::button, OutputType::xinput);
+				map.inputButtons = bindingButtons[index % bindingButtons.size()];
+				map.xinputButtons = XInputButtons_values[index % XInputButtons_values.size()];
+				return map;
+			}
+
+			case 2:
+			{
+				XInputAxes axes;
+				axes.axes = XInputAxis_values[index % XInputAxis_values.size()];
+
+				InputMap map(SimulatorType::input, InputType::axis, OutputType::xinput);
+				map.inputAxes = bindingAxes[index % bindingAxes.size()];
+				map.xinputAxes = axes;
+				return map;
+			}
+
+			default:
+			{
+				MouseAxes axes;
+				axes.directions = (index / 4) % 2 ? Direction::right : Direction::down;
+
+				InputMap map(SimulatorType::input, InputType::axis, OutputType::mouse);
+				map.inputAxes = bindingAxes[index % 4];
+				map.mouseAxes = axes;
+				return map;
+			}
+		}
+	}
+
+	/**
+	 * \brief Makes a profile with \p bindingCount bindings and \p modifierCount modifier sets
+	 * of four bindings each. Modifiers share buttons with the bindings so overrides are exercised.
+	 */
+	DeviceProfile makeBindingProfile(size_t bindingCount, size_t modifierCount)
+	{
+		DeviceProfile profile;
+		profile.name = "benchmark";
+
+		for (size_t i = 0; i < bindingCount; ++i)
+		{
+			profile.bindings.push_back(makeBinding(i));
+		}
+
+		for (size_t i = 0; i < modifierCount; ++i)
+		{
+			InputModifier modifier(InputType::button, modifierButtons[i % modifierButtons.size()]);
+
+			for (size_t j = 0; j < 4; ++j)
+			{
+				modifier.bindings.push_back(makeBinding(i * 4 + j));
+			}
+
+			profile.modifiers.push_back(std::move(modifier));
+		}
+
+		return profile;
+	}
+
+	InputMap makeMotionBinding(Ds4Axes_t axis, AxisPolarity polarity, OutputType::T outputType)
+	{
+		InputMap map(SimulatorType::input, InputType::axis, outputType);
+		map.inputAxes = axis;
+		map.inputAxisOptions[axis] = InputAxisOptions(polarity);
+
+		if (outputType == OutputType::mouse)
+		{
+			MouseAxes axes;
+			axes.directions = axis == Ds4Axes::gyroY
+			                  ? (polarity == +AxisPolarity::positive ? Direction::right : Direction::left)
+			                  : (polarity == +AxisPolarity::positive ? Direction::up : Direction::down);
+			map.mouseAxes = axes;
+		}
+		else
+		{
+			XInputAxes axes;
+			axes.axes = axis == Ds4Axes::gyroY ? XInputAxis::rightStickX : XInputAxis::rightStickY;
+			axes.options[axes.axes] = AxisOptions(polarity);
+			map.xinputAxes = axes;
+		}
+
+		return map;
+	}
+
+	/**
+	 * \brief Makes a profile aiming with the gyroscope: yaw and pitch in both
+	 * directions bound to the mouse and to the right stick.
+	 */
+	DeviceProfile makeMotionProfile()
+	{
+		DeviceProfile profile;
+		profile.name = "benchmark";
+
+		for (OutputType::T outputType : { OutputType::mouse, OutputType::xinput })
+		{
+			for (Ds4Axes_t axis : { Ds4Axes::gyroX, Ds4Axes::gyroY })
+			{
+				profile.bindings.push_back(makeMotionBinding(axis, AxisPolarity::positive, outputType));
+				profile.bindings.push_back(makeMotionBinding(axis, AxisPolarity::negative, outputType));
+			}
+		}
+
+		return profile;
+	}
+
+	/**
+	 * \brief Makes a profile whose square and cross buttons each play a macro of \p eventCount
+	 * key presses, releases and mouse moves a quarter of a millisecond apart.
+	 */
+	DeviceProfile makeMacroProfile(size_t eventCount)
+	{
+		DeviceProfile profile;
+		profile.name = "benchmark";
+
+		std::string events;
+
+		for (size_t i = 0; i < eventCount / 4; ++i)
+		{
+			events += fmt::format("k+{0} m1,-1 w250 k-{0} m-1,1 w250 ", static_cast<int>('A' + i % 26));
+		}
+
+		profile.macros["benchmark"] = Macro::parse(events);
+
+		for (Ds4Buttons::T button : { Ds4Buttons::square, Ds4Buttons::cross })
+		{
+			InputMap map(SimulatorType::action, InputType::button, OutputType::none);
+			map.inputButtons = button;
+			map.action = ActionType::macro;
+			map.macro = "benchmark";
+			profile.bindings.push_back(std::move(map));
+		}
+
+		return profile;
+	}
+
+	/**
+	 * \brief Makes a profile with \p regionCount button regions tiling the touch pad,
+	 * every other one allowing cross-over.
+	 */
+	DeviceProfile makeTouchProfile(size_t regionCount)
+	{
+		DeviceProfile profile;
+		profile.name = "benchmark";
+
+		const auto columns = static_cast<size_t>(std::ceil(std::sqrt(static_cast<double>(regionCount))));
+		const size_t rows  = (regionCount + columns - 1) / columns;
+
+		const auto width  = static_cast<short>(touchpadWidth / columns);
+		const auto height = static_cast<short>(touchpadHeight / rows);
+
+		for (size_t i = 0; i < regionCount; ++i)
+		{
+			const auto left = static_cast<short>((i % columns) * width);
+			const auto top  = static_cast<short>((i / columns) * height);
+
+			profile.touchRegions.emplace(fmt::format("region {}", i),
+			                             Ds4TouchRegion(Ds4TouchRegionType::button, left, top,
+			                                            static_cast<short>(left + width - 1), static_cast<short>(top + height - 1),
+			                                            i % 2 == 0));
+		}
+
+		return profile;
+	}
+
+	/**
+	 * \brief Makes a profile that uses every path of the device loop that keeps state between reports:
+	 * bindings and modifiers, toggles and rapid fire, touch pad button regions, a vibrating trackball,
+	 * gestures, gyro aiming and macro playback.
+	 */
+	DeviceProfile makeAllocationProfile()
+	{
+		DeviceProfile profile = makeBindingProfile(100, 10);
+
+		for (size_t i = 0; i < profile.bindings.size(); i += 8)
+		{
+			InputMap& map = profile.bindings[i];
+
+			if (map.inputType != InputType::button)
+			{
+				continue;
+			}
+
+			if ((i / 8) % 2)
+			{
+				map.toggle = true;
+			}
+			else
+			{
+				map.rapidFire = true;
+				map.rapidFireInterval = reportInterval * 3;
+			}
+		}
+
+		DeviceProfile motion = makeMotionProfile();
+
+		for (InputMap& map : motion.bindings)
+		{
+			profile.bindings.push_back(std::move(map));
+		}
+
+		DeviceProfile macros = makeMacroProfile(64);
+		profile.macros = std::move(macros.macros);
+
+		for (InputMap& map : macros.bindings)
+		{
+			profile.bindings.push_back(std::move(map));
+		}
+
+		profile.touchRegions = makeTouchProfile(16).touchRegions;
+
+		for (size_t i = 0; i < 16; i += 4)
+		{
+			InputMap map(SimulatorType::input, InputType::touchRegion, OutputType::keyboard);
+			map.inputTouchRegion = fmt::format("region {}", i);
+			map.keyCode = static_cast<VirtualKeyCode>('A' + i);
+			profile.bindings.push_back(std::move(map));
+		}
+
+		auto settings = std::make_shared<TrackballSettings>();
+		settings->touchVibration.enabled = true;
+		settings->ballVibration.enabled  = true;
+
+		Ds4TouchRegion trackball(Ds4TouchRegionType::trackball, 0, 0, touchpadWidth - 1, touchpadHeight - 1, true);
+		trackball.trackballSettings = std::move(settings);
+		profile.touchRegions.emplace("trackball", std::move(trackball));
+
+		for (Direction::T direction : { Direction::up, Direction::down, Direction::left, Direction::right })
+		{
+			MouseAxes axes;
+			axes.directions = direction;
+
+			InputMap map(SimulatorType::input, InputType::touchRegion, OutputType::mouse);
+			map.inputTouchRegion = "trackball";
+			map.inputTouchDirection = direction;
+			map.mouseAxes = axes;
+			profile.bindings.push_back(std::move(map));
+		}
+
+		for (TouchGesture::T gesture : { TouchGesture::tap, TouchGesture::swipe, TouchGesture::flick })
+		{
+			InputMap map(SimulatorType::input, InputType::touchGesture, OutputType::keyboard);
+			map.inputTouchGesture = gesture;
+			map.keyCode = static_cast<VirtualKeyCode>(' ');
+			profile.bindings.push_back(std::move(map));
+		}
+
+		return profile;
+	}
+}
+
+/**
+ * \brief Clocks and scripted controller behind a device made by \c makeUsbDevice.
+ * Both clocks are advanced by \c reportInterval per pass so the device loop sees one report each time.
+ */
+struct InputBenchmarks::LoopbackDeviceRun
+{
+	VirtualClock clock;
+	std::shared_ptr<hid::LoopbackBackend> backend;
+	std::shared_ptr<hid::LoopbackDevice> usb;
+
+	void advance()
+	{
+		clock.advance(reportInterval);
+		backend->clock->advance(reportInterval);
+	}
+};
+
+void InputBenchmarks::run(BenchmarkRunner& runner)
+{
+	ds4Input(runner);
+
+	for (size_t count : { 10, 100, 1000 })
+	{
+		runMaps(runner, count, 0);
+		runMaps(runner, count, count / 10);
+	}
+
+	for (size_t count : { 4, 16, 64, 256 })
+	{
+		touchRegions(runner, count);
+	}
+
+	trackball(runner);
+	motion(runner);
+	macros(runner);
+	deviceRun(runner);
+}
+
+bool InputBenchmarks::checkAllocations()
+{
+	NullOutputSink sink;
+	LoopbackDeviceRun loopback;
+	const auto device = makeUsbDevice(makeAllocationProfile(), &sink, loopback);
+
+	const auto tick = [&]
+	{
+		loopback.advance();
+		device->run();
+	};
+
+	// let every binding, simulator and buffer reach its steady-state size
+	for (size_t i = 0; i < reportCount * 4; ++i)
+	{
+		tick();
+	}
+
+	constexpr size_t ticks = reportCount * 64;
+	const AllocationCount before = allocationCount();
+
+	for (size_t i = 0; i < ticks; ++i)
+	{
+		tick();
+	}
+
+	const AllocationCount after = allocationCount();
+	const size_t allocations = after.allocations - before.allocations;
+
+	printf("Ds4Device::run: %zu allocations (%zu bytes) over %zu ticks\n",
+	       allocations, after.bytes - before.bytes, ticks);
+
+	return allocations == 0;
+}
+
+std::unique_ptr<Ds4Device> InputBenchmarks::makeDevice(const DeviceProfile& profile, IOutputSink* sink)
+{
+	auto device = std::make_unique<Ds4Device>();
+	device->profile = profile;
+
+	device->simulator.setOutputSink(sink);
+	device->simulator.applyProfile(&device->profile);
+	device->simulator.start();
+
+	return device;
+}
+
+std::unique_ptr<Ds4Device> InputBenchmarks::makeUsbDevice(const DeviceProfile& profile, IOutputSink* sink, LoopbackDeviceRun& loopback)
+{
+	loopback.backend = std::make_shared<hid::LoopbackBackend>(std::make_shared<hid::LoopbackClock>(hid::LoopbackClock::Mode::manual));
+
+	hid::HidCaps caps {};
+	caps.inputReportSize  = usbReportSize;
+	caps.outputReportSize = 32;
+
+	loopback.usb = loopback.backend->addDevice(caps, {});
+	loopback.usb->recordReports = false;
+
+	std::vector<hid::LoopbackReport> script(reportCount);
+
+	for (size_t i = 0; i < reportCount; ++i)
+	{
+		script[i].time = reportInterval * i;
+		script[i].data.resize(usbReportSize);
+		script[i].data[0] = 0x01;
+		fillInput(&script[i].data[usbOffset], i);
+	}
+
+	loopback.usb->setInputScript(std::move(script), true, reportInterval);
+
+	auto device = makeDevice(profile, sink);
+
+	device->usbDevice = loopback.backend->create(loopback.usb->path);
+	device->usbDevice->readMetadata();
+	device->usbDevice->open(hid::HidOpenFlags::async);
+	device->setupUsbOutputBuffer();
+	device->beginRun();
+
+	return device;
+}
+
+void InputBenchmarks::ds4Input(BenchmarkRunner& runner)
+{
+	std::vector<std::array<uint8_t, usbReportSize>> usb(reportCount);
+	std::vector<std::array<uint8_t, bluetoothReportSize>> bluetooth(reportCount);
+
+	for (size_t i = 0; i < reportCount; ++i)
+	{
+		usb[i].fill(0);
+		usb[i][0] = 0x01;
+		fillInput(&usb[i][usbOffset], i);
+
+		bluetooth[i].fill(0);
+		bluetooth[i][0] = 0x11;
+		bluetooth[i][1] = 0xC0;
+		fillInput(&bluetooth[i][bluetoothOffset], i);
+	}
+
+	Ds4Input input;
+
+	runner.run("Ds4Input::update usb", [&](size_t i)
+	{
+		auto& report = usb[i % reportCount];
+		input.update(gsl::span<uint8_t>(&report[usbOffset], usbReportSize - usbOffset));
+		doNotOptimize(input.heldButtons);
+	});
+
+	runner.run("Ds4Input::update bluetooth", [&](size_t i)
+	{
+		auto& report = bluetooth[i % reportCount];
+		input.update(gsl::span<uint8_t>(&report[bluetoothOffset], bluetoothReportSize - bluetoothOffset));
+		doNotOptimize(input.heldButtons);
+	});
+
+	const std::vector<Ds4Input> states = makeInputStates();
+
+	runner.run("Ds4Input::getAxis x12", [&](size_t i)
+	{
+		const Ds4Input& state = states[i % reportCount];
+		float sum = 0.0f;
+
+		for (Ds4Axes_t axis : Ds4Axes_values)
+		{
+			sum += state.getAxis(axis, std::nullopt);
+		}
+
+		doNotOptimize(sum);
+	});
+
+	runner.run("Ds4Input::getAxis x12 with polarity", [&](size_t i)
+	{
+		const Ds4Input& state = states[i % reportCount];
+		const std::optional<AxisPolarity> polarity = i % 2 ? AxisPolarity::positive : AxisPolarity::negative;
+		float sum = 0.0f;
+
+		for (Ds4Axes_t axis : Ds4Axes_values)
+		{
+			sum += state.getAxis(axis, polarity);
+		}
+
+		doNotOptimize(sum);
+	});
+}
+
+void InputBenchmarks::runMaps(BenchmarkRunner& runner, size_t bindingCount, size_t modifierCount)
+{
+	NullOutputSink sink;
+	const auto device = makeDevice(makeBindingProfile(bindingCount, modifierCount), &sink);
+	const std::vector<Ds4Input> states = makeInputStates();
+
+	runner.run(fmt::format("InputSimulator::runMaps {} bindings, {} modifiers", bindingCount, modifierCount), [&](size_t i)
+	{
+		device->input = states[i % reportCount];
+		device->simulator.runMaps();
+	});
+}
+
+void InputBenchmarks::touchRegions(BenchmarkRunner& runner, size_t regionCount)
+{
+	NullOutputSink sink;
+	const auto device = makeDevice(makeTouchProfile(regionCount), &sink);
+	const std::vector<Ds4Input> states = makeInputStates();
+
+	runner.run(fmt::format("InputSimulator::updateTouchRegions {} regions", regionCount), [&](size_t i)
+	{
+		device->input = states[i % reportCount];
+		device->simulator.updateTouchRegions();
+	});
+}
+
+void InputBenchmarks::trackball(BenchmarkRunner& runner)
+{
+	NullOutputSink sink;
+	const auto device = makeDevice(DeviceProfile(), &sink);
+
+	Ds4TouchRegion region(Ds4TouchRegionType::trackball, 0, 0, touchpadWidth - 1, touchpadHeight - 1);
+	TrackballSimulator ball(TrackballSettings(), &region, &device->simulator);
+
+	runner.run("TrackballSimulator::update rolling", [&](size_t)
+	{
+		ball.velocity = Vector2(60.0f, 30.0f);
+		ball.update(1.0f);
+		doNotOptimize(ball.velocity);
+	});
+
+	// fill the touch history with a drag so the ball has a direction to follow
+	Ds4TouchHistoryRing history;
+	region.setHistory(&history);
+
+	Ds4InputData data {};
+	data.touch1 = true;
+
+	const Ds4TouchHistory::TimePoint start = Stopwatch::now();
+
+	for (short i = 0; i < Ds4TouchHistoryRing::capacity; ++i)
+	{
+		data.touchPoint1 = { static_cast<short>(i * 20), static_cast<short>(i * 10) };
+		history.push(data, start + reportInterval * i);
+
+		if (i == 0)
+		{
+			region.activateTouch(Ds4Buttons::touch1, data.touchPoint1);
+		}
+	}
+
+	runner.run("TrackballSimulator::update touched", [&](size_t)
+	{
+		ball.velocity = Vector2(60.0f, 30.0f);
+		ball.update(1.0f);
+		doNotOptimize(ball.velocity);
+	});
+}
+
+void InputBenchmarks::motion(BenchmarkRunner& runner)
+{
+	const std::vector<Ds4Input> states = makeInputStates();
+	Ds4MotionProcessor processor;
+
+	runner.run("Ds4MotionProcessor::update", [&](size_t i)
+	{
+		processor.update(states[i % reportCount].data);
+		doNotOptimize(processor.gravity());
+	});
+
+	NullOutputSink sink;
+	const auto device = makeDevice(makeMotionProfile(), &sink);
+
+	runner.run("InputSimulator::runMaps gyro to mouse and stick", [&](size_t i)
+	{
+		device->input = states[i % reportCount];
+		device->simulator.runMaps();
+	});
+}
+
+void InputBenchmarks::macros(BenchmarkRunner& runner)
+{
+	const DeviceProfile profile = makeMacroProfile(64);
+	const std::string text = profile.macros.at("benchmark").toString();
+
+	runner.run("Macro::parse 64 events", [&](size_t)
+	{
+		doNotOptimize(Macro::parse(text));
+	});
+
+	// playback is driven by the device's timers, so time has to pass between reports
+	VirtualClock clock;
+	const std::vector<Ds4Input> states = makeInputStates();
+	NullOutputSink sink;
+	const auto device = makeDevice(profile, &sink);
+
+	runner.run("InputSimulator::runMaps macro playback", [&](size_t i)
+	{
+		clock.advance(reportInterval);
+		device->input = states[i % reportCount];
+		device->simulator.runMaps();
+	});
+}
+
+void InputBenchmarks::deviceRun(BenchmarkRunner& runner)
+{
+	NullOutputSink sink;
+	LoopbackDeviceRun loopback;
+	const auto device = makeUsbDevice(makeBindingProfile(100, 10), &sink, loopback);
+
+	runner.run("Ds4Device::run usb steady state", [&](size_t)
+	{
+		loopback.advance();
+		device->run();
+	});
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <memory>
+
+class BenchmarkRunner;
+class DeviceProfile;
+class Ds4Device;
+class IOutputSink;
+
+/**
+ * \brief Benchmarks of the code run for every input report: report parsing,
+ * axis lookup, binding evaluation, touch regions, the trackball simulator, motion processing and macro playback.
+ * Everything runs on a headless \c Ds4Device with output discarded,
+ * so only the cost of ds4wizard itself is measured.
+ */
+class InputBenchmarks
+{
+public:
+	static void run(BenchmarkRunner& runner);
+
+	/**
+	 * \brief Runs a device connected to a scripted USB controller until it reaches
+	 * a steady state, then counts the heap allocations made by the device loop.
+	 * \return \c true if the device loop did not allocate once warmed up.
+	 */
+	static bool checkAllocations();
+
+private:
+	struct LoopbackDeviceRun;
+
+	static std::unique_ptr<Ds4Device> makeDevice(const DeviceProfile& profile, IOutputSink* sink);
+	static std::unique_ptr<Ds4Device> makeUsbDevice(const DeviceProfile& profile, IOutputSink* sink, LoopbackDeviceRun& loopback);
+
+	static void ds4Input(BenchmarkRunner& runner);
+	static void runMaps(BenchmarkRunner& runner, size_t bindingCount, size_t modifierCount);
+	static void touchRegions(BenchmarkRunner& runner, size_t regionCount);
+	static void trackball(BenchmarkRunner& runner);
+	static void motion(BenchmarkRunner& runner);
+	static void macros(BenchmarkRunner& runner);
+	static void deviceRun(BenchmarkRunner& runner);
+};
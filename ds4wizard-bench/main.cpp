@@ -0,0 +1,65 @@
+#include "pch.h"
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+
+#include "benchmark.h"
+#include "input_benchmarks.h"
+
+using namespace std::chrono;
+
+int main(int argc, char** argv)
+{
+	std::string filter;
+	milliseconds minTime = 500ms;
+	bool checkAllocations = false;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		const std::string arg(argv[i]);
+
+		if (arg == "--check-allocations")
+		{
+			checkAllocations = true;
+			continue;
+		}
+
+		if (i + 1 >= argc)
+		{
+			break;
+		}
+
+		if (arg == "--filter")
+		{
+			filter = argv[++i];
+		}
+		else if (arg == "--min-time")
+		{
+			minTime = milliseconds(std::stoul(argv[++i]));
+		}
+	}
+
+#ifndef NDEBUG
+	printf("warning: this is a debug build; numbers are not representative\n");
+#endif
+
+	// fails if the device loop allocates once it has reached a steady state
+	if (checkAllocations)
+	{
+		return InputBenchmarks::checkAllocations() ? 0 : 1;
+	}
+
+	BenchmarkRunner runner(minTime, filter);
+	BenchmarkRunner::printHeader();
+
+	InputBenchmarks::run(runner);
+
+	if (runner.results().empty())
+	{
+		printf("no benchmarks matched \"%s\"\n", filter.c_str());
+		return 1;
+	}
+
+	return 0;
+}
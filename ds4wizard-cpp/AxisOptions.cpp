@@ -44,6 +44,129 @@ void AxisOptions::writeJson(nlohmann::json& json) const
 	}
 }
 
+float AxisResponseCurve::apply(float value) const
+{
+	value = std::clamp(value, 0.0f, 1.0f);
+
+	switch (type)
+	{
+		case +AxisResponseCurveType::linear:
+			return value;
+
+		case +AxisResponseCurveType::exponential:
+			return std::pow(value, exponent);
+
+		case +AxisResponseCurveType::sCurve:
+			return gmath::lerp(value, gmath::smoothstep(value), strength);
+
+		case +AxisResponseCurveType::custom:
+		{
+			if (points.empty())
+			{
+				return value;
+			}
+
+			if (value <= points.front().first)
+			{
+				return points.front().second;
+			}
+
+			for (size_t i = 1; i < points.size(); ++i)
+			{
+				const auto& [x1, y1] = points[i];
+
+				if (value > x1)
+				{
+					continue;
+				}
+
+				const auto& [x0, y0] = points[i - 1];
+				return x1 > x0 ? gmath::lerp(y0, y1, (value - x0) / (x1 - x0)) : y1;
+			}
+
+			return points.back().second;
+		}
+
+		default:
+			throw std::out_of_range("invalid AxisResponseCurveType");
+	}
+}
+
+bool AxisResponseCurve::operator==(const AxisResponseCurve& other) const
+{
+	return type == other.type
+	       && exponent == other.exponent
+	       && strength == other.strength
+	       && points == other.points;
+}
+
+bool AxisResponseCurve::operator!=(const AxisResponseCurve& other) const
+{
+	return !(*this == other);
+}
+
+void AxisResponseCurve::readJson(const nlohmann::json& json)
+{
+	type = AxisResponseCurveType::_from_string(json.value("type", "linear").c_str());
+
+	if (json.find("exponent") != json.end())
+	{
+		exponent = json["exponent"].get<float>();
+	}
+
+	if (json.find("strength") != json.end())
+	{
+		strength = json["strength"].get<float>();
+	}
+
+	points.clear();
+
+	if (json.find("points") != json.end())
+	{
+		for (const auto& point : json["points"])
+		{
+			points.emplace_back(point[0].get<float>(), point[1].get<float>());
+		}
+
+		std::stable_sort(points.begin(), points.end(), [](const auto& a, const auto& b)
+		{
+			return a.first < b.first;
+		});
+	}
+}
+
+void AxisResponseCurve::writeJson(nlohmann::json& json) const
+{
+	json["type"] = type._to_string();
+
+	switch (type)
+	{
+		case +AxisResponseCurveType::exponential:
+			json["exponent"] = exponent;
+			break;
+
+		case +AxisResponseCurveType::sCurve:
+			json["strength"] = strength;
+			break;
+
+		case +AxisResponseCurveType::custom:
+		{
+			nlohmann::json points_ = nlohmann::json::array();
+
+			for (const auto& [x, y] : points)
+			{
+				points_.push_back({ x, y });
+			}
+
+			json["points"] = points_;
+			break;
+		}
+
+		default:
+			break;
+	}
+}
+
 InputAxisOptions::InputAxisOptions(AxisPolarity polarity)
 	: AxisOptions(polarity)
 {
@@ -91,6 +214,11 @@ float InputAxisOptions::applyToValue(float value) const
 	const auto dzValue = deadZone.value_or(0.0f);
 	value = std::clamp((value - dzValue) / (1.0f - dzValue), 0.0f, 1.0f);
 
+	if (responseCurve.has_value())
+	{
+		value = responseCurve->apply(value);
+	}
+
 	if (invert.value_or(false))
 	{
 		value = 1.0f - value;
@@ -121,7 +249,8 @@ bool InputAxisOptions::operator==(const InputAxisOptions& other) const
 	return AxisOptions::operator==(other)
 	       && invert == other.invert
 	       && deadZoneSource == other.deadZoneSource
-	       && deadZone == other.deadZone;
+	       && deadZone == other.deadZone
+	       && responseCurve == other.responseCurve;
 }
 
 bool InputAxisOptions::operator!=(const InputAxisOptions& other) const
@@ -147,6 +276,11 @@ void InputAxisOptions::readJson(const nlohmann::json& json)
 	{
 		deadZone = json["deadZone"].get<float>();
 	}
+
+	if (json.find("responseCurve") != json.end())
+	{
+		responseCurve = fromJson<AxisResponseCurve>(json["responseCurve"]);
+	}
 }
 
 void InputAxisOptions::writeJson(nlohmann::json& json) const
@@ -167,6 +301,11 @@ void InputAxisOptions::writeJson(nlohmann::json& json) const
 	{
 		json["deadZone"] = deadZone.value();
 	}
+
+	if (responseCurve.has_value())
+	{
+		json["responseCurve"] = responseCurve->toJson();
+	}
 }
 
 AxisOptions XInputAxes::getAxisOptions(XInputAxis::T axis) const
@@ -3,6 +3,8 @@
 #include "enums.h"
 #include "JsonData.h"
 #include <optional>
+#include <utility>
+#include <vector>
 
 class Vector3;
 class Vector2;
@@ -40,6 +42,45 @@ public:
 	void writeJson(nlohmann::json& json) const override;
 };
 
+/**
+ * \brief Maps an axis value in the range 0 to 1 onto a new value in the same range.
+ */
+class AxisResponseCurve : public JsonData
+{
+public:
+	AxisResponseCurveType type = AxisResponseCurveType::linear;
+
+	/**
+	 * \brief Power of an \c AxisResponseCurveType::exponential curve.
+	 */
+	float exponent = 2.0f;
+
+	/**
+	 * \brief Blend from linear (\c 0) to a full S-curve (\c 1) of an \c AxisResponseCurveType::sCurve curve.
+	 */
+	float strength = 1.0f;
+
+	/**
+	 * \brief Input and output pairs of an \c AxisResponseCurveType::custom curve, sorted by input.
+	 * Inputs outside the first and last points use the output of the nearest point.
+	 */
+	std::vector<std::pair<float, float>> points;
+
+	AxisResponseCurve() = default;
+	AxisResponseCurve(const AxisResponseCurve&) = default;
+	AxisResponseCurve& operator=(const AxisResponseCurve&) = default;
+
+	/**
+	 * \brief Applies the curve to \p value, which is clamped to the range 0 to 1 first.
+	 */
+	[[nodiscard]] float apply(float value) const;
+
+	bool operator==(const AxisResponseCurve& other) const;
+	bool operator!=(const AxisResponseCurve& other) const;
+	void readJson(const nlohmann::json& json) override;
+	void writeJson(nlohmann::json& json) const override;
+};
+
 /**
  * \brief Configuration for an axis read from real hardware.
  */
@@ -65,6 +106,11 @@ public:
 	 */
 	std::optional<float> deadZone;
 
+	/**
+	 * \brief Response curve applied after dead zone scaling and before inversion, if any.
+	 */
+	std::optional<AxisResponseCurve> responseCurve;
+
 	InputAxisOptions() = default;
 	InputAxisOptions(const InputAxisOptions&) = default;
 	InputAxisOptions& operator=(const InputAxisOptions&) = default;
@@ -75,13 +121,11 @@ public:
 	 */
 	explicit InputAxisOptions(AxisPolarity polarity);
 
-private:
 	/**
 	 * \brief Check if \a value exceeds configured dead zone, if any.
 	 */
 	[[nodiscard]] bool exceedsDeadZone(float value) const;
 
-public:
 	// TODO: better documentation - i.e. axisValue is returned as-is sometimes
 	/**
 	 * \brief Returns the provided analog input with the stored multiplier, inverse, and dead zone applied.
@@ -94,7 +138,7 @@ public:
 	[[nodiscard]] float applyToValueWithMagnitude(float axisValue, float axisVectorMagnitude) const;
 
 	/**
-	 * \brief Returns the value with multiplier, inverse, and dead zone applied.
+	 * \brief Returns the value with dead zone, response curve, inverse, and multiplier applied.
 	 */
 	[[nodiscard]] float applyToValue(float value) const;
 
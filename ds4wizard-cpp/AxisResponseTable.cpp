@@ -0,0 +1,178 @@
+#include "pch.h"
+
+#include <algorithm>
+
+#include "AxisResponseTable.h"
+
+namespace
+{
+	constexpr int stickRange = 127;
+
+	/**
+	 * \brief Stick magnitude scaled to 0 to 255, by the sum of the squares of the stick's centered X and Y.
+	 */
+	const std::array<uint8_t, 2 * stickRange * stickRange + 1> magnitudeIndices = []()
+	{
+		std::array<uint8_t, 2 * stickRange * stickRange + 1> result {};
+
+		for (size_t i = 0; i < result.size(); ++i)
+		{
+			const float magnitude = std::min(1.0f, std::sqrt(static_cast<float>(i)) / static_cast<float>(stickRange));
+			result[i] = static_cast<uint8_t>(std::lround(magnitude * 255.0f));
+		}
+
+		return result;
+	}();
+
+	int centered(uint8_t value)
+	{
+		return std::clamp(static_cast<int>(value) - 128, -stickRange, stickRange);
+	}
+
+	/**
+	 * \brief The value of \p axis for the raw byte \p value, as computed by \c Ds4Input::getAxis
+	 */
+	float toAxisValue(Ds4Axes_t axis, uint8_t value, const std::optional<AxisPolarity>& polarity)
+	{
+		float result;
+
+		switch (axis)
+		{
+			case Ds4Axes::leftStickX:
+			case Ds4Axes::rightStickX:
+				result = std::clamp(centered(value) / static_cast<float>(stickRange), -1.0f, 1.0f);
+				break;
+
+			case Ds4Axes::leftStickY:
+			case Ds4Axes::rightStickY:
+				result = -std::clamp(centered(value) / static_cast<float>(stickRange), -1.0f, 1.0f);
+				break;
+
+			case Ds4Axes::leftTrigger:
+			case Ds4Axes::rightTrigger:
+				result = static_cast<float>(value) / 255.0f;
+				break;
+
+			default:
+				throw std::out_of_range("invalid Ds4Axes");
+		}
+
+		if (!polarity)
+		{
+			return result;
+		}
+
+		if (*polarity == +AxisPolarity::negative)
+		{
+			result = -result;
+		}
+
+		return std::max(0.0f, result);
+	}
+}
+
+bool AxisResponseTable::supports(Ds4Axes_t axis)
+{
+	switch (axis)
+	{
+		case Ds4Axes::leftStickX:
+		case Ds4Axes::leftStickY:
+		case Ds4Axes::rightStickX:
+		case Ds4Axes::rightStickY:
+		case Ds4Axes::leftTrigger:
+		case Ds4Axes::rightTrigger:
+			return true;
+
+		default:
+			return false;
+	}
+}
+
+void AxisResponseTable::compile(Ds4Axes_t axis, const InputAxisOptions& options)
+{
+	this->axis = axis;
+	compiled_  = supports(axis);
+
+	if (!compiled_)
+	{
+		return;
+	}
+
+	const bool stick = (axis & (Ds4Axes::leftStick | Ds4Axes::rightStick)) != 0;
+
+	// sticks go through applyToValueWithMagnitude, everything else through applyToValue
+	usesMagnitude = stick &&
+	                options.deadZoneSource.value_or(DeadZoneSource::axisVectorMagnitude) == +DeadZoneSource::axisVectorMagnitude;
+
+	magnitudeThreshold = size;
+
+	for (size_t i = 0; i < size; ++i)
+	{
+		const float value = toAxisValue(axis, static_cast<uint8_t>(i), options.polarity);
+
+		axisValues[i] = value;
+		values[i]     = stick ? options.applyToValueWithMagnitude(value, 0.0f) : options.applyToValue(value);
+
+		const float magnitude = static_cast<float>(i) / 255.0f;
+		magnitudeValues[i] = options.applyToValue(magnitude);
+
+		if (magnitudeThreshold == size && options.exceedsDeadZone(magnitude))
+		{
+			magnitudeThreshold = i;
+		}
+	}
+}
+
+float AxisResponseTable::apply(const Ds4InputData& data) const
+{
+	const uint8_t raw = rawValue(data);
+
+	if (!usesMagnitude)
+	{
+		return values[raw];
+	}
+
+	const size_t magnitude = magnitudeIndex(data);
+
+	if (magnitude < magnitudeThreshold)
+	{
+		return 0.0f;
+	}
+
+	// see InputAxisOptions::applyToValueWithMagnitude
+	return std::min(magnitudeValues[magnitude], axisValues[raw]);
+}
+
+uint8_t AxisResponseTable::rawValue(const Ds4InputData& data) const
+{
+	switch (axis)
+	{
+		case Ds4Axes::leftStickX:
+			return data.leftStick.x;
+		case Ds4Axes::leftStickY:
+			return data.leftStick.y;
+
+		case Ds4Axes::rightStickX:
+			return data.rightStick.x;
+		case Ds4Axes::rightStickY:
+			return data.rightStick.y;
+
+		case Ds4Axes::leftTrigger:
+			return data.leftTrigger;
+		case Ds4Axes::rightTrigger:
+			return data.rightTrigger;
+
+		default:
+			throw std::out_of_range("invalid Ds4Axes");
+	}
+}
+
+size_t AxisResponseTable::magnitudeIndex(const Ds4InputData& data) const
+{
+	const Ds4Stick& stick = axis & Ds4Axes::leftStick ? data.leftStick : data.rightStick;
+
+	const int x = centered(stick.x);
+	const int y = centered(stick.y);
+
+	return magnitudeIndices[static_cast<size_t>(x * x + y * y)];
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+#include "enums.h"
+#include "AxisOptions.h"
+#include "Ds4InputData.h"
+
+/**
+ * \brief An \c InputAxisOptions compiled for one 8-bit axis (a stick axis or a trigger)
+ * into tables indexed by the axis' raw report byte, so that applying the options is a table load.
+ * \sa InputAxisOptions::applyToValue
+ */
+class AxisResponseTable
+{
+public:
+	static constexpr size_t size = 256;
+
+private:
+	Ds4Axes_t axis = 0;
+	bool compiled_ = false;
+
+	/**
+	 * \brief \c true if the dead zone is tested against the magnitude of the axis' stick.
+	 */
+	bool usesMagnitude = false;
+
+	/**
+	 * \brief Lowest \c magnitudeIndex that exceeds the dead zone. \sa usesMagnitude
+	 */
+	size_t magnitudeThreshold = 0;
+
+	/**
+	 * \brief The axis value with polarity applied, as returned by \c Ds4Input::getAxis
+	 */
+	std::array<float, size> axisValues {};
+
+	/**
+	 * \brief The axis value with all options applied. Unused if \c usesMagnitude is set.
+	 */
+	std::array<float, size> values {};
+
+	/**
+	 * \brief Options applied to the magnitude of the axis' stick, by \c magnitudeIndex. \sa usesMagnitude
+	 */
+	std::array<float, size> magnitudeValues {};
+
+public:
+	/**
+	 * \brief Indicates if \p axis is an 8-bit axis that can be compiled.
+	 */
+	static bool supports(Ds4Axes_t axis);
+
+	/**
+	 * \brief Compiles \p options for \p axis. If the axis isn't \c supports -ed, the table is left uncompiled.
+	 * \param axis A single \c Ds4Axes bit.
+	 * \param options The options to apply.
+	 */
+	void compile(Ds4Axes_t axis, const InputAxisOptions& options);
+
+	[[nodiscard]] bool compiled() const
+	{
+		return compiled_;
+	}
+
+	/**
+	 * \brief Gets the value of the axis in \p data with polarity applied. The table must be \c compiled.
+	 */
+	[[nodiscard]] float axisValue(const Ds4InputData& data) const
+	{
+		return axisValues[rawValue(data)];
+	}
+
+	/**
+	 * \brief Gets the value of the axis in \p data with all options applied. The table must be \c compiled.
+	 */
+	[[nodiscard]] float apply(const Ds4InputData& data) const;
+
+private:
+	[[nodiscard]] uint8_t rawValue(const Ds4InputData& data) const;
+
+	/**
+	 * \brief Gets the magnitude of the stick the axis belongs to, scaled and rounded to the range 0 to 255.
+	 */
+	[[nodiscard]] size_t magnitudeIndex(const Ds4InputData& data) const;
+};
@@ -0,0 +1,399 @@
+#include "pch.h"
+
+#include <algorithm>
+#include <limits>
+
+#include "BindingProgram.h"
+#include "DeviceProfile.h"
+
+namespace
+{
+	constexpr uint64_t notVisited = std::numeric_limits<uint64_t>::max();
+
+	/**
+	 * \brief Sort key reproducing the order maps were visited in by key:
+	 * every button bit, then every axis bit, then every touch region by name, then every touch gesture bit.
+	 */
+	template <typename Map>
+	uint64_t visitOrder(const Map& map, const Ds4TouchRegionCache& touchRegions)
+	{
+		if (map.inputType & InputType::button && map.inputButtons.value_or(0) != 0)
+		{
+			for (size_t i = 0; i < Ds4Buttons_values.size(); ++i)
+			{
+				if (map.inputButtons.value() & Ds4Buttons_values[i])
+				{
+					return i;
+				}
+			}
+		}
+
+		if (map.inputType & InputType::axis && map.inputAxes.value_or(0) != 0)
+		{
+			for (size_t i = 0; i < Ds4Axes_values.size(); ++i)
+			{
+				if (map.inputAxes.value() & Ds4Axes_values[i])
+				{
+					return (1ull << 32) | i;
+				}
+			}
+		}
+
+		if (map.inputType & InputType::touchRegion && !map.inputTouchRegion.empty())
+		{
+			const auto it = touchRegions.find(map.inputTouchRegion);
+
+			if (it != touchRegions.end())
+			{
+				return (2ull << 32) | static_cast<uint64_t>(std::distance(touchRegions.begin(), it));
+			}
+		}
+
+		if (map.inputType & InputType::touchGesture && map.inputTouchGesture.value_or(0) != 0)
+		{
+			for (size_t i = 0; i < TouchGesture_values.size(); ++i)
+			{
+				if (map.inputTouchGesture.value() & TouchGesture_values[i])
+				{
+					return (3ull << 32) | i;
+				}
+			}
+		}
+
+		return notVisited;
+	}
+
+	template <typename Map>
+	std::vector<Map*> sortForVisit(std::deque<Map>& maps, const Ds4TouchRegionCache& touchRegions)
+	{
+		std::vector<std::pair<uint64_t, Map*>> keyed;
+		keyed.reserve(maps.size());
+
+		for (Map& map : maps)
+		{
+			const uint64_t key = visitOrder(map, touchRegions);
+
+			if (key != notVisited)
+			{
+				keyed.emplace_back(key, &map);
+			}
+		}
+
+		std::stable_sort(keyed.begin(), keyed.end(), [](const auto& a, const auto& b)
+		{
+			return a.first < b.first;
+		});
+
+		std::vector<Map*> result;
+		result.reserve(keyed.size());
+
+		for (const auto& pair : keyed)
+		{
+			result.push_back(pair.second);
+		}
+
+		return result;
+	}
+}
+
+void BindingProgram::compile(DeviceProfile& profile, const Ds4TouchRegionCache& touchRegions)
+{
+	clear();
+
+	for (InputModifier* modifier : sortForVisit(profile.modifiers, touchRegions))
+	{
+		const uint32_t index = modifiers.size();
+		add(modifiers, *modifier, touchRegions);
+
+		childBegin.push_back(bindings.size());
+
+		for (InputMap& child : modifier->bindings)
+		{
+			addBinding(child, index, touchRegions);
+		}
+
+		childEnd.push_back(bindings.size());
+	}
+
+	topLevelBegin = bindings.size();
+
+	for (InputMap* binding : sortForVisit(profile.bindings, touchRegions))
+	{
+		addBinding(*binding, noParent, touchRegions);
+	}
+
+	addMacros(profile);
+
+	for (uint32_t i = 0; i < modifiers.size(); ++i)
+	{
+		addOverrides(modifiers, i, noParent);
+	}
+
+	for (uint32_t i = 0; i < bindings.size(); ++i)
+	{
+		addOverrides(bindings, i, i < topLevelBegin ? i : noParent);
+	}
+}
+
+void BindingProgram::clear()
+{
+	modifiers.clear();
+	childBegin.clear();
+	childEnd.clear();
+	bindings.clear();
+	ops.clear();
+	parents.clear();
+	xinputNegativeAxes.clear();
+	macroEvents.clear();
+	macroBegin.clear();
+	macroEnd.clear();
+	topLevelBegin = 0;
+	axisTerms.clear();
+	axisTables.clear();
+	overrides.clear();
+}
+
+template <typename Map>
+void BindingProgram::add(BindingTable<Map>& table, Map& map, const Ds4TouchRegionCache& touchRegions)
+{
+	InputType_t types = 0;
+
+	Ds4Buttons_t buttons = 0;
+	Ds4Axes_t axes = 0;
+	Ds4TouchRegion* region = nullptr;
+	TouchGesture_t gestures = 0;
+
+	const uint32_t index = table.size();
+	const auto termBegin = static_cast<uint32_t>(axisTerms.size());
+
+	if (map.inputType & InputType::button && map.inputButtons.value_or(0) != 0)
+	{
+		types |= InputType::button;
+		buttons = map.inputButtons.value();
+	}
+
+	if (map.inputType & InputType::axis && map.inputAxes.value_or(0) != 0)
+	{
+		types |= InputType::axis;
+		axes = map.inputAxes.value();
+
+		for (const Ds4Axes_t bit : Ds4Axes_values)
+		{
+			if (axes & bit)
+			{
+				const InputAxisOptions& options = map.getAxisOptions(bit);
+				axisTerms.push_back({ bit, options, options.deadZone.value_or(0.0f) });
+				axisTables.emplace_back().compile(bit, options);
+			}
+		}
+	}
+
+	if (map.inputType & InputType::touchRegion && !map.inputTouchRegion.empty())
+	{
+		const auto it = touchRegions.find(map.inputTouchRegion);
+
+		if (it != touchRegions.end())
+		{
+			types |= InputType::touchRegion;
+			region = it->second;
+		}
+	}
+
+	if (map.inputType & InputType::touchGesture && map.inputTouchGesture.value_or(0) != 0)
+	{
+		types |= InputType::touchGesture;
+		gestures = map.inputTouchGesture.value();
+	}
+
+	BindingDependents& dependents = table.dependents;
+
+	for (size_t bit = 0; bit < 32; ++bit)
+	{
+		if (buttons & (1u << bit))
+		{
+			dependents.buttons[bit].push_back(index);
+		}
+
+		if (Ds4Axes::expand(axes) & (1u << bit))
+		{
+			dependents.axes[bit].push_back(index);
+		}
+	}
+
+	if (region != nullptr || gestures != 0)
+	{
+		dependents.touch.push_back(index);
+	}
+
+	if (map.isPersistent() || (region != nullptr && region->type != +Ds4TouchRegionType::button))
+	{
+		dependents.continuous.push_back(index);
+	}
+
+	table.maps.push_back(&map);
+	table.inputTypes.push_back(types);
+	table.buttons.push_back(buttons);
+	table.axes.push_back(axes);
+	table.axisTermBegin.push_back(termBegin);
+	table.axisTermEnd.push_back(static_cast<uint32_t>(axisTerms.size()));
+	table.touchRegions.push_back(region);
+	table.touchDirections.push_back(map.inputTouchDirection.value_or(Direction::none));
+	table.touchGestures.push_back(gestures);
+}
+
+void BindingProgram::addBinding(InputMap& map, uint32_t parent, const Ds4TouchRegionCache& touchRegions)
+{
+	const uint32_t index = bindings.size();
+	const BindingOp op = getOp(map);
+
+	add(bindings, map, touchRegions);
+	ops.push_back(op);
+	parents.push_back(parent);
+
+	XInputAxis_t negative = 0;
+
+	if (op == BindingOp::xinput && map.xinputAxes.has_value())
+	{
+		const XInputAxes& axes = map.xinputAxes.value();
+
+		for (const XInputAxis_t bit : XInputAxis_values)
+		{
+			if (axes.axes & bit &&
+			    axes.getAxisOptions(static_cast<XInputAxis::T>(bit)).polarity == +AxisPolarity::negative)
+			{
+				negative |= bit;
+			}
+		}
+	}
+
+	xinputNegativeAxes.push_back(negative);
+
+	std::vector<uint32_t>& continuous = bindings.dependents.continuous;
+
+	if (bindings.inputTypes[index] & InputType::axis && hasAnalogOutput(map, op) &&
+	    (continuous.empty() || continuous.back() != index))
+	{
+		continuous.push_back(index);
+	}
+}
+
+void BindingProgram::addMacros(const DeviceProfile& profile)
+{
+	for (uint32_t i = 0; i < bindings.size(); ++i)
+	{
+		macroBegin.push_back(static_cast<uint32_t>(macroEvents.size()));
+
+		if (ops[i] == BindingOp::macro)
+		{
+			const auto it = profile.macros.find(bindings.maps[i]->macro);
+
+			if (it != profile.macros.end())
+			{
+				const std::vector<MacroEvent>& events = it->second.events;
+				macroEvents.insert(macroEvents.end(), events.begin(), events.end());
+			}
+		}
+
+		macroEnd.push_back(static_cast<uint32_t>(macroEvents.size()));
+	}
+}
+
+BindingOp BindingProgram::getOp(const InputMap& map)
+{
+	switch (map.simulatorType)
+	{
+		case SimulatorType::input:
+			switch (map.outputType)
+			{
+				case OutputType::xinput:
+					return BindingOp::xinput;
+
+				case OutputType::keyboard:
+					return BindingOp::keyboard;
+
+				case OutputType::mouse:
+					return BindingOp::mouse;
+
+				default:
+					throw std::out_of_range("invalid OutputType");
+			}
+
+		case SimulatorType::action:
+			if (!map.action.has_value() || map.action.value() == +ActionType::none)
+			{
+				throw std::invalid_argument("action has invalid or no value");
+			}
+
+			return map.action.value() == +ActionType::macro ? BindingOp::macro : BindingOp::action;
+
+		default:
+			throw std::out_of_range("invalid SimulatorType");
+	}
+}
+
+template <typename Map>
+void BindingProgram::addOverrides(BindingTable<Map>& table, uint32_t index, uint32_t self)
+{
+	const auto begin = static_cast<uint32_t>(overrides.size());
+
+	for (uint32_t child = 0; child < topLevelBegin; ++child)
+	{
+		if (child == self || !conflicts(child, table, index))
+		{
+			continue;
+		}
+
+		const uint32_t word = child / 64;
+		const uint64_t bit  = 1ull << (child % 64);
+
+		if (overrides.size() > begin && overrides.back().word == word)
+		{
+			overrides.back().mask |= bit;
+		}
+		else
+		{
+			overrides.push_back({ word, bit });
+		}
+	}
+
+	table.overrideBegin.push_back(begin);
+	table.overrideEnd.push_back(static_cast<uint32_t>(overrides.size()));
+}
+
+template <typename Map>
+bool BindingProgram::conflicts(uint32_t child, const BindingTable<Map>& table, uint32_t index) const
+{
+	const InputType_t shared = bindings.inputTypes[child] & table.inputTypes[index];
+
+	if (shared & InputType::button && bindings.buttons[child] & table.buttons[index])
+	{
+		return true;
+	}
+
+	if (shared & InputType::axis && bindings.axes[child] & table.axes[index])
+	{
+		return true;
+	}
+
+	if (shared & InputType::touchGesture && bindings.touchGestures[child] & table.touchGestures[index])
+	{
+		return true;
+	}
+
+	return shared & InputType::touchRegion && bindings.touchRegions[child] == table.touchRegions[index];
+}
+
+bool BindingProgram::hasAnalogOutput(const InputMap& map, BindingOp op)
+{
+	switch (op)
+	{
+		case BindingOp::xinput:
+			return map.xinputAxes.has_value();
+
+		case BindingOp::mouse:
+			return map.mouseAxes.has_value();
+
+		default:
+			return false;
+	}
+}
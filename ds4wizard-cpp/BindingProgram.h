@@ -0,0 +1,425 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "enums.h"
+#include "AxisOptions.h"
+#include "AxisResponseTable.h"
+#include "Ds4GestureRecognizer.h"
+#include "Ds4Input.h"
+#include "Ds4TouchRegion.h"
+#include "InputMap.h"
+#include "Macro.h"
+
+class DeviceProfile;
+
+/**
+ * \brief What a compiled binding does with its state once it has been updated.
+ */
+enum class BindingOp : uint8_t
+{
+	/** \brief Simulates XInput buttons and/or axes. */
+	xinput,
+	/** \brief Simulates a keyboard key and its modifier keys. */
+	keyboard,
+	/** \brief Simulates a mouse button and/or mouse motion. */
+	mouse,
+	/** \brief Runs an \c ActionType. */
+	action,
+	/** \brief Plays back a \c Macro on the device's timers. */
+	macro
+};
+
+/**
+ * \brief Result of testing a compiled binding's input condition.
+ */
+enum class BindingInput : uint8_t
+{
+	/** \brief The binding has no input to test; its pressed state is left as-is. */
+	unchanged,
+	/** \brief The input condition is met. */
+	active,
+	/** \brief The input condition is not met. */
+	inactive
+};
+
+/**
+ * \brief One axis of an axis binding, with the binding's options for that axis resolved.
+ */
+struct BindingAxisTerm
+{
+	/**
+	 * \brief The single \c Ds4Axes bit this term was resolved for.
+	 */
+	Ds4Axes_t axis;
+
+	InputAxisOptions options;
+
+	/**
+	 * \brief The axis must be at least this far along \c options.polarity to activate the binding.
+	 */
+	float threshold;
+};
+
+/**
+ * \brief A 64-entry slice of the set of modifier set bindings that override a map while active.
+ * Bit \c n of \c mask is binding \c word * 64 + n of \c BindingProgram::bindings.
+ */
+struct BindingOverride
+{
+	uint32_t word;
+	uint64_t mask;
+};
+
+/**
+ * \brief Index from inputs to the entries of a \c BindingTable that read them,
+ * so that a tick only re-evaluates entries whose inputs changed.
+ */
+struct BindingDependents
+{
+	/**
+	 * \brief Entries reading each \c Ds4Buttons bit, by bit position.
+	 */
+	std::array<std::vector<uint32_t>, 32> buttons;
+
+	/**
+	 * \brief Entries reading each \c Ds4Axes bit, by bit position.
+	 * Stick axes are registered for both axes of the stick since dead zones may use its magnitude.
+	 */
+	std::array<std::vector<uint32_t>, 32> axes;
+
+	/**
+	 * \brief Entries reading a touch region or a touch gesture.
+	 */
+	std::vector<uint32_t> touch;
+
+	/**
+	 * \brief Entries whose output changes over time or with sub-threshold input,
+	 * e.g. rapid fire, trackballs and analog stick outputs. These are evaluated every tick.
+	 */
+	std::vector<uint32_t> continuous;
+
+	void clear()
+	{
+		for (auto& list : buttons)
+		{
+			list.clear();
+		}
+
+		for (auto& list : axes)
+		{
+			list.clear();
+		}
+
+		touch.clear();
+		continuous.clear();
+	}
+
+	/**
+	 * \brief Calls \p visitor with the index of every entry that reads any of the given changed inputs,
+	 * and every continuous entry. An entry may be visited more than once.
+	 * \param changedButtons Buttons pressed or released since the last tick.
+	 * \param changedAxes Axes changed since the last tick.
+	 * \param touchChanged \c true if touch regions may have changed state.
+	 * \param visitor Callable taking a \c uint32_t entry index.
+	 */
+	template <typename Visitor>
+	void visit(Ds4Buttons_t changedButtons, Ds4Axes_t changedAxes, bool touchChanged, Visitor&& visitor) const
+	{
+		visitBits(buttons, changedButtons, visitor);
+		visitBits(axes, changedAxes, visitor);
+
+		if (touchChanged)
+		{
+			for (const uint32_t index : touch)
+			{
+				visitor(index);
+			}
+		}
+
+		for (const uint32_t index : continuous)
+		{
+			visitor(index);
+		}
+	}
+
+private:
+	template <typename Visitor>
+	static void visitBits(const std::array<std::vector<uint32_t>, 32>& lists, uint32_t mask, Visitor& visitor)
+	{
+		for (size_t bit = 0; mask != 0; ++bit, mask >>= 1)
+		{
+			if (!(mask & 1))
+			{
+				continue;
+			}
+
+			for (const uint32_t index : lists[bit])
+			{
+				visitor(index);
+			}
+		}
+	}
+};
+
+/**
+ * \brief Structure-of-arrays storage for compiled bindings or modifier sets.
+ * Entry \c i of every column describes \c maps[i].
+ * \tparam Map \c InputMap or \c InputModifier
+ */
+template <typename Map>
+struct BindingTable
+{
+	/**
+	 * \brief The map each entry was compiled from. Runtime state (pressed, toggled, rapid fire) stays on the map.
+	 */
+	std::vector<Map*> maps;
+
+	/**
+	 * \brief Input types of the map that have something to read, e.g. \c InputType::touchRegion is dropped if the region doesn't exist.
+	 */
+	std::vector<InputType_t> inputTypes;
+
+	std::vector<Ds4Buttons_t> buttons;
+	std::vector<Ds4Axes_t> axes;
+
+	/**
+	 * \brief Range of \c BindingProgram::axisTerms used by each entry.
+	 */
+	std::vector<uint32_t> axisTermBegin;
+	std::vector<uint32_t> axisTermEnd;
+
+	std::vector<Ds4TouchRegion*> touchRegions;
+	std::vector<Direction_t> touchDirections;
+	std::vector<TouchGesture_t> touchGestures;
+
+	/**
+	 * \brief Range of \c BindingProgram::overrides used by each entry.
+	 */
+	std::vector<uint32_t> overrideBegin;
+	std::vector<uint32_t> overrideEnd;
+
+	BindingDependents dependents;
+
+	[[nodiscard]] uint32_t size() const
+	{
+		return static_cast<uint32_t>(maps.size());
+	}
+
+	void clear()
+	{
+		maps.clear();
+		inputTypes.clear();
+		buttons.clear();
+		axes.clear();
+		axisTermBegin.clear();
+		axisTermEnd.clear();
+		touchRegions.clear();
+		touchDirections.clear();
+		touchGestures.clear();
+		overrideBegin.clear();
+		overrideEnd.clear();
+		dependents.clear();
+	}
+};
+
+/**
+ * \brief A \c DeviceProfile's modifier sets and bindings flattened into tables in evaluation order,
+ * so a tick is a linear walk with no hashing, no virtual calls and no heap allocation.
+ *
+ * The program points into the profile and its touch regions, so it must be
+ * recompiled whenever either changes or is moved.
+ * \sa InputSimulator::applyProfile
+ */
+class BindingProgram
+{
+public:
+	static constexpr uint32_t noParent = UINT32_MAX;
+
+	BindingTable<InputModifier> modifiers;
+
+	/**
+	 * \brief Range of \c bindings owned by each modifier set.
+	 */
+	std::vector<uint32_t> childBegin;
+	std::vector<uint32_t> childEnd;
+
+	/**
+	 * \brief Every binding: the children of each modifier set in modifier order,
+	 * followed by the top-level bindings starting at \c topLevelBegin.
+	 */
+	BindingTable<InputMap> bindings;
+
+	/**
+	 * \brief Output operation of each binding.
+	 */
+	std::vector<BindingOp> ops;
+
+	/**
+	 * \brief Index into \c modifiers of each binding's modifier set, or \c noParent.
+	 */
+	std::vector<uint32_t> parents;
+
+	/**
+	 * \brief The XInput axes of each binding that are simulated with negative polarity.
+	 */
+	std::vector<XInputAxis_t> xinputNegativeAxes;
+
+	/**
+	 * \brief Events of every macro played by a binding, stored back to back.
+	 * Resolved from \c DeviceProfile::macros so that playback never looks a macro up by name.
+	 */
+	std::vector<MacroEvent> macroEvents;
+
+	/**
+	 * \brief Range of \c macroEvents played by each binding. Empty unless its op is \c BindingOp::macro.
+	 */
+	std::vector<uint32_t> macroBegin;
+	std::vector<uint32_t> macroEnd;
+
+	uint32_t topLevelBegin = 0;
+
+	std::vector<BindingAxisTerm> axisTerms;
+
+	/**
+	 * \brief The options of each of \c axisTerms compiled for its axis, where the axis supports it.
+	 */
+	std::vector<AxisResponseTable> axisTables;
+
+	/**
+	 * \brief Override sets of every entry, stored sparsely as the non-zero words of a bitset over \c bindings.
+	 * A map is overridden by any active binding of a modifier set that shares
+	 * a button, an axis, a touch region or a touch gesture with it.
+	 */
+	std::vector<BindingOverride> overrides;
+
+	/**
+	 * \brief Compiles \p profile. Top-level bindings and modifier sets are ordered the way
+	 * they have always been visited: by their lowest button, then by their lowest axis,
+	 * then by touch region name, then by their lowest touch gesture, keeping profile order among equals.
+	 * \param profile The profile to compile.
+	 * \param touchRegions The profile's touch regions by name.
+	 */
+	void compile(DeviceProfile& profile, const Ds4TouchRegionCache& touchRegions);
+
+	void clear();
+
+	/**
+	 * \brief Number of 64-bit words needed for a bitset over the bindings of modifier sets.
+	 */
+	[[nodiscard]] uint32_t childWordCount() const
+	{
+		return (topLevelBegin + 63) / 64;
+	}
+
+	/**
+	 * \brief Checks if entry \p index of \p table is overridden by an active binding of a modifier set.
+	 * \param table \c modifiers or \c bindings
+	 * \param index The entry to check.
+	 * \param activeChildren Bitset over \c bindings of the modifier set bindings that are currently active.
+	 * \return \c true if overridden.
+	 */
+	template <typename Map>
+	[[nodiscard]] bool isOverridden(const BindingTable<Map>& table, uint32_t index, const std::vector<uint64_t>& activeChildren) const
+	{
+		for (uint32_t i = table.overrideBegin[index]; i < table.overrideEnd[index]; ++i)
+		{
+			const BindingOverride& o = overrides[i];
+
+			if (activeChildren[o.word] & o.mask)
+			{
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	/**
+	 * \brief Tests the input condition of entry \p index of \p table against \p input and \p gestures.
+	 * When a map has several input types, the last one decides.
+	 */
+	template <typename Map>
+	[[nodiscard]] BindingInput evaluate(const BindingTable<Map>& table, uint32_t index, const Ds4Input& input,
+	                                    const Ds4GestureRecognizer& gestures) const
+	{
+		const InputType_t types = table.inputTypes[index];
+		BindingInput result = BindingInput::unchanged;
+
+		if (types & InputType::button)
+		{
+			const Ds4Buttons_t buttons = table.buttons[index];
+			result = (input.heldButtons & buttons) == buttons ? BindingInput::active : BindingInput::inactive;
+		}
+
+		if (types & InputType::axis)
+		{
+			result = BindingInput::active;
+
+			for (uint32_t i = table.axisTermBegin[index]; i < table.axisTermEnd[index]; ++i)
+			{
+				const BindingAxisTerm& term = axisTerms[i];
+				const AxisResponseTable& response = axisTables[i];
+
+				const float value = response.compiled()
+				                    ? response.axisValue(input.data)
+				                    : input.getAxis(table.axes[index], term.options.polarity);
+
+				if (value < term.threshold)
+				{
+					result = BindingInput::inactive;
+					break;
+				}
+			}
+		}
+
+		if (types & InputType::touchRegion)
+		{
+			const Ds4TouchRegion* region = table.touchRegions[index];
+			const Direction_t direction = table.touchDirections[index];
+
+			result = region->isActive(Ds4Buttons::touch1, direction) || region->isActive(Ds4Buttons::touch2, direction)
+			         ? BindingInput::active
+			         : BindingInput::inactive;
+		}
+
+		if (types & InputType::touchGesture)
+		{
+			result = gestures.isActive(table.touchGestures[index], table.touchDirections[index])
+			         ? BindingInput::active
+			         : BindingInput::inactive;
+		}
+
+		return result;
+	}
+
+private:
+	template <typename Map>
+	void add(BindingTable<Map>& table, Map& map, const Ds4TouchRegionCache& touchRegions);
+
+	void addBinding(InputMap& map, uint32_t parent, const Ds4TouchRegionCache& touchRegions);
+
+	/**
+	 * \brief Copies the events of the macro played by each binding into \c macroEvents.
+	 * Bindings naming a macro that doesn't exist play nothing.
+	 */
+	void addMacros(const DeviceProfile& profile);
+
+	template <typename Map>
+	void addOverrides(BindingTable<Map>& table, uint32_t index, uint32_t self);
+
+	/**
+	 * \brief Indicates if binding \p child of a modifier set overrides entry \p index of \p table while active.
+	 */
+	template <typename Map>
+	[[nodiscard]] bool conflicts(uint32_t child, const BindingTable<Map>& table, uint32_t index) const;
+
+	static BindingOp getOp(const InputMap& map);
+
+	/**
+	 * \brief Indicates if \p map produces analog output from an axis even while it isn't pressed.
+	 */
+	static bool hasAnalogOutput(const InputMap& map, BindingOp op);
+};
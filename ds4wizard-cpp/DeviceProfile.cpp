@@ -16,6 +16,7 @@ DeviceProfile::DeviceProfile(DeviceProfile&& other) noexcept
 	  exclusiveMode(other.exclusiveMode),
 	  useXInput(other.useXInput),
 	  touchRegions(std::move(other.touchRegions)),
+	  macros(std::move(other.macros)),
 	  bindings(std::move(other.bindings)),
 	  modifiers(std::move(other.modifiers))
 
@@ -30,6 +31,7 @@ DeviceProfile& DeviceProfile::operator=(DeviceProfile&& other) noexcept
 	exclusiveMode = other.exclusiveMode;
 	useXInput     = other.useXInput;
 	touchRegions  = std::move(other.touchRegions);
+	macros        = std::move(other.macros);
 	bindings      = std::move(other.bindings);
 	modifiers     = std::move(other.modifiers);
 
@@ -43,6 +45,7 @@ bool DeviceProfile::operator==(const DeviceProfile& other) const
 	       && exclusiveMode == other.exclusiveMode
 	       && useXInput == other.useXInput
 	       && touchRegions == other.touchRegions
+	       && macros == other.macros
 	       && bindings == other.bindings
 	       && modifiers == other.modifiers;
 }
@@ -63,6 +66,14 @@ void DeviceProfile::readJson(const nlohmann::json& json)
 		touchRegions[pair.key()] = fromJson<Ds4TouchRegion>(pair.value());
 	}
 
+	if (json.find("macros") != json.end())
+	{
+		for (const auto& pair : json["macros"].items())
+		{
+			macros[pair.key()] = fromJson<Macro>(pair.value());
+		}
+	}
+
 	for (const auto& value : json["bindings"])
 	{
 		bindings.push_back(fromJson<InputMap>(value));
@@ -91,6 +102,18 @@ void DeviceProfile::writeJson(nlohmann::json& json) const
 
 	json["touchRegions"] = touchRegions_;
 
+	if (!macros.empty())
+	{
+		nlohmann::json macros_;
+
+		for (auto& pair : macros)
+		{
+			macros_[pair.first.c_str()] = pair.second.toJson();
+		}
+
+		json["macros"] = macros_;
+	}
+
 	nlohmann::json bindings_;
 
 	for (auto& binding : bindings)
@@ -7,6 +7,7 @@
 #include "DeviceSettingsCommon.h"
 #include "Ds4TouchRegion.h"
 #include "InputMap.h"
+#include "Macro.h"
 
 /**
  * \brief A class which represents a collection of input-to-output simulation bindings.
@@ -41,6 +42,11 @@ public:
 	 */
 	std::unordered_map<std::string, Ds4TouchRegion> touchRegions;
 
+	/**
+	 * \brief Macros referenced by name from bindings with \c ActionType::macro.
+	 */
+	std::unordered_map<std::string, Macro> macros;
+
 	/**
 	 * \brief Input-to-output bindings managed by this profile.
 	 * \sa InputMap
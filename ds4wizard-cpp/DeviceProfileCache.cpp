@@ -80,6 +80,25 @@ void DeviceProfileCache::saveSettings(const std::string& id, const DeviceSetting
 	f.close();
 }
 
+std::optional<Ds4MotionCalibration> DeviceProfileCache::getMotionCalibration(const std::string& id)
+{
+	LOCK(motionCalibrations);
+	const auto it = motionCalibrations.find(id);
+
+	if (it == motionCalibrations.end())
+	{
+		return std::nullopt;
+	}
+
+	return it->second;
+}
+
+void DeviceProfileCache::setMotionCalibration(const std::string& id, const Ds4MotionCalibration& calibration)
+{
+	LOCK(motionCalibrations);
+	motionCalibrations[id] = calibration;
+}
+
 bool DeviceProfileCache::addProfile(const DeviceProfile& current)
 {
 	if (getProfile(current.name).has_value())
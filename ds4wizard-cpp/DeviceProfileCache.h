@@ -9,6 +9,7 @@
 #include "DeviceSettings.h"
 #include "DeviceProfile.h"
 #include "Ds4DeviceManager.h"
+#include "Ds4Motion.h"
 
 /**
  * \brief A class which manages device profiles, changes to those profiles, and notifying relevant devices of those changes.
@@ -17,6 +18,7 @@ class DeviceProfileCache
 {
 	std::shared_ptr<Ds4DeviceManager> deviceManager;
 	std::unordered_map<std::string, DeviceSettings> deviceSettings;
+	std::unordered_map<std::string, Ds4MotionCalibration> motionCalibrations;
 
 public:
 	// TODO: all of these should be private
@@ -24,6 +26,7 @@ public:
 	std::recursive_mutex profiles_lock;
 	std::recursive_mutex deviceSettings_lock;
 	std::recursive_mutex devices_lock;
+	std::recursive_mutex motionCalibrations_lock;
 	std::deque<DeviceProfile> profiles;
 
 	/**
@@ -79,6 +82,21 @@ public:
 	 */
 	void saveSettings(const std::string& id, const DeviceSettings& settings);
 
+	/**
+	 * \brief Returns a copy of the motion calibration read from the device with the specified MAC address.
+	 * Calibration is only kept for as long as the program runs.
+	 * \param id The MAC address of the device.
+	 * \return The calibration associated with the MAC address, or \c std::nullopt if none has been read.
+	 */
+	std::optional<Ds4MotionCalibration> getMotionCalibration(const std::string& id);
+
+	/**
+	 * \brief Adds (or replaces) the motion calibration for the specified MAC address.
+	 * \param id The MAC address of the device the calibration was read from.
+	 * \param calibration The calibration to be stored.
+	 */
+	void setMotionCalibration(const std::string& id, const Ds4MotionCalibration& calibration);
+
 	/**
 	 * \brief Adds a profile.
 	 * \param current The new profile.
@@ -0,0 +1,9 @@
+#pragma once
+
+#include <enum.h>
+
+/**
+ * \brief How device I/O is distributed across threads.
+ * \c reactor runs devices on a small pool of shared threads, while \c perDevice gives each device its own thread.
+ */
+BETTER_ENUM(DeviceThreading, int, reactor, perDevice)
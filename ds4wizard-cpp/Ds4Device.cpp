@@ -7,6 +7,7 @@
 #include <fmt/format.h>
 
 #include "Ds4Device.h"
+#include "Ds4DeviceReactor.h"
 #include "program.h"
 #include "DeviceProfileCache.h"
 #include "Bluetooth.h"
@@ -248,6 +249,9 @@ void Ds4Device::applyProfile()
 	}
 
 	idleTime.start();
+
+	// the new profile may need ticks that the device thread isn't waiting for
+	wake();
 }
 
 void Ds4Device::releaseAutoColor()
@@ -337,18 +341,33 @@ void Ds4Device::resetWriteLatencyPeak()
 
 void Ds4Device::closeImpl()
 {
-	auto lock_guard = lock();
-	running = false;
+	{
+		auto lock_guard = lock();
+		running = false;
 
-	closeUsbDevice();
-	closeBluetoothDevice();
+		closeUsbDevice();
+		closeBluetoothDevice();
 
-	releaseAutoColor();
+		releaseAutoColor();
+	}
+
+	stopCapture();
 }
 
 void Ds4Device::close()
 {
 	running = false;
+	wake();
+
+	if (reactor != nullptr)
+	{
+		// returns once the reactor is done with this device, unless called from the reactor itself
+		reactor->remove(this);
+		reactor = nullptr;
+
+		closeImpl();
+		return;
+	}
 
 	if (deviceThread && deviceThread->get_id() == std::this_thread::get_id())
 	{
@@ -408,6 +427,45 @@ void Ds4Device::closeUsbDevice()
 	idleTime.start();
 }
 
+bool Ds4Device::startCapture(const std::string& path)
+{
+	auto writer = std::make_unique<Ds4TraceWriter>();
+
+	if (!writer->open(path))
+	{
+		return false;
+	}
+
+	// the previous capture (if any) is finished after the lock is released so that it doesn't stall the device
+	{
+		auto lock_guard = lock();
+		std::swap(traceWriter, writer);
+	}
+
+	return true;
+}
+
+void Ds4Device::stopCapture()
+{
+	std::unique_ptr<Ds4TraceWriter> writer;
+
+	{
+		auto lock_guard = lock();
+		std::swap(traceWriter, writer);
+	}
+
+	if (writer != nullptr && writer->droppedCount() > 0)
+	{
+		Logger::writeLine(LogLevel::warning, name(), fmt::format("Trace capture dropped {} reports.", writer->droppedCount()));
+	}
+}
+
+bool Ds4Device::capturing()
+{
+	auto lock_guard = lock();
+	return traceWriter != nullptr;
+}
+
 bool Ds4Device::openDevice(std::shared_ptr<hid::HidInstance>& hid, bool exclusive)
 {
 	if (hid->open((exclusive ? hid::HidOpenFlags::exclusive : 0) | hid::HidOpenFlags::async))
@@ -465,11 +523,11 @@ bool Ds4Device::openBluetoothDevice(std::shared_ptr<hid::HidInstance> hid)
 	std::array<uint8_t, 37> temp {};
 	temp[0] = 0x02;
 
-	// TODO: on failure, pull the error code from GetLastError internally instead of doing it manually
 	if (!hid->getFeature(temp))
 	{
+		const size_t nativeError = hid->nativeError();
 		hid->close();
-		onWirelessOperationalModeFailure.invoke(this, GetLastError());
+		onWirelessOperationalModeFailure.invoke(this, nativeError);
 		return false;
 	}
 
@@ -483,6 +541,7 @@ bool Ds4Device::openBluetoothDevice(std::shared_ptr<hid::HidInstance> hid)
 		onConnect.invoke(this, Ds4ConnectEvent(ConnectionType::bluetooth, Ds4ConnectEvent::Status::opened));
 	}
 
+	readMotionCalibration(*hid, ConnectionType::bluetooth);
 	bluetoothDevice = std::move(hid);
 
 	setupBluetoothOutputBuffer();
@@ -542,11 +601,29 @@ bool Ds4Device::openUsbDevice(std::shared_ptr<hid::HidInstance> hid)
 		onConnect.invoke(this, Ds4ConnectEvent(ConnectionType::usb, Ds4ConnectEvent::Status::opened));
 	}
 
+	readMotionCalibration(*hid, ConnectionType::usb);
 	usbDevice = std::move(hid);
 	setupUsbOutputBuffer();
 	return true;
 }
 
+void Ds4Device::readMotionCalibration(const hid::HidInstance& hid, ConnectionType connectionType)
+{
+	std::optional<Ds4MotionCalibration> calibration = Program::profileCache.getMotionCalibration(macAddress_);
+
+	if (!calibration.has_value())
+	{
+		calibration = Ds4MotionCalibration::read(hid, connectionType);
+
+		if (calibration.has_value())
+		{
+			Program::profileCache.setMotionCalibration(macAddress_, *calibration);
+		}
+	}
+
+	input.motion.setCalibration(calibration.value_or(Ds4MotionCalibration {}));
+}
+
 void Ds4Device::setupBluetoothOutputBuffer() const
 {
 	bluetoothDevice->outputBuffer[0] = 0x11;
@@ -586,6 +663,8 @@ void Ds4Device::writeUsbAsync()
 
 	usbDevice->writeAsync();
 	writeLatency.start();
+
+	captureReport(Ds4TraceRecordType::output, ConnectionType::usb, usbDevice->outputBuffer);
 }
 
 void Ds4Device::writeBluetooth()
@@ -613,6 +692,105 @@ void Ds4Device::writeBluetooth()
 	}
 
 	writeLatency.stop();
+
+	captureReport(Ds4TraceRecordType::output, ConnectionType::bluetooth, bluetoothDevice->outputBuffer);
+}
+
+void Ds4Device::updateIdleState(bool useBluetooth)
+{
+	const float lx = input.getAxis(Ds4Axes::leftStickX, std::nullopt);
+	const float ly = input.getAxis(Ds4Axes::leftStickY, std::nullopt);
+	const float ls = std::sqrt(lx * lx + ly * ly);
+
+	const float rx = input.getAxis(Ds4Axes::rightStickX, std::nullopt);
+	const float ry = input.getAxis(Ds4Axes::rightStickY, std::nullopt);
+	const float rs = std::sqrt(rx * rx + ry * ry);
+
+	// TODO: gyro/accel - definitely needs to be configurable
+	if (input.buttonsChanged || input.heldButtons ||
+	    ls >= 0.25f || rs >= 0.25f)
+	{
+		idleTime.start();
+	}
+	else if (disconnectOnIdle() && useBluetooth && !charging() && isIdle())
+	{
+		disconnectBluetooth(BluetoothDisconnectReason::idle);
+	}
+}
+
+void Ds4Device::captureReport(Ds4TraceRecordType type, ConnectionType connection, const std::vector<uint8_t>& buffer)
+{
+	if (traceWriter != nullptr)
+	{
+		traceWriter->record(type, connection, buffer);
+	}
+}
+
+void Ds4Device::processReport(const gsl::span<uint8_t>& buffer, bool useBluetooth)
+{
+	dataReceived = true;
+
+	const bool charging_   = charging();
+	const uint8_t battery_ = battery();
+
+	input.update(buffer);
+	updateIdleState(useBluetooth);
+
+	simulator.runMaps();
+	readLatency.stop();
+
+	const auto average = duration_cast<milliseconds>(readLatency.average());
+
+	if (average > settings.latencyThreshold)
+	{
+		if (!peakedLatencyThreshold)
+		{
+			// do the thing
+			peakedLatencyThreshold = true;
+			onLatencyThresholdExceeded.invoke(this, average, settings.latencyThreshold);
+		}
+	}
+	else
+	{
+		peakedLatencyThreshold = false;
+	}
+
+	readLatency.start();
+
+	if (charging_ != charging() || battery_ != battery())
+	{
+		displayPowerNotifications();
+		onBatteryLevelChanged.invoke(this);
+	}
+
+#if false
+	// Experimental garbage
+	if (input.pressedButtons & Ds4Buttons::ps)
+	{
+		// Set audio output to speaker only (3)
+		std::array<uint8_t, 3> buffer = {
+			0xE0,
+			0,
+			3
+		};
+
+		usbDevice->setFeature(buffer);
+
+		std::array<uint8_t, 0x20> volume {};
+		// Report ID
+		volume[0x00] = 5;
+		// Audio endpoints
+		volume[0x01] = 0x10 | 0x20 | 0x80; // Jack L, R, Speaker
+		// Jack L
+		volume[0x13] = 0;
+		// Jack R
+		volume[0x14] = 0;
+		// Speaker
+		volume[0x16] = 0;
+
+		usbDevice->write(volume);
+	}
+#endif
 }
 
 void Ds4Device::run()
@@ -631,9 +809,6 @@ void Ds4Device::run()
 		output.lightColor = Ds4Color::lerp(l.color, fadeColor, static_cast<float>(m));
 	}
 
-	const bool charging_   = charging();
-	const uint8_t battery_ = battery();
-
 	// cache
 	const bool usb = usbConnected();
 	const bool bluetooth = bluetoothConnected();
@@ -644,30 +819,20 @@ void Ds4Device::run()
 
 	dataReceived = false;
 
+	// Every queued report is processed individually so that
+	// button edges arriving between passes are never coalesced.
 	if (useUsb)
 	{
-		writeUsbAsync();
-
-		bool dataAvailable;
-
-		if (usbDevice->asyncReadPending())
-		{
-			dataAvailable = !usbDevice->asyncReadInProgress();
-		}
-		else
-		{
-			dataAvailable = usbDevice->readAsync();
-		}
+		constexpr auto usb_input_offset = 1;
 
-		if (dataAvailable)
+		while (usbDevice->readAsync())
 		{
-			dataReceived = true;
+			captureReport(Ds4TraceRecordType::input, ConnectionType::usb, usbDevice->inputBuffer);
 
-			constexpr auto usb_input_offset = 1;
 			const auto span = gsl::span(&usbDevice->inputBuffer[usb_input_offset],
 			                            usbDevice->inputBuffer.size() - usb_input_offset);
 
-			input.update(span);
+			processReport(span, useBluetooth);
 		}
 
 		// If the controller gets disconnected from USB while idle,
@@ -687,144 +852,199 @@ void Ds4Device::run()
 	}
 	else if (useBluetooth)
 	{
-		writeBluetooth();
+		constexpr auto bt_input_offset = 3;
 
-		bool dataAvailable;
-
-		if (bluetoothDevice->asyncReadPending())
-		{
-			dataAvailable = !bluetoothDevice->asyncReadInProgress();
-		}
-		else
+		while (bluetoothDevice->readAsync())
 		{
-			dataAvailable = bluetoothDevice->readAsync();
-		}
+			captureReport(Ds4TraceRecordType::input, ConnectionType::bluetooth, bluetoothDevice->inputBuffer);
 
-		if (dataAvailable && bluetoothDevice->inputBuffer[0] == 0x11)
-		{
-			dataReceived = true;
+			if (bluetoothDevice->inputBuffer[0] != 0x11)
+			{
+				continue;
+			}
 
-			constexpr auto bt_input_offset = 3;
 			const auto span = gsl::span(&bluetoothDevice->inputBuffer[bt_input_offset],
 			                            bluetoothDevice->inputBuffer.size() - bt_input_offset);
 
-			input.update(span);
+			processReport(span, useBluetooth);
 		}
 	}
 
-	const float lx = input.getAxis(Ds4Axes::leftStickX, std::nullopt);
-	const float ly = input.getAxis(Ds4Axes::leftStickY, std::nullopt);
-	const float ls = std::sqrt(lx * lx + ly * ly);
+	if (!dataReceived)
+	{
+		updateIdleState(useBluetooth);
 
-	const float rx = input.getAxis(Ds4Axes::rightStickX, std::nullopt);
-	const float ry = input.getAxis(Ds4Axes::rightStickY, std::nullopt);
-	const float rs = std::sqrt(rx * rx + ry * ry);
+		input.updateChangedState();
+		simulator.runPersistent();
+	}
 
-	// TODO: gyro/accel - definitely needs to be configurable
-	if (input.buttonsChanged || input.heldButtons ||
-	    ls >= 0.25f || rs >= 0.25f)
+	// Output is written after the maps have run so that changes
+	// caused by this report go out without waiting for the next one.
+	if (useUsb && usbConnected())
 	{
-		idleTime.start();
+		writeUsbAsync();
 	}
-	else if (disconnectOnIdle() && useBluetooth && !charging() && isIdle())
+	else if (useBluetooth && bluetoothConnected())
 	{
-		disconnectBluetooth(BluetoothDisconnectReason::idle);
+		writeBluetooth();
 	}
+}
+
+std::shared_ptr<hid::HidInstance> Ds4Device::activeDevice()
+{
+	auto lock_guard = lock();
 
-	if (dataReceived)
+	const bool usb = usbConnected();
+	const bool bluetooth = bluetoothConnected();
+
+	const ConnectionType preferredConnection = Program::settings.preferredConnection;
+
+	if (usb && (preferredConnection == +ConnectionType::usb || !bluetooth))
 	{
-		simulator.runMaps();
-		readLatency.stop();
+		return usbDevice;
+	}
 
-		const auto average = duration_cast<milliseconds>(readLatency.average());
+	if (bluetooth)
+	{
+		return bluetoothDevice;
+	}
 
-		if (average > settings.latencyThreshold)
-		{
-			if (!peakedLatencyThreshold)
-			{
-				// do the thing
-				peakedLatencyThreshold = true;
-				onLatencyThresholdExceeded.invoke(this, average, settings.latencyThreshold);
-			}
-		}
-		else
-		{
-			peakedLatencyThreshold = false;
-		}
+	return nullptr;
+}
+
+microseconds Ds4Device::waitTimeout()
+{
+	if (simulator.needsTick() || (usbConnected() && usbDevice->asyncWritePending()))
+	{
+		return tickInterval;
+	}
 
-		readLatency.start();
+	microseconds result = hid::HidInstance::infiniteWait;
 
-		if (charging_ != charging() || battery_ != battery())
-		{
-			displayPowerNotifications();
-			onBatteryLevelChanged.invoke(this);
-		}
+	// only wake for timed behaviour when its next timer actually expires
+	const std::optional<Stopwatch::TimePoint> deadline = simulator.nextDeadline();
 
-#if false
-		// Experimental garbage
-		if (input.pressedButtons & Ds4Buttons::ps)
-		{
-			// Set audio output to speaker only (3)
-			std::array<uint8_t, 3> buffer = {
-				0xE0,
-				0,
-				3
-			};
-
-			usbDevice->setFeature(buffer);
-
-			std::array<uint8_t, 0x20> volume {};
-			// Report ID
-			volume[0x00] = 5;
-			// Audio endpoints
-			volume[0x01] = 0x10 | 0x20 | 0x80; // Jack L, R, Speaker
-			// Jack L
-			volume[0x13] = 0;
-			// Jack R
-			volume[0x14] = 0;
-			// Speaker
-			volume[0x16] = 0;
-
-			usbDevice->write(volume);
-		}
-#endif
+	if (deadline.has_value())
+	{
+		const auto untilDeadline = std::chrono::ceil<microseconds>(*deadline - Stopwatch::now());
+		result = std::max(untilDeadline, 0us);
 	}
-	else
+
+	const auto timeout = idleTimeout();
+	const auto untilIdle = timeout - duration_cast<microseconds>(idleTime.elapsed());
+
+	if (untilIdle <= 0us)
 	{
-		input.updateChangedState();
-		simulator.runPersistent();
+		return result;
 	}
+
+	if (activeLight.idleFade)
+	{
+		result = std::min(result, std::max<microseconds>(timeout / idleFadeSteps, tickInterval));
+	}
+
+	if (disconnectOnIdle() && bluetoothConnected() && !charging())
+	{
+		result = std::min(result, std::max<microseconds>(untilIdle, tickInterval));
+	}
+
+	return result;
 }
 
-void Ds4Device::controllerThread()
+void Ds4Device::wake()
+{
+	std::lock_guard<std::mutex> guard(wait_lock);
+
+	if (waitDevice != nullptr)
+	{
+		waitDevice->interruptWait();
+	}
+}
+
+void Ds4Device::beginRun()
 {
 	simulator.start();
 	readLatency.start();
 	idleTime.start();
 	writeTime.start();
+}
 
-	while (connected() && running)
+bool Ds4Device::step(std::shared_ptr<hid::HidInstance>& device, microseconds& timeout)
+{
+	device = nullptr;
+	timeout = 0us;
+
+	if (!connected() || !running)
 	{
-		{
-			auto lock_guard = lock();
-			run();
-		}
+		return false;
+	}
+
+	{
+		auto lock_guard = lock();
+		run();
 
 		if (!dataReceived)
 		{
-			std::this_thread::sleep_for(1ms);
+			device = activeDevice();
+			timeout = waitTimeout();
 		}
 	}
 
+	if (device != nullptr)
+	{
+		std::lock_guard<std::mutex> guard(wait_lock);
+		waitDevice = device;
+	}
+
+	return true;
+}
+
+void Ds4Device::endRun()
+{
+	{
+		std::lock_guard<std::mutex> guard(wait_lock);
+		waitDevice = nullptr;
+	}
+
 	closeImpl();
 	onDeviceClose.invoke(this);
 }
 
+void Ds4Device::controllerThread()
+{
+	beginRun();
+
+	std::shared_ptr<hid::HidInstance> device;
+	microseconds timeout {};
+
+	while (step(device, timeout))
+	{
+		// Blocks until the pending read completes, a tick is due, or something
+		// calls wake(); the device lock is not held so other threads can use the device.
+		if (device != nullptr && running)
+		{
+			device->waitForRead(timeout);
+		}
+	}
+
+	endRun();
+}
+
 void Ds4Device::start()
 {
-	if (deviceThread == nullptr)
+	if (deviceThread == nullptr && reactor == nullptr)
 	{
 		running = true;
 		deviceThread = std::make_unique<std::thread>(&Ds4Device::controllerThread, this);
 	}
 }
+
+void Ds4Device::start(Ds4DeviceReactor& deviceReactor)
+{
+	if (deviceThread == nullptr && reactor == nullptr)
+	{
+		running = true;
+		reactor = &deviceReactor;
+		reactor->add(this);
+	}
+}
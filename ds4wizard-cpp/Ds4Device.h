@@ -1,5 +1,6 @@
 #pragma once
 
+#include <atomic>
 #include <chrono>
 #include <cstdint>
 #include <memory>
@@ -11,11 +12,14 @@
 #include "Stopwatch.h"
 #include "Ds4Input.h"
 #include "Ds4Output.h"
+#include "Ds4Trace.h"
 #include "Event.h"
 
 #include "Latency.h"
 #include "InputSimulator.h"
 
+class Ds4DeviceReactor;
+
 class Ds4ConnectEvent
 {
 public:
@@ -58,6 +62,10 @@ public:
 
 class Ds4Device
 {
+	friend class Ds4DeviceReactor;
+	friend class Ds4TraceReplay;
+	friend class InputBenchmarks;
+
 public:
 	using MacAddress = std::array<uint8_t, 6>;
 
@@ -66,7 +74,7 @@ private:
 	std::string macAddress_;
 	std::string safeMacAddress_;
 
-	bool running = false;
+	std::atomic<bool> running = false;
 	std::recursive_mutex sync_lock;
 
 	Stopwatch idleTime {};
@@ -83,6 +91,20 @@ private:
 	bool dataReceived = false;
 
 	std::unique_ptr<std::thread> deviceThread = nullptr;
+	Ds4DeviceReactor* reactor = nullptr;
+
+	/**
+	 * \brief Interval at which the device is run while persistent maps or simulators are active.
+	 */
+	static constexpr std::chrono::milliseconds tickInterval = std::chrono::milliseconds(1);
+
+	/**
+	 * \brief Number of distinct steps in the idle light fade.
+	 */
+	static constexpr int64_t idleFadeSteps = 255;
+
+	std::mutex wait_lock;
+	std::shared_ptr<hid::HidInstance> waitDevice;
 
 	std::shared_ptr<hid::HidInstance> usbDevice;
 	std::shared_ptr<hid::HidInstance> bluetoothDevice;
@@ -96,6 +118,12 @@ private:
 
 	InputSimulator simulator;
 
+	/**
+	 * \brief Receives every raw report while a capture is running.
+	 * \sa startCapture
+	 */
+	std::unique_ptr<Ds4TraceWriter> traceWriter;
+
 	// TODO: rather than storing a boolean, implement a run-once, resettable callback
 	bool notifiedLow = false;
 	// TODO: rather than storing a boolean, implement a run-once, resettable callback
@@ -190,19 +218,108 @@ public:
 	void disconnectBluetooth(BluetoothDisconnectReason reason);
 
 	void closeUsbDevice();
+
+	/**
+	 * \brief Starts appending every raw input and output report to a trace file.
+	 * The file is written off the device thread, so this is cheap enough to leave running.
+	 * \param path Path of the trace file to create. An existing file is overwritten.
+	 * \return \c true if the file was created.
+	 * \sa Ds4TraceWriter
+	 */
+	bool startCapture(const std::string& path);
+
+	/**
+	 * \brief Stops a capture started with \c startCapture and finishes writing its file.
+	 */
+	void stopCapture();
+
+	bool capturing();
+
 	static bool openDevice(std::shared_ptr<hid::HidInstance>& hid, bool exclusive);
 
 	bool openBluetoothDevice(std::shared_ptr<hid::HidInstance> hid);
 	bool openUsbDevice(std::shared_ptr<hid::HidInstance> hid);
 
 private:
+	/**
+	 * \brief Applies the motion calibration of this controller to \c input,
+	 * reading it from \p hid only if it isn't already cached for this MAC address.
+	 * Uncalibrated defaults are used if the report can't be read.
+	 */
+	void readMotionCalibration(const hid::HidInstance& hid, ConnectionType connectionType);
+
 	void setupBluetoothOutputBuffer() const;
 	void setupUsbOutputBuffer() const;
 	void writeUsbAsync();
 	void writeBluetooth();
+
+	/**
+	 * \brief Resets the idle timer on activity, or disconnects Bluetooth once idle for long enough.
+	 * \param useBluetooth \c true if Bluetooth is the connection being read from.
+	 */
+	void updateIdleState(bool useBluetooth);
+
+	/**
+	 * \brief Updates input state from a single report and runs the input maps.
+	 * \param buffer Report data, starting after the connection-specific header.
+	 * \param useBluetooth \c true if the report was read over Bluetooth.
+	 */
+	void processReport(const gsl::span<uint8_t>& buffer, bool useBluetooth);
+
+	/**
+	 * \brief Appends a raw report to the trace if a capture is running.
+	 */
+	void captureReport(Ds4TraceRecordType type, ConnectionType connection, const std::vector<uint8_t>& buffer);
+
 	void run();
+
+	/**
+	 * \brief Gets the device handle that \c run reads from given the preferred connection type.
+	 * \return The active device handle, or \c nullptr if neither connection is open.
+	 */
+	std::shared_ptr<hid::HidInstance> activeDevice();
+
+	/**
+	 * \brief Determines how long the device thread may wait for input before \c run has work to do regardless.
+	 * \return The time until the next required tick, or \c hid::HidInstance::infiniteWait.
+	 */
+	std::chrono::microseconds waitTimeout();
+
+	/**
+	 * \brief Prepares timers and simulators before the first call to \c step.
+	 */
+	void beginRun();
+
+	/**
+	 * \brief Runs a single pass of the device loop.
+	 * \param device Receives the handle to wait on before the next pass, or \c nullptr if the next pass should run immediately.
+	 * \param timeout Receives the longest time that may pass before the next pass.
+	 * \return \c false once the device has been disconnected or closed.
+	 */
+	bool step(std::shared_ptr<hid::HidInstance>& device, std::chrono::microseconds& timeout);
+
+	/**
+	 * \brief Closes the device after its last pass and fires \c onDeviceClose.
+	 */
+	void endRun();
+
 	void controllerThread();
 
 public:
+	/**
+	 * \brief Starts servicing the device on a dedicated thread.
+	 */
 	void start();
+
+	/**
+	 * \brief Starts servicing the device on a thread shared with other devices.
+	 * \param deviceReactor The reactor that will run this device until it is closed.
+	 */
+	void start(Ds4DeviceReactor& deviceReactor);
+
+	/**
+	 * \brief Wakes the device thread if it's waiting for input.
+	 * May be called from any thread.
+	 */
+	void wake();
 };
@@ -5,6 +5,7 @@
 
 #include <fmt/format.h>
 
+#include <hid_backend.h>
 #include <hid_util.h>
 #include <devicetoggle.h>
 
@@ -36,8 +37,8 @@ bool Ds4DeviceManager::isDs4(const hid::HidInstance& hid)
 
 bool Ds4DeviceManager::isDs4(const std::wstring& devicePath)
 {
-	hid::HidInstance hid(devicePath);
-	return hid.readMetadata() && isDs4(hid);
+	const auto hid = hid::backend()->create(devicePath);
+	return hid->readMetadata() && isDs4(*hid);
 }
 
 void Ds4DeviceManager::findControllers()
@@ -57,19 +58,18 @@ void Ds4DeviceManager::findController(const std::wstring& devicePath)
 		return;
 	}
 
-	GUID guid = {};
-	HidD_GetHidGuid(&guid);
-
 	MAKE_GUARD(sync_lock);
 
-	hid::enumerateGuid([&](const std::wstring& path, const std::wstring& instanceId) -> bool
+	const auto backend = hid::backend();
+
+	backend->enumerate([&](const std::wstring& path, const std::wstring& instanceId) -> bool
 	{
 		if (!iequals(path, devicePath))
 		{
 			return false;
 		}
 
-		auto hid = std::make_shared<hid::HidInstance>(path, instanceId);
+		auto hid = backend->create(path, instanceId);
 
 		if (hid->readMetadata())
 		{
@@ -77,7 +77,7 @@ void Ds4DeviceManager::findController(const std::wstring& devicePath)
 		}
 
 		return false;
-	}, guid);
+	});
 }
 
 size_t Ds4DeviceManager::deviceCount()
@@ -325,7 +325,20 @@ bool Ds4DeviceManager::handleDevice(std::shared_ptr<hid::HidInstance> hid)
 
 			auto args = std::make_shared<DeviceOpenedEventArgs>(device, true);
 			deviceOpened.invoke(this, args);
-			device->start();
+
+			if (Program::settings.captureTraces)
+			{
+				startCapture(*device);
+			}
+
+			if (Program::settings.deviceThreading == +DeviceThreading::reactor)
+			{
+				device->start(reactor);
+			}
+			else
+			{
+				device->start();
+			}
 		}
 		else
 		{
@@ -363,6 +376,19 @@ bool Ds4DeviceManager::handleDevice(std::shared_ptr<hid::HidInstance> hid)
 	return false;
 }
 
+void Ds4DeviceManager::startCapture(Ds4Device& device)
+{
+	QDir().mkpath(QString::fromStdString(Program::tracesPath()));
+
+	const std::string time = QDateTime::currentDateTime().toString("yyyyMMdd-HHmmss").toStdString();
+	const std::string path = fmt::format("{}/{}-{}.ds4trace", Program::tracesPath(), device.safeMacAddress(), time);
+
+	if (!device.startCapture(path))
+	{
+		Logger::writeLine(LogLevel::warning, device.name(), "Failed to start trace capture: " + path);
+	}
+}
+
 void Ds4DeviceManager::onDs4DeviceClose(Ds4Device* sender)
 {
 	LOCK(devices);
@@ -7,6 +7,7 @@
 
 #include <hid_instance.h>
 #include "Ds4Device.h"
+#include "Ds4DeviceReactor.h"
 #include "Event.h"
 
 class DeviceOpenedEventArgs
@@ -50,6 +51,12 @@ class Ds4DeviceManager
 	std::recursive_mutex sync_lock, devices_lock;
 	std::unordered_map<std::wstring, std::deque<EventToken>> tokens;
 
+	/**
+	 * \brief Runs devices when \c Settings::deviceThreading is \c DeviceThreading::reactor.
+	 * Declared before \c devices so it outlives them.
+	 */
+	Ds4DeviceReactor reactor;
+
 public:
 	std::map<std::wstring, std::shared_ptr<Ds4Device>> devices;
 
@@ -111,6 +118,12 @@ public:
 
 private:
 	bool handleDevice(std::shared_ptr<hid::HidInstance> hid);
+
+	/**
+	 * \brief Starts capturing \p device to a new trace file in \c Program::tracesPath.
+	 * \sa Settings::captureTraces
+	 */
+	static void startCapture(Ds4Device& device);
 	void onDs4DeviceClose(Ds4Device* sender);
 
 public:
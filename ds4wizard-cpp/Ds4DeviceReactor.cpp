@@ -0,0 +1,298 @@
+#include "pch.h"
+
+#include <algorithm>
+
+#include "Ds4Device.h"
+#include "Ds4DeviceReactor.h"
+
+using namespace std::chrono;
+
+Ds4DeviceReactor::~Ds4DeviceReactor()
+{
+	decltype(workers) workers_;
+
+	{
+		// Not held while joining: closing a device from a worker calls back into remove.
+		std::lock_guard<std::mutex> guard(sync);
+		workers_ = std::move(workers);
+	}
+
+	for (auto& worker : workers_)
+	{
+		{
+			std::lock_guard<std::mutex> worker_guard(worker->sync);
+			worker->stopping = true;
+			wakeWorker(*worker);
+		}
+
+		worker->thread.join();
+	}
+}
+
+void Ds4DeviceReactor::add(Ds4Device* device)
+{
+	std::lock_guard<std::mutex> guard(sync);
+
+	if (backend == nullptr)
+	{
+		backend = hid::backend();
+	}
+
+	const size_t capacity = std::max<size_t>(backend->maxWaitCount(), 1);
+
+	for (auto& worker : workers)
+	{
+		std::lock_guard<std::mutex> worker_guard(worker->sync);
+
+		if (worker->members.size() < capacity)
+		{
+			worker->members.push_back(device);
+			worker->added.push_back(device);
+			wakeWorker(*worker);
+			return;
+		}
+	}
+
+	auto worker = std::make_unique<Worker>();
+	worker->members.push_back(device);
+	worker->added.push_back(device);
+	worker->thread = std::thread(&Ds4DeviceReactor::workerThread, this, std::ref(*worker));
+
+	workers.push_back(std::move(worker));
+}
+
+void Ds4DeviceReactor::remove(Ds4Device* device)
+{
+	Worker* owner = nullptr;
+
+	{
+		std::lock_guard<std::mutex> guard(sync);
+
+		for (auto& worker : workers)
+		{
+			std::lock_guard<std::mutex> worker_guard(worker->sync);
+
+			if (std::find(worker->members.begin(), worker->members.end(), device) != worker->members.end())
+			{
+				owner = worker.get();
+				break;
+			}
+		}
+	}
+
+	// Workers are only destroyed with the reactor, so the owner can be used without holding the reactor lock.
+	if (owner == nullptr || owner->thread.get_id() == std::this_thread::get_id())
+	{
+		return;
+	}
+
+	std::unique_lock<std::mutex> worker_guard(owner->sync);
+
+	owner->signal.wait(worker_guard, [&]() -> bool
+	{
+		return std::find(owner->members.begin(), owner->members.end(), device) == owner->members.end();
+	});
+}
+
+size_t Ds4DeviceReactor::threadCount()
+{
+	std::lock_guard<std::mutex> guard(sync);
+	return workers.size();
+}
+
+void Ds4DeviceReactor::wakeWorker(Worker& worker)
+{
+	worker.signal.notify_all();
+
+	if (worker.waitTarget != nullptr)
+	{
+		worker.waitTarget->interruptWait();
+	}
+}
+
+void Ds4DeviceReactor::workerThread(Worker& worker)
+{
+	std::vector<Entry> entries;
+	std::vector<Ds4Device*> starting;
+	std::vector<Ds4Device*> finished;
+	std::vector<hid::HidInstance*> waitInstances;
+	std::vector<hid::HidInstance*> ready;
+
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> guard(worker.sync);
+
+			if (entries.empty())
+			{
+				worker.signal.wait(guard, [&]() -> bool
+				{
+					return worker.stopping || !worker.added.empty();
+				});
+
+				if (worker.stopping && worker.added.empty())
+				{
+					break;
+				}
+			}
+
+			std::swap(starting, worker.added);
+		}
+
+		for (Ds4Device* device : starting)
+		{
+			device->beginRun();
+			entries.push_back({ device, nullptr, steady_clock::time_point::min(), true });
+		}
+
+		starting.clear();
+
+		bool stopping;
+
+		{
+			std::lock_guard<std::mutex> guard(worker.sync);
+			stopping = worker.stopping;
+		}
+
+		if (stopping)
+		{
+			// Anything still running at this point is shut down the same way Ds4Device::close would.
+			for (Entry& entry : entries)
+			{
+				entry.device->running = false;
+				entry.ready = true;
+			}
+		}
+
+		const auto now = steady_clock::now();
+
+		for (auto it = entries.begin(); it != entries.end();)
+		{
+			Entry& entry = *it;
+
+			if (!entry.ready && now < entry.deadline)
+			{
+				++it;
+				continue;
+			}
+
+			std::shared_ptr<hid::HidInstance> waitInstance;
+			microseconds timeout {};
+
+			if (!entry.device->step(waitInstance, timeout))
+			{
+				finished.push_back(entry.device);
+				it = entries.erase(it);
+				continue;
+			}
+
+			entry.ready = false;
+			entry.waitInstance = std::move(waitInstance);
+
+			if (entry.waitInstance == nullptr)
+			{
+				// more data may already be queued, so run it again on the next pass
+				entry.deadline = now;
+			}
+			else if (timeout == hid::HidInstance::infiniteWait)
+			{
+				entry.deadline = steady_clock::time_point::max();
+			}
+			else
+			{
+				entry.deadline = now + timeout;
+			}
+
+			++it;
+		}
+
+		if (!finished.empty())
+		{
+			for (Ds4Device* device : finished)
+			{
+				// May destroy the device; it must not be touched again afterward.
+				device->endRun();
+
+				std::lock_guard<std::mutex> guard(worker.sync);
+				const auto it = std::find(worker.members.begin(), worker.members.end(), device);
+
+				if (it != worker.members.end())
+				{
+					worker.members.erase(it);
+				}
+			}
+
+			finished.clear();
+			worker.signal.notify_all();
+		}
+
+		if (entries.empty())
+		{
+			continue;
+		}
+
+		auto until = steady_clock::time_point::max();
+		waitInstances.clear();
+
+		for (const Entry& entry : entries)
+		{
+			until = std::min(until, entry.deadline);
+
+			if (entry.waitInstance != nullptr)
+			{
+				waitInstances.push_back(entry.waitInstance.get());
+			}
+		}
+
+		const auto waitStart = steady_clock::now();
+
+		if (until <= waitStart)
+		{
+			continue;
+		}
+
+		{
+			std::unique_lock<std::mutex> guard(worker.sync);
+
+			if (worker.stopping || !worker.added.empty())
+			{
+				continue;
+			}
+
+			if (waitInstances.empty())
+			{
+				worker.signal.wait_until(guard, until, [&]() -> bool
+				{
+					return worker.stopping || !worker.added.empty();
+				});
+
+				continue;
+			}
+
+			worker.waitTarget = waitInstances.front();
+		}
+
+		const microseconds timeout = until == steady_clock::time_point::max()
+		                             ? hid::HidInstance::infiniteWait
+		                             : ceil<microseconds>(until - waitStart);
+
+		ready.clear();
+		backend->waitAny(waitInstances, timeout, ready);
+
+		{
+			std::lock_guard<std::mutex> guard(worker.sync);
+			worker.waitTarget = nullptr;
+		}
+
+		for (hid::HidInstance* instance : ready)
+		{
+			for (Entry& entry : entries)
+			{
+				if (entry.waitInstance.get() == instance)
+				{
+					entry.ready = true;
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <hid_backend.h>
+
+class Ds4Device;
+
+/**
+ * \brief Runs devices on a small pool of shared threads instead of one thread per device.
+ * Each thread waits on the pending reads of up to \c hid::HidBackend::maxWaitCount devices
+ * at once and only runs the devices that have input available or a tick due.
+ * \sa Ds4Device::start(Ds4DeviceReactor&)
+ */
+class Ds4DeviceReactor
+{
+	struct Entry
+	{
+		Ds4Device* device;
+		std::shared_ptr<hid::HidInstance> waitInstance;
+		std::chrono::steady_clock::time_point deadline;
+		bool ready;
+	};
+
+	struct Worker
+	{
+		std::thread thread;
+		std::mutex sync;
+		std::condition_variable signal;
+
+		// devices waiting to be picked up by the worker thread
+		std::vector<Ds4Device*> added;
+		// every device owned by this worker, including those in `added`
+		std::vector<Ds4Device*> members;
+
+		// instance the worker thread is currently blocked on, if any
+		hid::HidInstance* waitTarget = nullptr;
+		bool stopping = false;
+	};
+
+	std::mutex sync;
+	std::shared_ptr<hid::HidBackend> backend;
+	std::vector<std::unique_ptr<Worker>> workers;
+
+public:
+	Ds4DeviceReactor() = default;
+	~Ds4DeviceReactor();
+
+	Ds4DeviceReactor(const Ds4DeviceReactor&) = delete;
+	Ds4DeviceReactor& operator=(const Ds4DeviceReactor&) = delete;
+
+	/**
+	 * \brief Starts running \p device on a worker with room for it, creating a new worker if necessary.
+	 */
+	void add(Ds4Device* device);
+
+	/**
+	 * \brief Waits for the worker running \p device to finish with it.
+	 * The device must already have been told to stop; see \c Ds4Device::close.
+	 * Returns immediately if called from the worker itself, or if \p device is not managed by this reactor.
+	 */
+	void remove(Ds4Device* device);
+
+	/**
+	 * \brief Number of worker threads that have been started.
+	 */
+	size_t threadCount();
+
+private:
+	static void wakeWorker(Worker& worker);
+	void workerThread(Worker& worker);
+};
@@ -0,0 +1,241 @@
+#include "pch.h"
+
+#include <algorithm>
+
+#include "Ds4GestureRecognizer.h"
+
+void Ds4GestureRecognizer::update(const Ds4TouchSample& sample)
+{
+	lastActive = active();
+	events_ = 0;
+
+	// reports that repeat the touch frame carry no new touch data, so they don't move anything
+	const bool newTouchData = !hasSample || sample.touchFrame != lastTouchFrame;
+	const float deltaTime = hasSample ? std::chrono::duration<float>(sample.timestamp - lastTouchTime).count() : 0.0f;
+
+	for (size_t i = 0; i < contacts.size(); ++i)
+	{
+		Contact& contact = contacts[i];
+
+		const bool down = (sample.touches & (i == 0 ? Ds4Buttons::touch1 : Ds4Buttons::touch2)) != 0;
+		const Ds4Vector2& raw = i == 0 ? sample.point1 : sample.point2;
+		const Vector2 point(static_cast<float>(raw.x), static_cast<float>(raw.y));
+
+		if (down && !contact.down)
+		{
+			beginContact(contact, point, sample.timestamp);
+		}
+		else if (down && newTouchData)
+		{
+			moveContact(contact, point, deltaTime);
+		}
+		else if (!down && contact.down)
+		{
+			endContact(contact);
+		}
+	}
+
+	updatePinch();
+
+	if (inSession && !contacts[0].down && !contacts[1].down)
+	{
+		endSession(sample.timestamp);
+	}
+
+	if (newTouchData)
+	{
+		hasSample      = true;
+		lastTouchTime  = sample.timestamp;
+		lastTouchFrame = sample.touchFrame;
+	}
+}
+
+void Ds4GestureRecognizer::reset()
+{
+	*this = Ds4GestureRecognizer();
+}
+
+bool Ds4GestureRecognizer::isActive(TouchGesture_t gestures, Direction_t direction) const
+{
+	const TouchGesture_t matched = active() & gestures;
+
+	if (!matched)
+	{
+		return false;
+	}
+
+	if (direction == Direction::none)
+	{
+		return true;
+	}
+
+	constexpr TouchGesture_t directional = TouchGesture::flick | TouchGesture::swipe;
+	return (matched & ~directional) != 0 || (direction_ & direction) != 0;
+}
+
+float Ds4GestureRecognizer::magnitude(TouchGesture_t gestures) const
+{
+	const TouchGesture_t matched = active() & gestures;
+	float result = 0.0f;
+
+	if (matched & (TouchGesture::swipe | TouchGesture::tap | TouchGesture::doubleTap | TouchGesture::twoFingerTap))
+	{
+		result = 1.0f;
+	}
+
+	if (matched & TouchGesture::flick)
+	{
+		result = std::max(result, std::min(flickVelocity_.length() / flickFullSpeed, 1.0f));
+	}
+
+	if (matched & (TouchGesture::pinchIn | TouchGesture::pinchOut))
+	{
+		result = std::max(result, std::min(std::abs(pinchScale_ - 1.0f) / pinchFullScale, 1.0f));
+	}
+
+	return result;
+}
+
+Direction_t Ds4GestureRecognizer::toDirection(const Vector2& v)
+{
+	if (v == Vector2::zero)
+	{
+		return Direction::none;
+	}
+
+	if (std::abs(v.x) >= std::abs(v.y))
+	{
+		return v.x < 0.0f ? Direction::left : Direction::right;
+	}
+
+	// touch pad Y increases downward
+	return v.y < 0.0f ? Direction::up : Direction::down;
+}
+
+void Ds4GestureRecognizer::beginContact(Contact& contact, const Vector2& point, TimePoint time)
+{
+	if (!inSession)
+	{
+		inSession       = true;
+		sessionStart    = time;
+		sessionContacts = 0;
+		sessionMoved    = false;
+		sessionSwiped   = false;
+		sessionPinched  = false;
+		sessionPoint    = point;
+	}
+
+	++sessionContacts;
+
+	contact.down       = true;
+	contact.startPoint = point;
+	contact.point      = point;
+	contact.velocity   = Vector2::zero;
+	contact.travel     = 0.0f;
+
+	if (contacts[0].down && contacts[1].down)
+	{
+		pinchStartDistance = (contacts[0].point - contacts[1].point).length();
+	}
+}
+
+void Ds4GestureRecognizer::moveContact(Contact& contact, const Vector2& point, float deltaTime)
+{
+	if (deltaTime > 0.0f)
+	{
+		const Vector2 instant = (point - contact.point) / deltaTime;
+		contact.velocity = Vector2::lerp(contact.velocity, instant, velocitySmoothing);
+	}
+
+	contact.point  = point;
+	contact.travel = std::max(contact.travel, (point - contact.startPoint).length());
+
+	if (contact.travel > tapTravel)
+	{
+		sessionMoved = true;
+	}
+
+	if (sessionContacts == 1 && !sessionSwiped && contact.travel >= swipeTravel)
+	{
+		sessionSwiped = true;
+		events_ |= TouchGesture::swipe;
+		direction_ = toDirection(point - contact.startPoint);
+	}
+}
+
+void Ds4GestureRecognizer::endContact(Contact& contact)
+{
+	contact.down = false;
+
+	if (sessionContacts == 1 && contact.velocity.length() >= flickSpeed)
+	{
+		// a flick is never also a tap, no matter how short it was
+		sessionMoved = true;
+
+		events_ |= TouchGesture::flick;
+		flickVelocity_ = contact.velocity;
+		direction_ = toDirection(contact.velocity);
+	}
+}
+
+void Ds4GestureRecognizer::endSession(TimePoint time)
+{
+	inSession = false;
+
+	if (sessionMoved || sessionPinched || time - sessionStart > tapDuration)
+	{
+		hasTap = false;
+		return;
+	}
+
+	if (sessionContacts > 1)
+	{
+		events_ |= TouchGesture::twoFingerTap;
+		hasTap = false;
+		return;
+	}
+
+	if (hasTap && time - lastTapTime <= doubleTapInterval &&
+	    (sessionPoint - lastTapPoint).length() <= doubleTapDistance)
+	{
+		events_ |= TouchGesture::doubleTap;
+		hasTap = false;
+		return;
+	}
+
+	events_ |= TouchGesture::tap;
+
+	hasTap       = true;
+	lastTapTime  = time;
+	lastTapPoint = sessionPoint;
+}
+
+void Ds4GestureRecognizer::updatePinch()
+{
+	if (!contacts[0].down || !contacts[1].down || pinchStartDistance < 1.0f)
+	{
+		held_ = 0;
+		pinchScale_ = 1.0f;
+		return;
+	}
+
+	pinchScale_ = (contacts[0].point - contacts[1].point).length() / pinchStartDistance;
+
+	if (pinchScale_ <= 1.0f - pinchThreshold)
+	{
+		held_ = TouchGesture::pinchIn;
+	}
+	else if (pinchScale_ >= 1.0f + pinchThreshold)
+	{
+		held_ = TouchGesture::pinchOut;
+	}
+	else
+	{
+		held_ = 0;
+	}
+
+	if (held_ != 0)
+	{
+		sessionPinched = true;
+	}
+}
@@ -0,0 +1,201 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+
+#include "enums.h"
+#include "Ds4TouchHistory.h"
+#include "Vector2.h"
+
+/**
+ * \brief Recognizes touch pad gestures from the touch sample stream of a device.
+ * Each sample is consumed once in constant time; nothing is allocated.
+ * \sa TouchGesture, Ds4TouchHistoryRing
+ */
+class Ds4GestureRecognizer
+{
+public:
+	using TimePoint = Ds4TouchHistory::TimePoint;
+
+	/**
+	 * \brief Longest a touch may be held and still count as a tap.
+	 */
+	static constexpr auto tapDuration = std::chrono::milliseconds(200);
+
+	/**
+	 * \brief Longest time between the end of a tap and the end of the next for a double-tap.
+	 */
+	static constexpr auto doubleTapInterval = std::chrono::milliseconds(300);
+
+	/**
+	 * \brief Furthest a tap may move, in touch pad units.
+	 */
+	static constexpr float tapTravel = 40.0f;
+
+	/**
+	 * \brief Furthest apart the two taps of a double-tap may be, in touch pad units.
+	 */
+	static constexpr float doubleTapDistance = 150.0f;
+
+	/**
+	 * \brief Distance from its start point at which a single touch becomes a swipe, in touch pad units.
+	 */
+	static constexpr float swipeTravel = 300.0f;
+
+	/**
+	 * \brief Slowest a single touch may be released at to count as a flick, in touch pad units per second.
+	 */
+	static constexpr float flickSpeed = 2500.0f;
+
+	/**
+	 * \brief Flick speed reported as full magnitude. \sa magnitude
+	 */
+	static constexpr float flickFullSpeed = 10000.0f;
+
+	/**
+	 * \brief How far the pinch scale must move from \c 1 to count as a pinch.
+	 */
+	static constexpr float pinchThreshold = 0.15f;
+
+	/**
+	 * \brief How far the pinch scale must move from \c 1 to be reported as full magnitude. \sa magnitude
+	 */
+	static constexpr float pinchFullScale = 0.5f;
+
+	/**
+	 * \brief Weight of the newest sample in the smoothed touch velocity.
+	 */
+	static constexpr float velocitySmoothing = 0.5f;
+
+private:
+	struct Contact
+	{
+		bool down = false;
+		Vector2 startPoint {};
+		Vector2 point {};
+		Vector2 velocity {};
+		float travel = 0.0f;
+	};
+
+	std::array<Contact, 2> contacts {};
+
+	bool hasSample = false;
+	TimePoint lastTouchTime {};
+	uint8_t lastTouchFrame = 0;
+
+	/**
+	 * \brief Set while any touch is down; a session ends when every touch is lifted.
+	 */
+	bool inSession = false;
+	TimePoint sessionStart {};
+	int sessionContacts = 0;
+	bool sessionMoved = false;
+	bool sessionSwiped = false;
+	bool sessionPinched = false;
+
+	/**
+	 * \brief Where the first touch of the session started.
+	 */
+	Vector2 sessionPoint {};
+
+	float pinchStartDistance = 0.0f;
+
+	bool hasTap = false;
+	TimePoint lastTapTime {};
+	Vector2 lastTapPoint {};
+
+	TouchGesture_t events_ = 0;
+	TouchGesture_t held_ = 0;
+	TouchGesture_t lastActive = 0;
+
+	Direction_t direction_ = Direction::none;
+	Vector2 flickVelocity_ {};
+	float pinchScale_ = 1.0f;
+
+public:
+	/**
+	 * \brief Consumes the next touch sample.
+	 * \param sample The sample, which must be newer than the last one.
+	 */
+	void update(const Ds4TouchSample& sample);
+
+	void reset();
+
+	/**
+	 * \brief Gestures that were completed by the last sample. These only last for one sample.
+	 */
+	[[nodiscard]] TouchGesture_t events() const
+	{
+		return events_;
+	}
+
+	/**
+	 * \brief Gestures that are being held, i.e. pinches.
+	 */
+	[[nodiscard]] TouchGesture_t held() const
+	{
+		return held_;
+	}
+
+	[[nodiscard]] TouchGesture_t active() const
+	{
+		return events_ | held_;
+	}
+
+	/**
+	 * \brief Indicates if the set of \c active gestures changed with the last sample.
+	 */
+	[[nodiscard]] bool changed() const
+	{
+		return active() != lastActive;
+	}
+
+	/**
+	 * \brief Direction of the last flick or swipe.
+	 */
+	[[nodiscard]] Direction_t direction() const
+	{
+		return direction_;
+	}
+
+	/**
+	 * \brief Velocity of the last flick in touch pad units per second.
+	 */
+	[[nodiscard]] const Vector2& flickVelocity() const
+	{
+		return flickVelocity_;
+	}
+
+	/**
+	 * \brief Distance between two held touches relative to their distance when the second touch started, or \c 1.
+	 */
+	[[nodiscard]] float pinchScale() const
+	{
+		return pinchScale_;
+	}
+
+	/**
+	 * \brief Checks if any of \p gestures is active.
+	 * \param gestures The gestures to check.
+	 * \param direction If not \c Direction::none, flicks and swipes must also be in one of these directions.
+	 */
+	[[nodiscard]] bool isActive(TouchGesture_t gestures, Direction_t direction) const;
+
+	/**
+	 * \brief Gets the strength of the active gestures in \p gestures from \c 0 to \c 1.
+	 * Taps and swipes are \c 1; flicks and pinches scale with speed and scale respectively.
+	 */
+	[[nodiscard]] float magnitude(TouchGesture_t gestures) const;
+
+	/**
+	 * \brief Gets the direction a vector is mostly pointing in on the touch pad.
+	 */
+	static Direction_t toDirection(const Vector2& v);
+
+private:
+	void beginContact(Contact& contact, const Vector2& point, TimePoint time);
+	void moveContact(Contact& contact, const Vector2& point, float deltaTime);
+	void endContact(Contact& contact);
+	void endSession(TimePoint time);
+	void updatePinch();
+};
@@ -113,12 +113,13 @@ void Ds4Input::update(const gsl::span<uint8_t>& buffer)
 	data.frameCount        = static_cast<uint8_t>((buffer[6] >> 2) & 0x3F);
 	data.leftTrigger       = buffer[7];
 	data.rightTrigger      = buffer[8];
-	data.accel.x           = *reinterpret_cast<int16_t*>(&buffer[12]);
-	data.accel.y           = *reinterpret_cast<int16_t*>(&buffer[14]);
-	data.accel.z           = *reinterpret_cast<int16_t*>(&buffer[16]);
-	data.gyro.x            = *reinterpret_cast<int16_t*>(&buffer[18]);
-	data.gyro.y            = *reinterpret_cast<int16_t*>(&buffer[20]);
-	data.gyro.z            = *reinterpret_cast<int16_t*>(&buffer[22]);
+	data.timestamp         = *reinterpret_cast<uint16_t*>(&buffer[9]);
+	data.gyro.x            = *reinterpret_cast<int16_t*>(&buffer[12]);
+	data.gyro.y            = *reinterpret_cast<int16_t*>(&buffer[14]);
+	data.gyro.z            = *reinterpret_cast<int16_t*>(&buffer[16]);
+	data.accel.x           = *reinterpret_cast<int16_t*>(&buffer[18]);
+	data.accel.y           = *reinterpret_cast<int16_t*>(&buffer[20]);
+	data.accel.z           = *reinterpret_cast<int16_t*>(&buffer[22]);
 	data.extensions        = static_cast<uint8_t>(buffer[29] >> 4);
 	data.battery           = static_cast<uint8_t>(buffer[29] & 0x0F);
 	data.touchEvent        = static_cast<uint8_t>(buffer[32] & 0x3F);
@@ -137,6 +138,7 @@ void Ds4Input::update(const gsl::span<uint8_t>& buffer)
 	data.lastTouchPoint2.y = static_cast<short>((*reinterpret_cast<int16_t*>(&buffer[48]) >> 4) & 0xFFF);
 
 	updateAxes(last);
+	motion.update(data);
 
 	if (!(data.extensions & Ds4Extensions::cable))
 	{
@@ -203,29 +205,31 @@ float Ds4Input::getAxis(Ds4Axes_t axis, const std::optional<AxisPolarity>& polar
 			break;
 
 		case Ds4Axes::accelX:
-			result = std::clamp(static_cast<float>(data.accel.x) / (std::numeric_limits<short>::max() + 1.0f), 0.0f, 1.0f);
+			result = motion.acceleration().x / Ds4MotionProcessor::accelerationRange;
 			break;
 		case Ds4Axes::accelY:
-			result = std::clamp(static_cast<float>(data.accel.y) / (std::numeric_limits<short>::max() + 1.0f), 0.0f, 1.0f);
+			result = motion.acceleration().y / Ds4MotionProcessor::accelerationRange;
 			break;
 		case Ds4Axes::accelZ:
-			result = std::clamp(static_cast<float>(data.accel.z) / (std::numeric_limits<short>::max() + 1.0f), 0.0f, 1.0f);
+			result = motion.acceleration().z / Ds4MotionProcessor::accelerationRange;
 			break;
 
 		case Ds4Axes::gyroX:
-			result = std::clamp(static_cast<float>(data.gyro.x) / (std::numeric_limits<short>::max() + 1.0f), 0.0f, 1.0f);
+			result = motion.angularVelocity().x / Ds4MotionProcessor::angularVelocityRange;
 			break;
 		case Ds4Axes::gyroY:
-			result = std::clamp(static_cast<float>(data.gyro.y) / (std::numeric_limits<short>::max() + 1.0f), 0.0f, 1.0f);
+			result = motion.angularVelocity().y / Ds4MotionProcessor::angularVelocityRange;
 			break;
 		case Ds4Axes::gyroZ:
-			result = std::clamp(static_cast<float>(data.gyro.z) / (std::numeric_limits<short>::max() + 1.0f), 0.0f, 1.0f);
+			result = motion.angularVelocity().z / Ds4MotionProcessor::angularVelocityRange;
 			break;
 
 		default:
 			throw std::out_of_range("invalid Ds4Axes");
 	}
 
+	result = std::clamp(result, -1.0f, 1.0f);
+
 	if (!polarity)
 	{
 		return result;
@@ -5,6 +5,7 @@
 #include <gsl/span>
 
 #include "Ds4InputData.h"
+#include "Ds4Motion.h"
 
 /**
  * \brief Serialized input report from a \c Ds4Device
@@ -51,6 +52,12 @@ public:
 
 	Ds4InputData data {};
 
+	/**
+	 * \brief Calibrated motion derived from the gyroscope and accelerometer of each report.
+	 * \sa Ds4Device
+	 */
+	Ds4MotionProcessor motion {};
+
 	/**
 	 * \brief Updates serialized data using the given buffer.
 	 * \param buffer Buffer containing raw input report data.
@@ -67,6 +74,8 @@ public:
 	 * \param axis The axis to retrieve.
 	 * \param polarity The desired polarity of the axis, or \c std::nullopt for both positive and negative.
 	 * \return The magnitude of the axis. If it does not align with the desired \a polarity, \c 0.0f is returned.
+	 * Motion axes are calibrated and scaled by \c Ds4MotionProcessor::angularVelocityRange
+	 * or \c Ds4MotionProcessor::accelerationRange.
 	 */
 	[[nodiscard]] float getAxis(Ds4Axes_t axis, const std::optional<AxisPolarity>& polarity) const;
 
@@ -148,6 +148,7 @@ bool Ds4InputData::touchButton() const
 bool Ds4InputData::operator==(const Ds4InputData& other) const
 {
 	return frameCount      == other.frameCount &&
+	       timestamp       == other.timestamp &&
 	       activeButtons   == other.activeButtons &&
 	       leftStick       == other.leftStick &&
 	       rightStick      == other.rightStick &&
@@ -91,6 +91,12 @@ struct Ds4InputData
 	[[nodiscard]] bool touchButton() const;
 
 	uint8_t    frameCount;
+
+	/**
+	 * \brief Time the report was sampled, in units of 5.33 microseconds. Wraps around.
+	 */
+	uint16_t   timestamp;
+
 	uint8_t    leftTrigger;
 	uint8_t    rightTrigger;
 	uint8_t    battery;
@@ -0,0 +1,222 @@
+#include "pch.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+#include <hid_instance.h>
+
+#include "Ds4Motion.h"
+#include "gmath.h"
+
+namespace
+{
+	int16_t readShort(gsl::span<const uint8_t> report, ptrdiff_t offset)
+	{
+		return static_cast<int16_t>(report[offset] | (report[offset + 1] << 8));
+	}
+
+	/**
+	 * \brief Computes the gyroscope scale of one axis from the raw readings at a known speed in either direction.
+	 * \return Degrees per second per raw unit, or \c 0 if the readings are degenerate.
+	 */
+	float gyroAxisScale(int bias, int plus, int minus, float speed2x)
+	{
+		const int denominator = std::abs(plus - bias) + std::abs(minus - bias);
+		return denominator == 0 ? 0.0f : speed2x / static_cast<float>(denominator);
+	}
+
+	/**
+	 * \brief Computes the accelerometer bias and scale of one axis from the raw readings at +1 g and -1 g.
+	 * \return \c false if the readings are degenerate.
+	 */
+	bool accelAxisScale(int plus, int minus, float& bias, float& scale)
+	{
+		const int range = plus - minus;
+
+		if (range == 0)
+		{
+			return false;
+		}
+
+		bias  = static_cast<float>(plus) - static_cast<float>(range) / 2.0f;
+		scale = 2.0f / static_cast<float>(range);
+		return true;
+	}
+}
+
+// static
+std::optional<Ds4MotionCalibration> Ds4MotionCalibration::parse(gsl::span<const uint8_t> report, ConnectionType connectionType)
+{
+	const bool bluetooth = connectionType == +ConnectionType::bluetooth;
+	const uint8_t reportId = bluetooth ? bluetoothReportId : usbReportId;
+
+	// both layouts end at the same offset; Bluetooth only appends a CRC
+	if (report.size() < static_cast<ptrdiff_t>(usbReportSize) || report[0] != reportId)
+	{
+		return std::nullopt;
+	}
+
+	const int pitchBias = readShort(report, 1);
+	const int yawBias   = readShort(report, 3);
+	const int rollBias  = readShort(report, 5);
+
+	int pitchPlus, pitchMinus;
+	int yawPlus, yawMinus;
+	int rollPlus, rollMinus;
+
+	if (bluetooth)
+	{
+		pitchPlus  = readShort(report, 7);
+		yawPlus    = readShort(report, 9);
+		rollPlus   = readShort(report, 11);
+		pitchMinus = readShort(report, 13);
+		yawMinus   = readShort(report, 15);
+		rollMinus  = readShort(report, 17);
+	}
+	else
+	{
+		pitchPlus  = readShort(report, 7);
+		pitchMinus = readShort(report, 9);
+		yawPlus    = readShort(report, 11);
+		yawMinus   = readShort(report, 13);
+		rollPlus   = readShort(report, 15);
+		rollMinus  = readShort(report, 17);
+	}
+
+	const float speed2x = static_cast<float>(readShort(report, 19)) + static_cast<float>(readShort(report, 21));
+
+	Ds4MotionCalibration result;
+
+	result.gyroBias = Vector3(static_cast<float>(pitchBias), static_cast<float>(yawBias), static_cast<float>(rollBias));
+
+	result.gyroScale = {
+		gyroAxisScale(pitchBias, pitchPlus, pitchMinus, speed2x),
+		gyroAxisScale(yawBias, yawPlus, yawMinus, speed2x),
+		gyroAxisScale(rollBias, rollPlus, rollMinus, speed2x)
+	};
+
+	if (result.gyroScale.x <= 0.0f || result.gyroScale.y <= 0.0f || result.gyroScale.z <= 0.0f)
+	{
+		return std::nullopt;
+	}
+
+	for (ptrdiff_t i = 0; i < 3; ++i)
+	{
+		if (!accelAxisScale(readShort(report, 23 + i * 4), readShort(report, 25 + i * 4),
+		                    result.accelBias.array[i], result.accelScale.array[i]))
+		{
+			return std::nullopt;
+		}
+	}
+
+	return result;
+}
+
+// static
+std::optional<Ds4MotionCalibration> Ds4MotionCalibration::read(const hid::HidInstance& hid, ConnectionType connectionType)
+{
+	const bool bluetooth = connectionType == +ConnectionType::bluetooth;
+
+	std::array<uint8_t, bluetoothReportSize> buffer {};
+	buffer[0] = bluetooth ? bluetoothReportId : usbReportId;
+
+	const gsl::span<uint8_t> report(buffer.data(), bluetooth ? bluetoothReportSize : usbReportSize);
+
+	if (!hid.getFeature(report))
+	{
+		return std::nullopt;
+	}
+
+	return parse(report, connectionType);
+}
+
+Vector3 Ds4MotionCalibration::angularVelocity(const Ds4Vector3& gyro) const
+{
+	return (Vector3(gyro.x, gyro.y, gyro.z) - gyroBias) * gyroScale;
+}
+
+Vector3 Ds4MotionCalibration::angularVelocityBias() const
+{
+	return gyroBias * gyroScale;
+}
+
+Vector3 Ds4MotionCalibration::acceleration(const Ds4Vector3& accel) const
+{
+	return (Vector3(accel.x, accel.y, accel.z) - accelBias) * accelScale;
+}
+
+void Ds4MotionProcessor::setCalibration(const Ds4MotionCalibration& value)
+{
+	calibration = value;
+	reset();
+}
+
+void Ds4MotionProcessor::reset()
+{
+	hasSample        = false;
+	lastTimestamp    = 0;
+	deltaTime_       = 0.0f;
+	gyroBias_        = calibration.angularVelocityBias();
+	angularVelocity_ = Vector3::zero;
+	acceleration_    = Vector3::zero;
+	gravity_         = Vector3(0.0f, -1.0f, 0.0f);
+	still_           = false;
+}
+
+void Ds4MotionProcessor::update(const Ds4InputData& data)
+{
+	// the stored bias is part of gyroBias_ so that it is refined along with any drift
+	const Vector3 sensorVelocity = calibration.angularVelocity(data.gyro) + calibration.angularVelocityBias();
+	acceleration_ = calibration.acceleration(data.accel);
+
+	const float accelLength = acceleration_.length();
+	const float accelError  = std::abs(accelLength - 1.0f);
+
+	if (!hasSample)
+	{
+		hasSample        = true;
+		lastTimestamp    = data.timestamp;
+		deltaTime_       = 0.0f;
+		angularVelocity_ = sensorVelocity - gyroBias_;
+
+		if (accelError < gravityCorrectionLimit)
+		{
+			gravity_ = -acceleration_ / accelLength;
+		}
+
+		return;
+	}
+
+	// the timestamp wraps around roughly every 350 milliseconds
+	const auto ticks = static_cast<uint16_t>(data.timestamp - lastTimestamp);
+	lastTimestamp = data.timestamp;
+
+	deltaTime_ = static_cast<float>(ticks) * timestampPeriod;
+
+	if (deltaTime_ > maxDeltaTime)
+	{
+		deltaTime_ = 0.0f;
+	}
+
+	still_ = accelError < stillAcceleration &&
+	         (sensorVelocity - gyroBias_).lengthSquared() < stillAngularSpeed * stillAngularSpeed;
+
+	if (still_)
+	{
+		gyroBias_ = Vector3::lerp(gyroBias_, sensorVelocity, std::min(1.0f, biasRate * deltaTime_));
+	}
+
+	angularVelocity_ = sensorVelocity - gyroBias_;
+
+	// gravity is fixed in the world, so relative to the controller it rotates opposite to it
+	constexpr float radians = gmath::pi_f / 180.0f;
+	gravity_ -= (angularVelocity_ * radians).cross(gravity_) * deltaTime_;
+
+	if (accelError < gravityCorrectionLimit)
+	{
+		gravity_ = Vector3::lerp(gravity_, -acceleration_ / accelLength, std::min(1.0f, gravityCorrectionRate * deltaTime_));
+	}
+
+	gravity_.normalize();
+}
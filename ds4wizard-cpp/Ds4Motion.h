@@ -0,0 +1,221 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+
+#include <gsl/span>
+
+#include "ConnectionType.h"
+#include "Ds4InputData.h"
+#include "Vector3.h"
+
+namespace hid
+{
+	class HidInstance;
+}
+
+/**
+ * \brief Scale and bias of each motion sensor axis of a DualShock 4,
+ * read from the calibration feature report that is stored on the controller.
+ * \sa Ds4MotionProcessor
+ */
+struct Ds4MotionCalibration
+{
+	static constexpr uint8_t usbReportId         = 0x02;
+	static constexpr size_t  usbReportSize       = 37;
+	static constexpr uint8_t bluetoothReportId   = 0x05;
+	static constexpr size_t  bluetoothReportSize = 41;
+
+	/**
+	 * \brief Raw gyroscope units per degree per second, used when no calibration is available.
+	 */
+	static constexpr float defaultGyroResolution = 16.0f;
+
+	/**
+	 * \brief Raw accelerometer units per g, used when no calibration is available.
+	 */
+	static constexpr float defaultAccelResolution = 8192.0f;
+
+	/**
+	 * \brief Raw gyroscope value while the controller rests.
+	 */
+	Vector3 gyroBias = Vector3::zero;
+
+	/**
+	 * \brief Degrees per second per raw gyroscope unit.
+	 */
+	Vector3 gyroScale = Vector3(1.0f / defaultGyroResolution);
+
+	/**
+	 * \brief Raw accelerometer value at zero g.
+	 */
+	Vector3 accelBias = Vector3::zero;
+
+	/**
+	 * \brief g per raw accelerometer unit.
+	 */
+	Vector3 accelScale = Vector3(1.0f / defaultAccelResolution);
+
+	/**
+	 * \brief Parses a calibration feature report.
+	 * \param report The report, starting with its report ID.
+	 * \param connectionType The connection the report was read over; the gyroscope ranges are ordered differently over Bluetooth.
+	 * \return The calibration, or \c std::nullopt if the report is too short or its ranges are degenerate.
+	 */
+	static std::optional<Ds4MotionCalibration> parse(gsl::span<const uint8_t> report, ConnectionType connectionType);
+
+	/**
+	 * \brief Reads and parses the calibration feature report from an open device.
+	 * \sa parse
+	 */
+	static std::optional<Ds4MotionCalibration> read(const hid::HidInstance& hid, ConnectionType connectionType);
+
+	/**
+	 * \brief Converts a raw gyroscope sample to degrees per second with the stored bias removed.
+	 */
+	[[nodiscard]] Vector3 angularVelocity(const Ds4Vector3& gyro) const;
+
+	/**
+	 * \brief The stored gyroscope bias, in degrees per second.
+	 */
+	[[nodiscard]] Vector3 angularVelocityBias() const;
+
+	/**
+	 * \brief Converts a raw accelerometer sample to g.
+	 */
+	[[nodiscard]] Vector3 acceleration(const Ds4Vector3& accel) const;
+};
+
+/**
+ * \brief Turns the raw motion sensor samples of each input report into calibrated
+ * angular velocity and acceleration, and tracks the direction of gravity.
+ * Each report is processed once in constant time; nothing is allocated.
+ * \sa Ds4MotionCalibration
+ */
+class Ds4MotionProcessor
+{
+public:
+	/**
+	 * \brief Duration of one tick of the report timestamp, in seconds.
+	 */
+	static constexpr float timestampPeriod = 16.0f / 3.0f / 1000000.0f;
+
+	/**
+	 * \brief Longest time between two reports that is still integrated, in seconds.
+	 * Anything longer is treated as a gap in the input stream.
+	 */
+	static constexpr float maxDeltaTime = 0.1f;
+
+	/**
+	 * \brief Angular velocity reported as full magnitude, in degrees per second.
+	 */
+	static constexpr float angularVelocityRange = 2000.0f;
+
+	/**
+	 * \brief Acceleration reported as full magnitude, in g.
+	 */
+	static constexpr float accelerationRange = 4.0f;
+
+	/**
+	 * \brief Fastest the controller may rotate while it is considered still, in degrees per second.
+	 */
+	static constexpr float stillAngularSpeed = 5.0f;
+
+	/**
+	 * \brief Furthest the length of the acceleration may be from \c 1 g while the controller is considered still.
+	 */
+	static constexpr float stillAcceleration = 0.05f;
+
+	/**
+	 * \brief Rate at which the gyroscope bias follows the sensor while the controller is still, per second.
+	 */
+	static constexpr float biasRate = 0.5f;
+
+	/**
+	 * \brief Rate at which the gravity estimate is pulled toward the accelerometer, per second.
+	 */
+	static constexpr float gravityCorrectionRate = 2.0f;
+
+	/**
+	 * \brief Furthest the length of the acceleration may be from \c 1 g for it to correct the gravity estimate.
+	 */
+	static constexpr float gravityCorrectionLimit = 0.25f;
+
+private:
+	Ds4MotionCalibration calibration {};
+
+	bool hasSample = false;
+	uint16_t lastTimestamp = 0;
+
+	float deltaTime_ = 0.0f;
+	Vector3 gyroBias_ = Vector3::zero;
+	Vector3 angularVelocity_ = Vector3::zero;
+	Vector3 acceleration_ = Vector3::zero;
+	Vector3 gravity_ = Vector3(0.0f, -1.0f, 0.0f);
+	bool still_ = false;
+
+public:
+	/**
+	 * \brief Sets the calibration applied to subsequent samples and starts over.
+	 */
+	void setCalibration(const Ds4MotionCalibration& value);
+
+	/**
+	 * \brief Consumes the motion sensor samples of the next report.
+	 * \param data The parsed report, which must be newer than the last one.
+	 */
+	void update(const Ds4InputData& data);
+
+	void reset();
+
+	/**
+	 * \brief Time between the last two reports according to the controller, in seconds.
+	 */
+	[[nodiscard]] float deltaTime() const
+	{
+		return deltaTime_;
+	}
+
+	/**
+	 * \brief Calibrated angular velocity with the estimated gyroscope bias removed, in degrees per second.
+	 * \c x is pitch, \c y is yaw and \c z is roll.
+	 */
+	[[nodiscard]] const Vector3& angularVelocity() const
+	{
+		return angularVelocity_;
+	}
+
+	/**
+	 * \brief Calibrated acceleration, in g.
+	 */
+	[[nodiscard]] const Vector3& acceleration() const
+	{
+		return acceleration_;
+	}
+
+	/**
+	 * \brief Estimated direction of gravity relative to the controller, as a unit vector.
+	 * The accelerometer reads the opposite direction while the controller rests.
+	 */
+	[[nodiscard]] const Vector3& gravity() const
+	{
+		return gravity_;
+	}
+
+	/**
+	 * \brief Gyroscope bias in degrees per second. Starts at the bias stored in the calibration
+	 * and follows the sensor while the controller rests.
+	 */
+	[[nodiscard]] const Vector3& gyroBias() const
+	{
+		return gyroBias_;
+	}
+
+	/**
+	 * \brief Indicates if the controller was resting as of the last report.
+	 */
+	[[nodiscard]] bool still() const
+	{
+		return still_;
+	}
+};
@@ -0,0 +1,72 @@
+#include "pch.h"
+
+#include <algorithm>
+
+#include "Ds4TouchGrid.h"
+#include "Ds4TouchRegion.h"
+
+void Ds4TouchGrid::build(const std::vector<Ds4TouchRegion*>& regions)
+{
+	clear();
+
+	std::array<uint32_t, columns * rows> counts {};
+
+	const auto forEachCell = [](const Ds4TouchRegion& region, auto&& fn)
+	{
+		if (region.right < region.left || region.bottom < region.top)
+		{
+			return;
+		}
+
+		for (int y = row(region.top); y <= row(region.bottom); ++y)
+		{
+			for (int x = column(region.left); x <= column(region.right); ++x)
+			{
+				fn(static_cast<size_t>(y * columns + x));
+			}
+		}
+	};
+
+	for (const Ds4TouchRegion* region : regions)
+	{
+		forEachCell(*region, [&](size_t cell) { ++counts[cell]; });
+	}
+
+	for (size_t i = 0; i < counts.size(); ++i)
+	{
+		cellBegin[i + 1] = cellBegin[i] + counts[i];
+	}
+
+	candidates.resize(cellBegin.back());
+
+	// regions are visited in priority order, so each cell's list comes out in priority order too
+	std::array<uint32_t, columns * rows> next {};
+	std::copy(cellBegin.begin(), cellBegin.end() - 1, next.begin());
+
+	for (size_t i = 0; i < regions.size(); ++i)
+	{
+		forEachCell(*regions[i], [&](size_t cell) { candidates[next[cell]++] = static_cast<uint32_t>(i); });
+	}
+}
+
+void Ds4TouchGrid::clear()
+{
+	cellBegin.fill(0);
+	candidates.clear();
+}
+
+gsl::span<const uint32_t> Ds4TouchGrid::candidatesAt(const Ds4Vector2& point) const
+{
+	const size_t cell = static_cast<size_t>(row(point.y) * columns + column(point.x));
+	return gsl::span<const uint32_t>(candidates.data() + cellBegin[cell], cellBegin[cell + 1] - cellBegin[cell]);
+}
+
+int Ds4TouchGrid::column(int x)
+{
+	return std::clamp(x / cellSize, 0, columns - 1);
+}
+
+int Ds4TouchGrid::row(int y)
+{
+	return std::clamp(y / cellSize, 0, rows - 1);
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include <gsl/span>
+
+#include "Ds4InputData.h"
+
+class Ds4TouchRegion;
+
+/**
+ * \brief A coarse grid over the touch pad mapping each cell to the touch regions that overlap it.
+ * Built when a profile is applied, so that finding the regions under a touch point
+ * takes the same time no matter how many regions the profile defines.
+ */
+class Ds4TouchGrid
+{
+public:
+	/**
+	 * \brief Size of the touch pad's coordinate space. \sa Ds4Vector2
+	 */
+	static constexpr int width  = 1920;
+	static constexpr int height = 943;
+
+	static constexpr int cellSize = 64;
+	static constexpr int columns  = (width + cellSize - 1) / cellSize;
+	static constexpr int rows     = (height + cellSize - 1) / cellSize;
+
+private:
+	/**
+	 * \brief Range of \c candidates for each cell, row by row; cell \c i uses <tt>[cellBegin[i], cellBegin[i + 1])</tt>.
+	 */
+	std::array<uint32_t, columns * rows + 1> cellBegin {};
+	std::vector<uint32_t> candidates;
+
+public:
+	/**
+	 * \brief Builds the grid.
+	 * \param regions The regions to index, in priority order.
+	 */
+	void build(const std::vector<Ds4TouchRegion*>& regions);
+
+	void clear();
+
+	/**
+	 * \brief Gets the regions whose bounds overlap the cell containing \p point.
+	 * Points off the touch pad use the nearest cell. Candidates still need their bounds checked.
+	 * \return Indices into the regions the grid was built from, in priority order.
+	 */
+	[[nodiscard]] gsl::span<const uint32_t> candidatesAt(const Ds4Vector2& point) const;
+
+private:
+	static int column(int x);
+	static int row(int y);
+};
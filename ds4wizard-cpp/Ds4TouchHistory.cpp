@@ -0,0 +1,67 @@
+#include "pch.h"
+
+#include <algorithm>
+
+#include "Ds4TouchHistory.h"
+
+void Ds4TouchHistoryRing::push(const Ds4InputData& data, Ds4TouchHistory::TimePoint time)
+{
+	Ds4TouchSample& sample = samples[pushed % capacity];
+
+	sample.timestamp  = time;
+	sample.point1     = data.touchPoint1;
+	sample.point2     = data.touchPoint2;
+	sample.touches    = 0;
+	sample.touchFrame = data.touchFrame;
+
+	if (data.touch1)
+	{
+		sample.touches |= Ds4Buttons::touch1;
+	}
+
+	if (data.touch2)
+	{
+		sample.touches |= Ds4Buttons::touch2;
+	}
+
+	++pushed;
+}
+
+void Ds4TouchHistoryRing::clear()
+{
+	pushed = 0;
+}
+
+Ds4TouchHistoryView::Ds4TouchHistoryView(const Ds4TouchHistoryRing* ring, Ds4Buttons_t touchId, uint64_t begin)
+	: ring(ring),
+	  touchId(touchId),
+	  begin(begin)
+{
+}
+
+Ds4TouchHistory Ds4TouchHistoryView::newest() const
+{
+	return (*this)[count - 1];
+}
+
+Ds4TouchHistory Ds4TouchHistoryView::oldest() const
+{
+	return (*this)[0];
+}
+
+Ds4TouchHistory Ds4TouchHistoryView::operator[](ptrdiff_t index) const
+{
+	if (ring == nullptr || ring->empty())
+	{
+		return {};
+	}
+
+	const uint64_t newest = ring->newestSequence();
+	const uint64_t first  = std::min(std::max(begin, ring->oldestSequence()), newest);
+	const uint64_t age    = static_cast<uint64_t>(count - 1 - index);
+
+	const uint64_t sequence = newest - first < age ? first : newest - age;
+	const Ds4TouchSample& sample = ring->at(sequence);
+
+	return Ds4TouchHistory(touchId & Ds4Buttons::touch1 ? sample.point1 : sample.point2, sample.timestamp);
+}
@@ -0,0 +1,143 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+
+#include "enums.h"
+#include "Ds4InputData.h"
+
+/**
+ * \brief A single touch point at the time it was reported.
+ */
+struct Ds4TouchHistory
+{
+	using Clock     = std::chrono::high_resolution_clock;
+	using TimePoint = Clock::time_point;
+	using Duration  = Clock::duration;
+
+	TimePoint timestamp {};
+	Ds4Vector2 point {};
+
+	Ds4TouchHistory(const Ds4Vector2& point, TimePoint timestamp)
+		: timestamp(timestamp),
+		  point(point)
+	{
+	}
+
+	Ds4TouchHistory() = default;
+};
+
+/**
+ * \brief Both touch points of one input report, stamped with the time the report arrived.
+ */
+struct Ds4TouchSample
+{
+	Ds4TouchHistory::TimePoint timestamp {};
+	Ds4Vector2 point1 {};
+	Ds4Vector2 point2 {};
+
+	/**
+	 * \brief The touch points that were down (touch 1, touch 2).
+	 */
+	Ds4Buttons_t touches = 0;
+
+	uint8_t touchFrame = 0;
+};
+
+/**
+ * \brief The most recent touch samples of a device, shared by all of its touch regions.
+ * \sa Ds4TouchHistoryView
+ */
+class Ds4TouchHistoryRing
+{
+public:
+	static constexpr ptrdiff_t capacity = 32;
+
+private:
+	std::array<Ds4TouchSample, capacity> samples {};
+
+	/**
+	 * \brief Number of samples ever pushed, which is also the sequence number of the next sample.
+	 */
+	uint64_t pushed = 0;
+
+public:
+	/**
+	 * \brief Records the touch points of an input report.
+	 * \param data The report's data.
+	 * \param time The time the report arrived.
+	 */
+	void push(const Ds4InputData& data, Ds4TouchHistory::TimePoint time);
+
+	void clear();
+
+	[[nodiscard]] bool empty() const
+	{
+		return pushed == 0;
+	}
+
+	/**
+	 * \brief Sequence number of the newest sample. Only meaningful if the ring isn't \c empty.
+	 */
+	[[nodiscard]] uint64_t newestSequence() const
+	{
+		return pushed - 1;
+	}
+
+	/**
+	 * \brief Sequence number of the oldest sample still held.
+	 */
+	[[nodiscard]] uint64_t oldestSequence() const
+	{
+		return pushed > capacity ? pushed - capacity : 0;
+	}
+
+	/**
+	 * \brief Gets a sample by sequence number, which must be within <tt>[oldestSequence(), newestSequence()]</tt>.
+	 */
+	[[nodiscard]] const Ds4TouchSample& at(uint64_t sequence) const
+	{
+		return samples[sequence % capacity];
+	}
+
+	/**
+	 * \brief Gets the newest sample. The ring must not be \c empty.
+	 */
+	[[nodiscard]] const Ds4TouchSample& newest() const
+	{
+		return at(newestSequence());
+	}
+};
+
+/**
+ * \brief Read-only view of one touch point's history in a \c Ds4TouchHistoryRing,
+ * starting from the sample it became active in. Samples older than that read as the first one.
+ */
+class Ds4TouchHistoryView
+{
+	const Ds4TouchHistoryRing* ring;
+	Ds4Buttons_t touchId;
+	uint64_t begin;
+
+public:
+	/**
+	 * \brief Number of samples in the view, from \c oldest to \c newest.
+	 */
+	static constexpr ptrdiff_t count = Ds4TouchHistoryRing::capacity;
+
+	/**
+	 * \param ring The ring to view, or \c nullptr for an empty history.
+	 * \param touchId The touch point to view (touch 1, touch 2).
+	 * \param begin Sequence number of the first sample in the view.
+	 */
+	Ds4TouchHistoryView(const Ds4TouchHistoryRing* ring, Ds4Buttons_t touchId, uint64_t begin);
+
+	[[nodiscard]] Ds4TouchHistory newest() const;
+	[[nodiscard]] Ds4TouchHistory oldest() const;
+
+	/**
+	 * \brief Gets a sample by age; \c 0 is the oldest and <tt>count - 1</tt> the newest.
+	 */
+	Ds4TouchHistory operator[](ptrdiff_t index) const;
+};
@@ -30,6 +30,11 @@ ISimulator* Ds4TouchRegion::getSimulator(InputSimulator* parent)
 	return result;
 }
 
+void Ds4TouchRegion::setHistory(const Ds4TouchHistoryRing* history)
+{
+	this->history = history;
+}
+
 std::optional<PressedState> Ds4TouchRegion::getSimulatorState() const
 {
 	std::optional<PressedState> result;
@@ -102,18 +107,8 @@ Ds4TouchRegion& Ds4TouchRegion::operator=(const Ds4TouchRegion& other)
 	return *this;
 }
 
-bool Ds4TouchRegion::isInRegion(Ds4Buttons_t sender, const Ds4Vector2& point)
+bool Ds4TouchRegion::isInRegion(Ds4Buttons_t sender, const Ds4Vector2& point) const
 {
-	if (sender & Ds4Buttons::touch1)
-	{
-		points1.insert(Ds4TouchHistory(point));
-	}
-
-	if (sender & Ds4Buttons::touch2)
-	{
-		points2.insert(Ds4TouchHistory(point));
-	}
-	
 	if (point.x >= left && point.x <= right && point.y >= top && point.y <= bottom)
 	{
 		return true;
@@ -202,31 +197,32 @@ void Ds4TouchRegion::activateTouch(Ds4Buttons_t sender, const Ds4Vector2& point)
 
 	activeButtons |= sender & (Ds4Buttons::touch1 | Ds4Buttons::touch2);
 
+	// the history starts at the sample of the activating report, which the owner has already pushed
+	const uint64_t begin = history != nullptr && !history->empty() ? history->newestSequence() : 0;
+
 	if ((sender & Ds4Buttons::touch1) != 0)
 	{
-		pointStart1 = point;
-		points1.fill(Ds4TouchHistory(point));
+		pointStart1   = point;
+		historyBegin1 = begin;
 	}
 	else if ((sender & Ds4Buttons::touch2) != 0)
 	{
-		pointStart2 = point;
-		points2.fill(Ds4TouchHistory(point));
+		pointStart2   = point;
+		historyBegin2 = begin;
 	}
 }
 
-void Ds4TouchRegion::deactivateTouch(Ds4Buttons_t sender, Ds4Vector2 point)
+void Ds4TouchRegion::deactivateTouch(Ds4Buttons_t sender)
 {
 	activeButtons &= ~(sender & (Ds4Buttons::touch1 | Ds4Buttons::touch2));
 
 	if ((sender & Ds4Buttons::touch1) != 0)
 	{
-		points1.insert(Ds4TouchHistory(point));
 		state1.release();
 	}
 
 	if ((sender & Ds4Buttons::touch2) != 0)
 	{
-		points2.insert(Ds4TouchHistory(point));
 		state2.release();
 	}
 }
@@ -235,13 +231,9 @@ float Ds4TouchRegion::getSimulatedAxis(Ds4Buttons_t sender, Direction_t directio
 {
 	Ds4Vector2 point {};
 
-	if (sender & Ds4Buttons::touch1)
-	{
-		point = points1.newest().point;
-	}
-	else if (sender & Ds4Buttons::touch2)
+	if (sender & (Ds4Buttons::touch1 | Ds4Buttons::touch2))
 	{
-		point = points2.newest().point;
+		point = getPoints(sender).newest().point;
 	}
 
 	auto getVectorLength = [this, sender]() -> float
@@ -302,8 +294,9 @@ float Ds4TouchRegion::getSimulatedAxis(Ds4Buttons_t sender, Direction_t directio
 
 		case +Ds4TouchRegionType::trackball:
 		{
-			const Vector2 normalized = trackball->velocity.normalized();
-			const float length = trackball->velocity.length();
+			const Vector2 velocity = trackball->interpolatedVelocity();
+			const Vector2 normalized = velocity.normalized();
+			const float length = velocity.length();
 			const float factor = trackball->settings.ballSpeed;
 
 			switch (direction)
@@ -393,16 +386,16 @@ float Ds4TouchRegion::getSimulatedAxisWithOptionsApplied(Ds4Buttons_t sender, Di
 	return options.applyToValueWithMagnitude(value, magnitude);
 }
 
-const decltype(Ds4TouchRegion::points1)& Ds4TouchRegion::getPoints(Ds4Buttons_t sender) const
+Ds4TouchHistoryView Ds4TouchRegion::getPoints(Ds4Buttons_t sender) const
 {
 	if (sender & Ds4Buttons::touch1)
 	{
-		return points1;
+		return Ds4TouchHistoryView(history, Ds4Buttons::touch1, historyBegin1);
 	}
 
 	if (sender & Ds4Buttons::touch2)
 	{
-		return points2;
+		return Ds4TouchHistoryView(history, Ds4Buttons::touch2, historyBegin2);
 	}
 
 	throw;
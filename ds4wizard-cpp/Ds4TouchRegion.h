@@ -10,7 +10,8 @@
 #include "Pressable.h"
 #include "AxisOptions.h"
 #include "JsonData.h"
-#include "circular_buffer.h"
+#include "Ds4TouchHistory.h"
+#include "Stopwatch.h"
 #include "Trackball.h"
 
 // TODO: TrackPad - basically always auto-centering stick
@@ -19,7 +20,7 @@
 
 /*
  * How do we detect a touch pad flick?
- * - points[newest] - points[oldest], where points = circular buffer of last N touch points
+ * - points[newest] - points[oldest], where points = Ds4TouchHistoryView of the last N touch points
  */
 
 BETTER_ENUM(Ds4TouchRegionType, int,
@@ -48,24 +49,6 @@ using Ds4TouchRegionCollection = std::map<std::string, Ds4TouchRegion>;
  */
 using Ds4TouchRegionCache = std::map<std::string, Ds4TouchRegion*>;
 
-struct Ds4TouchHistory
-{
-	using Clock     = std::chrono::high_resolution_clock;
-	using TimePoint = Clock::time_point;
-	using Duration  = Clock::duration;
-
-	TimePoint timestamp {};
-	Ds4Vector2 point {};
-
-	explicit Ds4TouchHistory(const Ds4Vector2& point)
-		: timestamp(Clock::now()),
-		  point(point)
-	{
-	}
-
-	Ds4TouchHistory() = default;
-};
-
 class InputSimulator;
 class ISimulator;
 
@@ -86,7 +69,16 @@ class Ds4TouchRegion : public JsonData
 	 */
 	Ds4Buttons_t activeButtons = 0;
 
-	circular_buffer<Ds4TouchHistory, 30> points1 {}, points2 {};
+	/**
+	 * \brief The owning device's touch history. \sa setHistory
+	 */
+	const Ds4TouchHistoryRing* history = nullptr;
+
+	/**
+	 * \brief Sequence number in \c history of the sample each touch point was activated in.
+	 */
+	uint64_t historyBegin1 = 0;
+	uint64_t historyBegin2 = 0;
 
 	std::shared_ptr<TrackballSimulator> trackball;
 	std::shared_ptr<TrackballSettings> trackballSettings;
@@ -106,6 +98,13 @@ public:
 
 	ISimulator* getSimulator(InputSimulator* parent);
 
+	/**
+	 * \brief Sets the touch history this region reads touch points from.
+	 * The latest sample must be pushed to it before the region is updated each tick.
+	 * \param history The owning device's touch history.
+	 */
+	void setHistory(const Ds4TouchHistoryRing* history);
+
 	[[nodiscard]] std::optional<PressedState> getSimulatorState() const;
 
 	/**
@@ -180,7 +179,7 @@ public:
 	 * \param point The point to check.
 	 * \return \c true if \a point is within the bounds of this touch region.
 	 */
-	bool isInRegion(Ds4Buttons_t sender, const Ds4Vector2& point);
+	[[nodiscard]] bool isInRegion(Ds4Buttons_t sender, const Ds4Vector2& point) const;
 
 	/**
 	 * \brief Get the starting coordinates that activated this touch region.
@@ -208,9 +207,8 @@ public:
 	/**
 	 * \brief De-activate the specified multi-touch senders in this region.
 	 * \param sender The multi-touch sender (touch 1, touch 2).
-	 * \param point The last point reported by the device.
 	 */
-	void deactivateTouch(Ds4Buttons_t sender, Ds4Vector2 point);
+	void deactivateTouch(Ds4Buttons_t sender);
 
 	// TODO: fix documentation for getSimulatedAxis/etc, as it is not always a touch delta that is returned.
 
@@ -230,8 +228,12 @@ public:
 	 */
 	[[nodiscard]] float getSimulatedAxisWithOptionsApplied(Ds4Buttons_t sender, Direction_t direction) const;
 
-	// UNDONE: nice documentation, nerd!
-	[[nodiscard]] const decltype(points1)& getPoints(Ds4Buttons_t sender) const;
+	/**
+	 * \brief Get the recent history of a touch point, starting from when it was activated in this region.
+	 * \param sender The multi-touch sender (touch 1, touch 2).
+	 * \return A view of the touch point's history.
+	 */
+	[[nodiscard]] Ds4TouchHistoryView getPoints(Ds4Buttons_t sender) const;
 
 	bool operator==(const Ds4TouchRegion& other) const;
 	bool operator!=(const Ds4TouchRegion& other) const;
@@ -0,0 +1,265 @@
+#include "pch.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+#include "Ds4Trace.h"
+
+using namespace std::chrono;
+
+Ds4TraceWriter::Ds4TraceWriter()
+	: buffer(bufferSize)
+{
+}
+
+Ds4TraceWriter::~Ds4TraceWriter()
+{
+	close();
+}
+
+bool Ds4TraceWriter::open(const std::string& path)
+{
+	close();
+
+	file.setFileName(QString::fromStdString(path));
+
+	if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+	{
+		return false;
+	}
+
+	Ds4TraceFileHeader header;
+	header.startTime = duration_cast<microseconds>(system_clock::now().time_since_epoch()).count();
+
+	startTime = steady_clock::now();
+	written   = 0;
+	allocated = 0;
+
+	pendingDropped = 0;
+	droppedCount_  = 0;
+
+	if (!file.resize(allocationSize) ||
+	    file.write(reinterpret_cast<const char*>(&header), sizeof(header)) != sizeof(header))
+	{
+		file.close();
+		return false;
+	}
+
+	allocated = allocationSize;
+	written   = sizeof(header);
+
+	running = true;
+	writeThread = std::thread(&Ds4TraceWriter::writerThread, this);
+
+	return true;
+}
+
+void Ds4TraceWriter::close()
+{
+	if (!writeThread.joinable())
+	{
+		return;
+	}
+
+	running = false;
+	writeThread.join();
+
+	file.resize(written);
+	file.close();
+}
+
+bool Ds4TraceWriter::isOpen() const
+{
+	return writeThread.joinable();
+}
+
+void Ds4TraceWriter::record(Ds4TraceRecordType type, ConnectionType connection, gsl::span<const uint8_t> data)
+{
+	if (!running)
+	{
+		return;
+	}
+
+	Ds4TraceRecordHeader header {};
+	header.timestamp  = static_cast<uint64_t>(duration_cast<nanoseconds>(steady_clock::now() - startTime).count());
+	header.connection = static_cast<uint8_t>(connection._to_integral());
+
+	if (pendingDropped)
+	{
+		header.type = static_cast<uint8_t>(Ds4TraceRecordType::dropped);
+		header.size = sizeof(pendingDropped);
+
+		const auto count = gsl::span(reinterpret_cast<const uint8_t*>(&pendingDropped), sizeof(pendingDropped));
+
+		if (!push(header, count))
+		{
+			++pendingDropped;
+			++droppedCount_;
+			return;
+		}
+
+		pendingDropped = 0;
+	}
+
+	// Bluetooth reports are mostly padding, so trailing zeros aren't worth storing.
+	const auto end = std::find_if(data.rbegin(), data.rend(), [](uint8_t b) { return b != 0; });
+	const size_t size = std::min<size_t>(std::distance(end, data.rend()), std::numeric_limits<uint16_t>::max());
+
+	header.type = static_cast<uint8_t>(type);
+	header.size = static_cast<uint16_t>(size);
+
+	if (!push(header, data.first(size)))
+	{
+		++pendingDropped;
+		++droppedCount_;
+	}
+}
+
+uint64_t Ds4TraceWriter::droppedCount() const
+{
+	return droppedCount_;
+}
+
+bool Ds4TraceWriter::push(const Ds4TraceRecordHeader& header, gsl::span<const uint8_t> data)
+{
+	return buffer.push(gsl::span(reinterpret_cast<const uint8_t*>(&header), sizeof(header)), data);
+}
+
+void Ds4TraceWriter::writerThread()
+{
+	while (running)
+	{
+		flush();
+		std::this_thread::sleep_for(flushInterval);
+	}
+
+	flush();
+}
+
+void Ds4TraceWriter::flush()
+{
+	bool wrote = false;
+
+	for (auto data = buffer.front(); !data.empty(); data = buffer.front())
+	{
+		const auto size = static_cast<qint64>(data.size());
+
+		if (written + size > allocated)
+		{
+			const qint64 required = written + size;
+			const qint64 next = ((required + allocationSize - 1) / allocationSize) * allocationSize;
+
+			if (file.resize(next))
+			{
+				allocated = next;
+			}
+		}
+
+		const qint64 result = file.write(reinterpret_cast<const char*>(data.data()), size);
+
+		if (result > 0)
+		{
+			written += result;
+			buffer.pop(static_cast<size_t>(result));
+			wrote = true;
+		}
+
+		// On a short write or failure the rest stays queued and is retried on the next flush,
+		// so no record is cut short. The device thread still never waits on the disk;
+		// while the buffer is full its reports are counted as dropped.
+		if (result < size)
+		{
+			break;
+		}
+	}
+
+	if (wrote)
+	{
+		// keep what has been captured so far if the program goes down
+		file.flush();
+	}
+}
+
+bool Ds4TraceReader::open(const std::string& path)
+{
+	contents.clear();
+	records_.clear();
+	header_ = {};
+
+	QFile file(QString::fromStdString(path));
+
+	if (!file.open(QIODevice::ReadOnly))
+	{
+		return false;
+	}
+
+	const QByteArray data = file.readAll();
+	contents.assign(data.begin(), data.end());
+
+	if (contents.size() < sizeof(Ds4TraceFileHeader))
+	{
+		return false;
+	}
+
+	std::memcpy(&header_, contents.data(), sizeof(header_));
+
+	if (header_.magic != Ds4TraceFileHeader::expectedMagic ||
+	    header_.version != Ds4TraceFileHeader::currentVersion ||
+	    header_.headerSize < sizeof(Ds4TraceFileHeader) ||
+	    header_.headerSize > contents.size())
+	{
+		return false;
+	}
+
+	size_t offset = header_.headerSize;
+
+	while (contents.size() - offset >= sizeof(Ds4TraceRecordHeader))
+	{
+		Ds4TraceRecordHeader recordHeader {};
+		std::memcpy(&recordHeader, &contents[offset], sizeof(recordHeader));
+		offset += sizeof(recordHeader);
+
+		// Preallocated space that was never written (the file wasn't closed properly) is all zeros.
+		if (!recordHeader.timestamp && !recordHeader.size && !recordHeader.type && !recordHeader.connection)
+		{
+			break;
+		}
+
+		if (contents.size() - offset < recordHeader.size)
+		{
+			break;
+		}
+
+		if (!ConnectionType::_is_valid(recordHeader.connection))
+		{
+			return false;
+		}
+
+		records_.push_back({
+			nanoseconds(recordHeader.timestamp),
+			static_cast<Ds4TraceRecordType>(recordHeader.type),
+			ConnectionType::_from_integral(recordHeader.connection),
+			gsl::span<const uint8_t>(&contents[offset], recordHeader.size)
+		});
+
+		offset += recordHeader.size;
+	}
+
+	return true;
+}
+
+const Ds4TraceFileHeader& Ds4TraceReader::header() const
+{
+	return header_;
+}
+
+const std::vector<Ds4TraceRecord>& Ds4TraceReader::records() const
+{
+	return records_;
+}
+
+nanoseconds Ds4TraceReader::duration() const
+{
+	return records_.empty() ? nanoseconds::zero() : records_.back().timestamp;
+}
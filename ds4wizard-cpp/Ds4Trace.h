@@ -0,0 +1,193 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <QFile>
+#include <gsl/span>
+
+#include "ConnectionType.h"
+#include "spsc_buffer.h"
+
+/**
+ * \brief Kind of report stored in a trace record.
+ */
+enum class Ds4TraceRecordType : uint8_t
+{
+	/** \brief A raw input report, including its report ID. */
+	input,
+	/** \brief A raw output report, including its report ID. */
+	output,
+	/** \brief Records were lost because the capture buffer was full. The payload is a \c uint32_t count. */
+	dropped
+};
+
+#pragma pack(push, 1)
+
+/**
+ * \brief Start of every trace file. All values are little endian.
+ */
+struct Ds4TraceFileHeader
+{
+	static constexpr std::array<char, 4> expectedMagic = { 'D', 'S', '4', 'T' };
+	static constexpr uint16_t currentVersion = 1;
+
+	std::array<char, 4> magic = expectedMagic;
+	uint16_t version = currentVersion;
+	uint16_t headerSize = sizeof(Ds4TraceFileHeader);
+
+	/**
+	 * \brief Wall-clock time the capture started, in microseconds since the Unix epoch.
+	 * Only used to match a trace with the time a problem was reported.
+	 */
+	int64_t startTime = 0;
+};
+
+/**
+ * \brief Precedes the payload of every record in a trace file.
+ */
+struct Ds4TraceRecordHeader
+{
+	/**
+	 * \brief Monotonic time since the capture started, in nanoseconds.
+	 */
+	uint64_t timestamp;
+
+	/**
+	 * \brief Number of payload bytes that follow.
+	 * Trailing zeros are not stored; pad the payload to the report size when reading it back.
+	 */
+	uint16_t size;
+
+	/** \sa Ds4TraceRecordType */
+	uint8_t type;
+
+	/** \sa ConnectionType */
+	uint8_t connection;
+};
+
+#pragma pack(pop)
+
+/**
+ * \brief A record read back from a trace file.
+ */
+struct Ds4TraceRecord
+{
+	std::chrono::nanoseconds timestamp;
+	Ds4TraceRecordType type;
+	ConnectionType connection;
+
+	/**
+	 * \brief The stored payload. Points into the \c Ds4TraceReader it came from.
+	 */
+	gsl::span<const uint8_t> data;
+};
+
+/**
+ * \brief Appends reports to a trace file without blocking the device thread.
+ * Records are queued in a lock-free buffer and written to a preallocated file by a background thread.
+ */
+class Ds4TraceWriter
+{
+public:
+	/**
+	 * \brief Size of the buffer between the device thread and the writer thread.
+	 * About ten seconds of 1000 Hz Bluetooth input.
+	 */
+	static constexpr size_t bufferSize = 1u << 20u;
+
+	/**
+	 * \brief The file is grown in steps of this size to avoid fragmenting it one report at a time.
+	 */
+	static constexpr qint64 allocationSize = 16 << 20;
+
+	/**
+	 * \brief Interval at which the writer thread moves queued records to the file.
+	 */
+	static constexpr std::chrono::milliseconds flushInterval = std::chrono::milliseconds(10);
+
+private:
+	spsc_buffer buffer;
+	QFile file;
+	std::thread writeThread;
+	std::atomic<bool> running = false;
+
+	std::chrono::steady_clock::time_point startTime;
+
+	// owned by the producer
+	uint32_t pendingDropped = 0;
+	std::atomic<uint64_t> droppedCount_ = 0;
+
+	// owned by the writer thread
+	qint64 written = 0;
+	qint64 allocated = 0;
+
+public:
+	Ds4TraceWriter();
+	~Ds4TraceWriter();
+
+	Ds4TraceWriter(const Ds4TraceWriter&) = delete;
+	Ds4TraceWriter& operator=(const Ds4TraceWriter&) = delete;
+
+	/**
+	 * \brief Creates (or truncates) the trace file at \p path and starts the writer thread.
+	 * \return \c true on success.
+	 */
+	bool open(const std::string& path);
+
+	/**
+	 * \brief Writes out everything still queued, trims the file to its used size and closes it.
+	 */
+	void close();
+
+	bool isOpen() const;
+
+	/**
+	 * \brief Queues a report. Never blocks; if the buffer is full, the report is counted as dropped instead.
+	 * Must only be called from one thread at a time.
+	 */
+	void record(Ds4TraceRecordType type, ConnectionType connection, gsl::span<const uint8_t> data);
+
+	/**
+	 * \brief Total number of records that didn't fit in the buffer.
+	 */
+	uint64_t droppedCount() const;
+
+private:
+	bool push(const Ds4TraceRecordHeader& header, gsl::span<const uint8_t> data);
+	void writerThread();
+	void flush();
+};
+
+/**
+ * \brief Loads a whole trace file into memory so it can be replayed without touching the disk.
+ * \sa Ds4TraceWriter, Ds4TraceReplay
+ */
+class Ds4TraceReader
+{
+	std::vector<uint8_t> contents;
+	Ds4TraceFileHeader header_ {};
+	std::vector<Ds4TraceRecord> records_;
+
+public:
+	/**
+	 * \brief Reads and validates the trace file at \p path.
+	 * Reading stops at a record cut short or at unused preallocated space,
+	 * so traces of a program that was terminated can still be read.
+	 * \return \c true if the file is a trace of a supported version.
+	 */
+	bool open(const std::string& path);
+
+	[[nodiscard]] const Ds4TraceFileHeader& header() const;
+	[[nodiscard]] const std::vector<Ds4TraceRecord>& records() const;
+
+	/**
+	 * \brief Time stamp of the last record, or zero if the trace is empty.
+	 */
+	[[nodiscard]] std::chrono::nanoseconds duration() const;
+};
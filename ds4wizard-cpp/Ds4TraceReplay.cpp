@@ -0,0 +1,128 @@
+#include "pch.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <thread>
+
+#include "Ds4Device.h"
+#include "Ds4TraceReplay.h"
+#include "Stopwatch.h"
+
+using namespace std::chrono;
+
+double Ds4TraceReplay::Result::reportsPerSecond() const
+{
+	const double seconds = duration<double>(elapsed).count();
+	return seconds > 0.0 ? static_cast<double>(reports) / seconds : 0.0;
+}
+
+Ds4TraceReplay::Ds4TraceReplay(DeviceProfile profile, IOutputSink* sink)
+	: profile(std::move(profile)),
+	  sink(sink)
+{
+}
+
+Ds4TraceReplay::Result Ds4TraceReplay::run(const Ds4TraceReader& trace, Speed speed)
+{
+	// Everything below runs on virtual time starting at zero, which is also where the trace starts.
+	VirtualClock clock;
+
+	auto device = std::make_unique<Ds4Device>();
+	device->profile = profile;
+
+	device->simulator.setOutputSink(sink);
+	device->simulator.applyProfile(&device->profile);
+	device->beginRun();
+
+	Result result {};
+	result.traceDuration = trace.duration();
+
+	std::array<uint8_t, maxInputReportSize> buffer {};
+
+	auto nextTick = Stopwatch::TimePoint {} + Ds4Device::tickInterval;
+	const auto wallStart = steady_clock::now();
+
+	for (const Ds4TraceRecord& record : trace.records())
+	{
+		if (record.type == Ds4TraceRecordType::dropped)
+		{
+			uint32_t count = 0;
+			std::memcpy(&count, record.data.data(), std::min(record.data.size(), sizeof(count)));
+			result.dropped += count;
+			continue;
+		}
+
+		// output reports are regenerated by the device, not replayed
+		if (record.type != Ds4TraceRecordType::input)
+		{
+			continue;
+		}
+
+		const auto time = Stopwatch::TimePoint {} + duration_cast<Stopwatch::Duration>(record.timestamp);
+
+		// The device loop keeps ticking while simulators need it, and otherwise
+		// only wakes between reports when one of its timers expires.
+		while (true)
+		{
+			std::optional<Stopwatch::TimePoint> wake = device->simulator.nextDeadline();
+
+			if (device->simulator.needsTick())
+			{
+				wake = wake.has_value() ? std::min(*wake, nextTick) : nextTick;
+			}
+
+			if (!wake.has_value())
+			{
+				break;
+			}
+
+			// timers have a resolution of one microsecond, as does the wait of the device loop
+			const Stopwatch::TimePoint wakeTime = std::max<Stopwatch::TimePoint>(ceil<microseconds>(*wake), clock.now());
+
+			if (wakeTime >= time)
+			{
+				break;
+			}
+
+			clock.set(wakeTime);
+
+			device->input.updateChangedState();
+			device->simulator.runPersistent();
+
+			++result.ticks;
+			nextTick = clock.now() + Ds4Device::tickInterval;
+		}
+
+		if (speed == Speed::realTime)
+		{
+			std::this_thread::sleep_until(wallStart + record.timestamp);
+		}
+
+		clock.set(time);
+
+		const bool bluetooth = record.connection == +ConnectionType::bluetooth;
+
+		// see Ds4Device::run
+		if (bluetooth && (record.data.empty() || record.data[0] != 0x11))
+		{
+			continue;
+		}
+
+		const size_t reportSize = bluetooth ? maxInputReportSize : Ds4Device::usbInputReportSize;
+		const size_t offset     = bluetooth ? 3 : 1;
+		const size_t size       = std::min(record.data.size(), reportSize);
+
+		// trailing zeros aren't stored in the trace
+		std::copy_n(record.data.begin(), size, buffer.begin());
+		std::fill(buffer.begin() + size, buffer.begin() + reportSize, 0);
+
+		device->processReport(gsl::span<uint8_t>(&buffer[offset], reportSize - offset), bluetooth);
+
+		++result.reports;
+		nextTick = time + Ds4Device::tickInterval;
+	}
+
+	result.elapsed = steady_clock::now() - wallStart;
+	return result;
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <chrono>
+#include <memory>
+
+#include "DeviceProfile.h"
+#include "Ds4Trace.h"
+#include "IOutputSink.h"
+
+/**
+ * \brief Feeds a recorded trace through \c Ds4Input and \c InputSimulator of a headless \c Ds4Device.
+ * Time-dependent behaviour follows the trace's time stamps through a \c VirtualClock, so a replay
+ * produces the same output whether it runs in real time or as fast as possible.
+ * \sa Ds4TraceReader, RecordingOutputSink
+ */
+class Ds4TraceReplay
+{
+public:
+	enum class Speed
+	{
+		/** \brief Reports are processed at the pace they were recorded at. */
+		realTime,
+		/** \brief Reports are processed back to back. */
+		unlimited
+	};
+
+	struct Result
+	{
+		/**
+		 * \brief Number of input reports that were processed.
+		 */
+		size_t reports = 0;
+
+		/**
+		 * \brief Number of idle ticks run between reports for persistent maps and simulators.
+		 */
+		size_t ticks = 0;
+
+		/**
+		 * \brief Number of reports the capture reported as dropped.
+		 */
+		size_t dropped = 0;
+
+		/**
+		 * \brief Time covered by the trace.
+		 */
+		std::chrono::nanoseconds traceDuration {};
+
+		/**
+		 * \brief Wall-clock time the replay took.
+		 */
+		std::chrono::nanoseconds elapsed {};
+
+		[[nodiscard]] double reportsPerSecond() const;
+	};
+
+	/**
+	 * \brief Largest input report handled, which is the Bluetooth report including padding.
+	 */
+	static constexpr size_t maxInputReportSize = 547;
+
+	/**
+	 * \param profile The profile to map input with.
+	 * \param sink Receives all simulated output. Must outlive the replay.
+	 */
+	Ds4TraceReplay(DeviceProfile profile, IOutputSink* sink);
+
+	/**
+	 * \brief Replays \p trace from the start on a freshly set up device, so every run produces the same output.
+	 * Must not be called from a thread that already has a \c VirtualClock.
+	 */
+	Result run(const Ds4TraceReader& trace, Speed speed);
+
+private:
+	DeviceProfile profile;
+	IOutputSink* sink;
+};
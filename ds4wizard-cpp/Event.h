@@ -42,35 +42,40 @@ public:
 
 	/**
 	 * \brief Unregisters a listener from the event.
+	 * The listener is only forgotten here; it is pruned on the next \c invoke,
+	 * so this is safe to call from within a listener.
 	 * \param token The \c EventToken to unregister from the event.
 	 */
 	void remove(EventToken token)
 	{
-		callbacks.erase(std::remove_if(callbacks.begin(), callbacks.end(), [token](auto ptr) -> bool
+		for (auto& weak : callbacks)
 		{
-			return ptr.lock() == token;
-		}));
+			if (weak.lock() == token)
+			{
+				weak.reset();
+			}
+		}
 	}
 
 	/**
 	 * \brief Raises the event and notifies all listeners.
+	 * Listeners added while the event is being raised are notified as well.
 	 * \param sender The object invoking the event, or \c nullptr.
 	 * \param args The arguments to pass to the listeners.
 	 */
 	void invoke(sender_t* sender, args_t... args)
 	{
-		auto predicate = [](weak_callback t) -> bool
+		auto predicate = [](const weak_callback& t) -> bool
 		{
 			return t.expired();
 		};
 
 		callbacks.erase(std::remove_if(callbacks.begin(), callbacks.end(), predicate), callbacks.end());
 
-		auto callbacks_ = callbacks;
-
-		for (auto weak : callbacks_)
+		// indexed rather than iterated: listeners may add to the deque, and removal never shrinks it here
+		for (size_t i = 0; i < callbacks.size(); ++i)
 		{
-			if (auto shared = weak.lock())
+			if (auto shared = callbacks[i].lock())
 			{
 				(*shared)(sender, args...);
 			}
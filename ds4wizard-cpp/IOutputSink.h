@@ -0,0 +1,49 @@
+#pragma once
+
+#include "enums.h"
+#include "XInputGamepad.h"
+
+/**
+ * \brief Receives the simulated output of an \c InputSimulator.
+ * Output is collected in an \c OutputBuffer and delivered once per tick,
+ * already stripped of presses and releases that don't change anything.
+ * \sa InputSimulator::setOutputSink
+ */
+class IOutputSink
+{
+public:
+	virtual ~IOutputSink() = default;
+
+	/**
+	 * \brief A keyboard key was pressed or released.
+	 * \param keyCode Virtual key code of the key.
+	 * \param down \c true if pressed, \c false if released.
+	 */
+	virtual void keyboardKey(int keyCode, bool down) = 0;
+
+	/**
+	 * \brief A mouse button was pressed or released.
+	 * \param button The button.
+	 * \param down \c true if pressed, \c false if released.
+	 */
+	virtual void mouseButton(MouseButton button, bool down) = 0;
+
+	/**
+	 * \brief The mouse was moved relative to its current position.
+	 * \param dx X delta in pixels.
+	 * \param dy Y delta in pixels.
+	 */
+	virtual void mouseMove(int dx, int dy) = 0;
+
+	/**
+	 * \brief The state of the virtual XInput controller changed.
+	 * \param state The new state.
+	 */
+	virtual void xinputState(const XInputGamepad& state) = 0;
+
+	/**
+	 * \brief Called once every event of a tick has been delivered.
+	 * Sinks that batch their output submit it here.
+	 */
+	virtual void flush() {}
+};
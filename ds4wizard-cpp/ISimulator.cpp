@@ -16,6 +16,16 @@ void ISimulator::activate(float deltaTime)
 	}
 }
 
+bool ISimulator::needsTick() const
+{
+	return state == SimulatorState::active;
+}
+
+bool ISimulator::fixedStep() const
+{
+	return false;
+}
+
 void ISimulator::deactivate(float deltaTime)
 {
 	if (state == SimulatorState::active)
@@ -1,5 +1,8 @@
 #pragma once
 
+#include <cstdint>
+#include <limits>
+
 class InputSimulator;
 
 enum class SimulatorState
@@ -10,7 +13,11 @@ enum class SimulatorState
 
 class ISimulator
 {
+	friend class InputSimulator;
+
 public:
+	static constexpr uint32_t unregistered = std::numeric_limits<uint32_t>::max();
+
 	SimulatorState state;
 	InputSimulator* parent;
 
@@ -21,7 +28,31 @@ public:
 	virtual void update(float deltaTime) = 0;
 	void deactivate(float deltaTime);
 
+	/**
+	 * \brief Indicates that this simulator must be updated regularly,
+	 * even when no new input has been received.
+	 */
+	[[nodiscard]] virtual bool needsTick() const;
+
+	/**
+	 * \brief Indicates that \c update must be called once per fixed step of simulated time
+	 * rather than once per tick, so that results don't depend on the report rate.
+	 * \sa interpolate
+	 */
+	[[nodiscard]] virtual bool fixedStep() const;
+
+	/**
+	 * \brief Called once per tick after the fixed steps of a \c fixedStep simulator have run.
+	 * \param alpha How far the current time is between the last fixed step and the next one, in [0, 1).
+	 */
+	virtual void interpolate(float alpha) {}
+
 private:
+	/**
+	 * \brief Position of this simulator in \c InputSimulator::simulators, or \c unregistered.
+	 */
+	uint32_t registrySlot = unregistered;
+
 	virtual void onActivate(float deltaTime) {}
 	virtual void onDeactivate(float deltaTime) {}
 };
@@ -2,11 +2,6 @@
 #include "InputMap.h"
 #include <utility>
 
-bool InputMapBase::performRapidFire() const
-{
-	return rapidStopwatch.elapsed() >= rapidFireInterval;
-}
-
 PressedState InputMapBase::simulatedState() const
 {
 	if (rapidFire == true)
@@ -42,6 +37,26 @@ bool InputMapBase::isPersistent() const
 	return rapidFire == true;
 }
 
+bool InputMapBase::isLatched() const
+{
+	if (toggle == true && isToggled)
+	{
+		return true;
+	}
+
+	return isPersistent() && (isActive() || pressedState != PressedState::off || rapidState != PressedState::off);
+}
+
+std::chrono::microseconds InputMapBase::getRapidFireInterval() const
+{
+	return std::max(rapidFireInterval.value_or(minRapidFireInterval), minRapidFireInterval);
+}
+
+void InputMapBase::advanceRapidFire()
+{
+	rapidFiring = !rapidFiring && isActive();
+}
+
 InputMapBase::InputMapBase(const InputMapBase& other)
 	: Pressable(other),
 	  inputType(other.inputType),
@@ -49,6 +64,7 @@ InputMapBase::InputMapBase(const InputMapBase& other)
 	  inputAxes(other.inputAxes),
 	  inputTouchRegion(other.inputTouchRegion),
 	  inputTouchDirection(other.inputTouchDirection),
+	  inputTouchGesture(other.inputTouchGesture),
 	  toggle(other.toggle),
 	  rapidFire(other.rapidFire),
 	  rapidFireInterval(other.rapidFireInterval),
@@ -63,6 +79,7 @@ InputMapBase::InputMapBase(InputMapBase&& other) noexcept
 	  inputAxes(other.inputAxes),
 	  inputTouchRegion(std::move(other.inputTouchRegion)),
 	  inputTouchDirection(other.inputTouchDirection),
+	  inputTouchGesture(other.inputTouchGesture),
 	  toggle(other.toggle),
 	  rapidFire(other.rapidFire),
 	  rapidFireInterval(other.rapidFireInterval),
@@ -100,6 +117,7 @@ InputMapBase& InputMapBase::operator=(InputMapBase&& other) noexcept
 	inputAxes           = other.inputAxes;
 	inputTouchRegion    = std::move(other.inputTouchRegion);
 	inputTouchDirection = other.inputTouchDirection;
+	inputTouchGesture   = other.inputTouchGesture;
 	toggle              = other.toggle;
 	rapidFire           = other.rapidFire;
 	rapidFireInterval   = other.rapidFireInterval;
@@ -127,50 +145,19 @@ void InputMapBase::press()
 
 void InputMapBase::updateRapidState()
 {
-	if (isActive())
+	// the cycle itself is advanced by the owner's timer; see advanceRapidFire
+	if (!isActive())
 	{
-		if (!rapidStopwatch.running())
-		{
-			rapidStopwatch.start();
-		}
-	}
-	else
-	{
-		if (rapidStopwatch.running())
-		{
-			rapidStopwatch.stop();
-			//rapidStopwatch.reset();
-			rapidStopwatch.start();
-		}
-
 		rapidFiring = false;
 	}
 
 	if (rapidFiring)
 	{
-		if (performRapidFire())
-		{
-			rapidFiring = false;
-			Pressable::release(rapidState);
-			rapidStopwatch.start();
-		}
-		else
-		{
-			Pressable::press(rapidState);
-		}
+		Pressable::press(rapidState);
 	}
 	else
 	{
-		if (performRapidFire())
-		{
-			rapidFiring = true;
-			Pressable::press(rapidState);
-			rapidStopwatch.start();
-		}
-		else
-		{
-			Pressable::release(rapidState);
-		}
+		Pressable::release(rapidState);
 	}
 }
 
@@ -184,13 +171,15 @@ void InputMapBase::release()
 	}
 }
 
-InputAxisOptions InputMapBase::getAxisOptions(Ds4Axes_t axis) const
+const InputAxisOptions& InputMapBase::getAxisOptions(Ds4Axes_t axis) const
 {
+	static const InputAxisOptions defaultOptions;
+
 	const auto it = inputAxisOptions.find(axis);
 
 	if (it == inputAxisOptions.end())
 	{
-		return InputAxisOptions();
+		return defaultOptions;
 	}
 
 	return it->second;
@@ -203,6 +192,7 @@ bool InputMapBase::operator==(const InputMapBase& other) const
 	       && inputAxes == other.inputAxes
 	       && inputTouchRegion == other.inputTouchRegion
 	       && inputTouchDirection == other.inputTouchDirection
+	       && inputTouchGesture == other.inputTouchGesture
 	       && toggle == other.toggle
 	       && rapidFire == other.rapidFire
 	       && rapidFireInterval == other.rapidFireInterval
@@ -249,6 +239,13 @@ void InputMapBase::readJson(const nlohmann::json& json)
 		inputTouchDirection = touchDirection_;
 	}
 
+	if (json.find("inputTouchGesture") != json.end())
+	{
+		TouchGesture_t touchGesture_;
+		ENUM_DESERIALIZE_FLAGS(TouchGesture)(json["inputTouchGesture"].get<std::string>(), touchGesture_);
+		inputTouchGesture = touchGesture_;
+	}
+
 	if (json.find("toggle") != json.end())
 	{
 		toggle = json["toggle"];
@@ -301,6 +298,11 @@ void InputMapBase::writeJson(nlohmann::json& json) const
 		json["inputTouchDirection"] = ENUM_SERIALIZE_FLAGS(Direction)(inputTouchDirection.value()).c_str();
 	}
 
+	if (inputTouchGesture.has_value())
+	{
+		json["inputTouchGesture"] = ENUM_SERIALIZE_FLAGS(TouchGesture)(inputTouchGesture.value()).c_str();
+	}
+
 	if (toggle.has_value())
 	{
 		json["toggle"] = toggle.value();
@@ -406,6 +408,7 @@ InputMap::InputMap(InputMap&& other) noexcept
 	  simulatorType(other.simulatorType),
 	  outputType(other.outputType),
 	  action(other.action),
+	  macro(std::move(other.macro)),
 	  keyCode(other.keyCode),
 	  keyCodeModifiers(std::move(other.keyCodeModifiers)),
 	  mouseAxes(other.mouseAxes),
@@ -427,6 +430,7 @@ InputMap& InputMap::operator=(InputMap&& other) noexcept
 	simulatorType    = other.simulatorType;
 	outputType       = other.outputType;
 	action           = other.action;
+	macro            = std::move(other.macro);
 	keyCode          = other.keyCode;
 	keyCodeModifiers = std::move(other.keyCodeModifiers);
 	mouseAxes        = other.mouseAxes;
@@ -456,6 +460,7 @@ bool InputMap::operator==(const InputMap& other) const
 	       && simulatorType == other.simulatorType
 	       && outputType == other.outputType
 	       && action == other.action
+	       && macro == other.macro
 	       && keyCode == other.keyCode
 	       && keyCodeModifiers == other.keyCodeModifiers
 	       && xinputButtons == other.xinputButtons
@@ -492,6 +497,11 @@ void InputMap::readJson(const nlohmann::json& json)
 		action = ActionType::_from_string(json.value("action", "none").c_str());
 	}
 
+	if (json.find("macro") != json.end())
+	{
+		macro = json["macro"].get<std::string>();
+	}
+
 	if (json.find("keyCode") != json.end())
 	{
 		keyCode = json["keyCode"].get<VirtualKeyCode>();
@@ -536,6 +546,11 @@ void InputMap::writeJson(nlohmann::json& json) const
 		json["action"] = action.value()._to_string();
 	}
 
+	if (!macro.empty())
+	{
+		json["macro"] = macro.c_str();
+	}
+
 	if (keyCode.has_value())
 	{
 		json["keyCode"] = keyCode.value();
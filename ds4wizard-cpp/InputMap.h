@@ -1,23 +1,26 @@
 #pragma once
 
+#include <chrono>
 #include <string>
 #include <optional>
 #include <deque>
 
 #include "Pressable.h"
-#include "Stopwatch.h"
 #include "AxisOptions.h"
 
 class InputMapBase : public Pressable, public JsonData
 {
 public:
 	bool isToggled = false;
-	bool performRapidFire() const;
+
+	/**
+	 * \brief Shortest time between rapid fire presses and releases.
+	 */
+	static constexpr std::chrono::microseconds minRapidFireInterval { 1000 };
 
 private:
 	bool rapidFiring = false;
 	PressedState rapidState = PressedState::off;
-	Stopwatch rapidStopwatch;
 
 public:
 	~InputMapBase() override = default;
@@ -39,12 +42,31 @@ public:
 	 */
 	[[nodiscard]] bool isPersistent() const;
 
+	/**
+	 * \brief Indicates if this instance is toggled on or rapid firing, or is still
+	 * settling after either, and so must be run on ticks without new input.
+	 */
+	[[nodiscard]] bool isLatched() const;
+
+	/**
+	 * \brief Gets the time between rapid fire presses and releases.
+	 */
+	[[nodiscard]] std::chrono::microseconds getRapidFireInterval() const;
+
+	/**
+	 * \brief Switches between the pressed and released half of the rapid fire cycle
+	 * while the map is active. Called each time \c getRapidFireInterval elapses;
+	 * the new state takes effect the next time the map is pressed or released.
+	 */
+	void advanceRapidFire();
+
 	InputType_t inputType = 0;
 
 	std::optional<Ds4Buttons_t> inputButtons;
 	std::optional<Ds4Axes_t> inputAxes;
 	std::string inputTouchRegion;
 	std::optional<Direction_t> inputTouchDirection;
+	std::optional<TouchGesture_t> inputTouchGesture;
 
 	std::optional<bool> toggle;
 	std::optional<bool> rapidFire;
@@ -72,7 +94,10 @@ protected:
 
 public:
 	void release() override;
-	InputAxisOptions getAxisOptions(Ds4Axes_t axis) const;
+	/**
+	 * \brief Gets the options configured for \p axis, or default options if there are none.
+	 */
+	[[nodiscard]] const InputAxisOptions& getAxisOptions(Ds4Axes_t axis) const;
 
 	bool operator==(const InputMapBase& other) const;
 	bool operator!=(const InputMapBase& other) const;
@@ -85,7 +110,7 @@ class InputModifier;
 
 using VirtualKeyCode = int;
 
-class InputMap : public InputMapBase
+class InputMap final : public InputMapBase
 {
 public:
 	SimulatorType simulatorType = SimulatorType::none;
@@ -93,6 +118,11 @@ public:
 
 	std::optional<ActionType> action;
 
+	/**
+	 * \brief Name of the entry of \c DeviceProfile::macros played by \c ActionType::macro.
+	 */
+	std::string macro;
+
 	#pragma region Keyboard
 
 	std::optional<VirtualKeyCode> keyCode;
@@ -142,7 +172,7 @@ public:
 /**
  * \brief A modifier set that controls a collection of input bindings.
  */
-class InputModifier : public InputMapBase
+class InputModifier final : public InputMapBase
 {
 public:
 	/**
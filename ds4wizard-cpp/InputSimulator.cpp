@@ -1,7 +1,6 @@
 #include "pch.h"
 
 #include <chrono>
-#include <unordered_set>
 
 #include "Ds4Device.h"
 #include "InputSimulator.h"
@@ -18,12 +17,16 @@ InputSimulator::InputSimulator(Ds4Device* parent)
 
 InputSimulator::~InputSimulator()
 {
+	removeRapidFireTimers();
+	removeMacroTimers();
 	xinputDisconnect();
 }
 
 void InputSimulator::start()
 {
-	deltaStopwatch.start();
+	tickTime = Stopwatch::now();
+	lastTickTime = tickTime;
+	stepRemainder = {};
 }
 
 void InputSimulator::simulateXInputButton(XInputButtons_t buttons, PressedState state)
@@ -51,22 +54,20 @@ void InputSimulator::simulateXInputButton(XInputButtons_t buttons, PressedState
 	xinputPad.wButtons = dest;
 }
 
-void InputSimulator::simulateXInputAxis(const XInputAxes& axes, float m)
+void InputSimulator::simulateXInputAxis(XInputAxis_t axes, XInputAxis_t negative, float m)
 {
 	for (XInputAxis_t bit : XInputAxis_values)
 	{
-		if (!(axes.axes & bit))
+		if (!(axes & bit))
 		{
 			continue;
 		}
 
-		AxisOptions options = axes.getAxisOptions(static_cast<XInputAxis::T>(bit));
-
 		const auto trigger = static_cast<uint8_t>(255.0f * m);
 
 		const auto axis = static_cast<short>(std::numeric_limits<short>::max() * m);
 
-		const short workAxis = options.polarity == +AxisPolarity::negative
+		const short workAxis = negative & bit
 		                       ? static_cast<short>(-axis)
 		                       : axis;
 
@@ -129,106 +130,6 @@ void InputSimulator::simulateXInputAxis(const XInputAxes& axes, float m)
 	}
 }
 
-bool InputSimulator::isOverriddenByModifierSet(const InputMapBase& map)
-{
-	if (modifierMaps.empty())
-	{
-		return false;
-	}
-
-	auto checkButtonMap = [&](InputMap const* m) -> bool
-	{
-		return m->isActive() &&
-		       m != &map &&
-		       !!(m->inputButtons.value_or(0) & map.inputButtons.value());
-	};
-
-	auto checkAxisMap = [&](InputMap const* m) -> bool
-	{
-		return m->isActive() &&
-		       m != &map &&
-		       !!(m->inputAxes.value_or(0) & map.inputAxes.value());
-	};
-
-	auto checkTouchMap = [&](InputMap const* m) -> bool
-	{
-		return m->isActive() && m != &map;
-	};
-
-	for (auto& pair : modifierMaps)
-	{
-		auto& cache = pair.second;
-		cache.reset();
-
-		if (map.inputType & InputType::button && map.inputButtons.value_or(0) != 0)
-		{
-			const auto buttons = map.inputButtons.value_or(0);
-
-			for (const Ds4Buttons_t bit : Ds4Buttons_values)
-			{
-				if (!(bit & buttons))
-				{
-					continue;
-				}
-
-				auto* collection = cache.getButtonMaps(bit);
-
-				if (collection == nullptr)
-				{
-					continue;
-				}
-
-				if (std::any_of(collection->cbegin(), collection->cend(), checkButtonMap))
-				{
-					return true;
-				}
-			}
-		}
-
-		if (map.inputType & InputType::axis && map.inputAxes.value_or(0) != 0)
-		{
-			const auto axes = map.inputAxes.value();
-
-			for (const Ds4Axes_t bit : Ds4Axes_values)
-			{
-				if (!(bit & axes))
-				{
-					continue;
-				}
-
-				auto* collection = cache.getAxisMaps(bit);
-
-				if (collection == nullptr)
-				{
-					continue;
-				}
-
-				if (std::any_of(collection->cbegin(), collection->cend(), checkAxisMap))
-				{
-					return true;
-				}
-			}
-		}
-
-		if (map.inputType & InputType::touchRegion && !map.inputTouchRegion.empty())
-		{
-			auto* collection = cache.getTouchMaps(map.inputTouchRegion);
-
-			if (collection == nullptr)
-			{
-				continue;
-			}
-
-			if (std::any_of(collection->cbegin(), collection->cend(), checkTouchMap))
-			{
-				return true;
-			}
-		}
-	}
-
-	return false;
-}
-
 float InputSimulator::getAxisWithOptionsApplied(Ds4Axes_t axes, const InputAxisOptions& options) const
 {
 	const Ds4Axes_t expanded = Ds4Axes::expand(axes);
@@ -262,111 +163,94 @@ float InputSimulator::getAxisWithOptionsApplied(Ds4Axes_t axes, const InputAxisO
 	return options.applyToValue(parent->input.getAxis(axes, options.polarity));
 }
 
-void InputSimulator::runMap(const InputMap& m, InputModifier const* modifier)
+void InputSimulator::runBinding(uint32_t index, InputModifier const* modifier)
 {
-	if (m.inputType == 0)
+	const InputMap& m = *program.bindings.maps[index];
+	const InputType_t types = program.bindings.inputTypes[index];
+
+	// Each input type of the map is applied in turn with its own analog value. They all share
+	// one pressed state, which BindingProgram::evaluate takes from the last input type.
+	if (types & InputType::button)
 	{
-		throw std::out_of_range("inputType must be non-zero.");
+		const PressedState state = m.simulatedState();
+		applyMap(index, modifier, state, m.isActive() && ((modifier && modifier->isActive()) || m.isToggled) ? 1.0f : 0.0f);
 	}
 
-	// UNDONE: this will not properly simulate activation for multiple input types; this is an OR, we probably want AND
-	for (InputType_t value : InputType_values)
+	if (types & InputType::axis)
 	{
-		if ((m.inputType & value) == 0)
-		{
-			continue;
-		}
+		const Ds4Axes_t axes = program.bindings.axes[index];
 
-		switch (value)
+		for (uint32_t i = program.bindings.axisTermBegin[index]; i < program.bindings.axisTermEnd[index]; ++i)
 		{
-			case InputType::button:
-			{
-				const PressedState state = m.simulatedState();
-				applyMap(m, modifier, state, m.isActive() && ((modifier && modifier->isActive()) || m.isToggled) ? 1.0f : 0.0f);
-				break;
-			}
-
-			case InputType::axis:
-			{
-				if (m.inputAxes.value_or(0) == 0)
-				{
-					throw std::invalid_argument("inputAxes has no value");
-				}
-
-				for (Ds4Axes_t bit : Ds4Axes_values)
-				{
-					if (!(m.inputAxes.value() & bit))
-					{
-						continue;
-					}
-
-					InputAxisOptions options = m.getAxisOptions(bit);
-
-					const float analog = getAxisWithOptionsApplied(m.inputAxes.value(), options);
-					const PressedState state = m.simulatedState();
-					applyMap(m, modifier, state, analog);
-				}
+			const AxisResponseTable& response = program.axisTables[i];
 
-				break;
-			}
+			const float analog = response.compiled()
+			                     ? response.apply(parent->input.data)
+			                     : getAxisWithOptionsApplied(axes, program.axisTerms[i].options);
 
-			case InputType::touchRegion:
-			{
-				Ds4TouchRegion* region = touchRegions[m.inputTouchRegion];
+			const PressedState state = m.simulatedState();
+			applyMap(index, modifier, state, analog);
+		}
+	}
 
-				if (region->type == +Ds4TouchRegionType::button)
-				{
-					const PressedState state1 = getTouchRegionPressedState(m, modifier, region->state1);
-					applyMap(m, modifier, state1, Pressable::isActiveState(state1) ? 1.0f : 0.0f);
+	if (types & InputType::touchGesture)
+	{
+		const float analog = m.isActive() ? gestures.magnitude(program.bindings.touchGestures[index]) : 0.0f;
+		applyMap(index, modifier, m.simulatedState(), analog);
+	}
 
-					const PressedState state2 = getTouchRegionPressedState(m, modifier, region->state2);
-					applyMap(m, modifier, state2, Pressable::isActiveState(state2) ? 1.0f : 0.0f);
-				}
-				else if (region->type == +Ds4TouchRegionType::trackball)
-				{
-					const Direction_t direction = m.inputTouchDirection.value();
+	if (!(types & InputType::touchRegion))
+	{
+		return;
+	}
 
-					const float analog = region->getSimulatedAxisWithOptionsApplied(Ds4Buttons::touch1, direction);
-					applyMap(m, modifier, m.simulatedState(), analog);
-				}
-				else if (region->type == +Ds4TouchRegionType::stick || region->type == +Ds4TouchRegionType::stickAutoCenter)
-				{
-					// TODO: re-do this; Pressable::release should not be called
-					const Direction_t direction = m.inputTouchDirection.value();
+	Ds4TouchRegion* region = program.bindings.touchRegions[index];
 
-					PressedState state = getTouchRegionPressedState(m, modifier, region->state1);
-					float analog = region->getSimulatedAxisWithOptionsApplied(Ds4Buttons::touch1, direction);
+	if (region->type == +Ds4TouchRegionType::button)
+	{
+		const PressedState state1 = getTouchRegionPressedState(m, modifier, region->state1);
+		applyMap(index, modifier, state1, Pressable::isActiveState(state1) ? 1.0f : 0.0f);
 
-					// FIXME: Pressable::release should not be called! This should be managed automatically!
-					if (gmath::is_zero(analog))
-					{
-						Pressable::release(state);
-					}
+		const PressedState state2 = getTouchRegionPressedState(m, modifier, region->state2);
+		applyMap(index, modifier, state2, Pressable::isActiveState(state2) ? 1.0f : 0.0f);
+	}
+	else if (region->type == +Ds4TouchRegionType::trackball)
+	{
+		const Direction_t direction = m.inputTouchDirection.value();
 
-					applyMap(m, modifier, state, analog);
+		const float analog = region->getSimulatedAxisWithOptionsApplied(Ds4Buttons::touch1, direction);
+		applyMap(index, modifier, m.simulatedState(), analog);
+	}
+	else if (region->type == +Ds4TouchRegionType::stick || region->type == +Ds4TouchRegionType::stickAutoCenter)
+	{
+		// TODO: re-do this; Pressable::release should not be called
+		const Direction_t direction = m.inputTouchDirection.value();
 
-					state = getTouchRegionPressedState(m, modifier, region->state2);
-					analog = region->getSimulatedAxisWithOptionsApplied(Ds4Buttons::touch2, direction);
+		PressedState state = getTouchRegionPressedState(m, modifier, region->state1);
+		float analog = region->getSimulatedAxisWithOptionsApplied(Ds4Buttons::touch1, direction);
 
-					// FIXME: Pressable::release should not be called! This should be managed automatically!
-					if (gmath::is_zero(analog))
-					{
-						Pressable::release(state);
-					}
+		// FIXME: Pressable::release should not be called! This should be managed automatically!
+		if (gmath::is_zero(analog))
+		{
+			Pressable::release(state);
+		}
 
-					applyMap(m, modifier, state, analog);
-				}
-				else
-				{
-					throw std::out_of_range("unhandled Ds4TouchRegionType");
-				}
+		applyMap(index, modifier, state, analog);
 
-				return;
-			}
+		state = getTouchRegionPressedState(m, modifier, region->state2);
+		analog = region->getSimulatedAxisWithOptionsApplied(Ds4Buttons::touch2, direction);
 
-			default:
-				throw std::out_of_range("invalid InputType");
+		// FIXME: Pressable::release should not be called! This should be managed automatically!
+		if (gmath::is_zero(analog))
+		{
+			Pressable::release(state);
 		}
+
+		applyMap(index, modifier, state, analog);
+	}
+	else
+	{
+		throw std::out_of_range("unhandled Ds4TouchRegionType");
 	}
 }
 
@@ -374,36 +258,92 @@ void InputSimulator::applyProfile(DeviceProfile* profile)
 {
 	for (ISimulator* simulator : simulators)
 	{
-		simulator->deactivate(1.0f);
+		if (simulator != nullptr)
+		{
+			simulator->deactivate(1.0f);
+			simulator->registrySlot = ISimulator::unregistered;
+		}
 	}
 
 	simulators.clear();
+	removedSimulators = 0;
 
 	touchRegions.clear();
-	sortableTouchRegions.clear();
+	touchRegionList.clear();
 
 	for (auto& pair : profile->touchRegions)
 	{
 		touchRegions[pair.first] = &pair.second;
-		sortableTouchRegions.emplace_back(&pair.second);
+		touchRegionList.emplace_back(&pair.second);
+		pair.second.setHistory(&touchHistory);
 		addSimulator(pair.second.getSimulator(this));
 	}
 
-	bindings.clear();
-	modifiers.clear();
-	modifierMaps.clear();
+	touchGrid.build(touchRegionList);
+
+	liveTouchRegions.clear();
+	liveTouchRegions.reserve(touchRegionList.size());
+	touchRegionVisits.clear();
+	touchRegionVisits.reserve(touchRegionList.size());
+	touchRegionStamps.assign(touchRegionList.size(), 0);
+	touchRegionGeneration = 0;
+
+	for (uint32_t i = 0; i < touchRegionList.size(); ++i)
+	{
+		if (isLive(*touchRegionList[i]))
+		{
+			liveTouchRegions.push_back(i);
+		}
+	}
+
+	removeRapidFireTimers();
+	removeMacroTimers();
+	program.compile(*profile, touchRegions);
+	addRapidFireTimers();
+	addMacroTimers();
+
+	activeChildren.assign(program.childWordCount(), 0);
+
+	for (uint32_t i = 0; i < program.topLevelBegin; ++i)
+	{
+		if (program.bindings.maps[i]->isActive())
+		{
+			activeChildren[i / 64] |= 1ull << (i % 64);
+		}
+	}
+
+	modifierGenerations.assign(program.modifiers.size(), 0);
+	bindingGenerations.assign(program.bindings.size(), 0);
 
-	bindings.cache(profile->bindings, touchRegions);
-	modifiers.cache(profile->modifiers, touchRegions);
+	// maps keep their toggle and rapid fire state across profile changes
+	latchedModifiers.clear();
+	latchedModifiers.reserve(program.modifiers.size());
+	latchedBindings.clear();
+	latchedBindings.reserve(program.bindings.size());
+	persistentModifiers.reserve(program.modifiers.size());
+	persistentBindings.reserve(program.bindings.size());
+
+	modifierLatchSlots.assign(program.modifiers.size(), notLatched);
+	bindingLatchSlots.assign(program.bindings.size(), notLatched);
+
+	for (uint32_t i = 0; i < program.modifiers.size(); ++i)
+	{
+		updateLatch(latchedModifiers, modifierLatchSlots, i, program.modifiers.maps[i]->isLatched());
+	}
 
-	for (auto& modifier : profile->modifiers)
+	for (uint32_t i = 0; i < program.bindings.size(); ++i)
 	{
-		MapCacheCollection<InputMap> mapCache;
-		mapCache.cache(modifier.bindings, touchRegions);
-		modifierMaps[&modifier] = std::move(mapCache);
+		updateLatch(latchedBindings, bindingLatchSlots, i, program.bindings.maps[i]->isLatched());
 	}
 
-	if (profile->useXInput)
+	dirtyTopLevel.clear();
+	dirtyTopLevel.reserve(program.bindings.size());
+	pendingTopLevel.clear();
+	pendingTopLevel.reserve(program.bindings.size());
+
+	evaluateAllNextTick = true;
+
+	if (profile->useXInput && outputSink == nullptr)
 	{
 		if (!xinputConnect())
 		{
@@ -412,6 +352,7 @@ void InputSimulator::applyProfile(DeviceProfile* profile)
 		else
 		{
 			addSimulator(xinputRumbleSimulator.get());
+			outputBuffer.resendXInput();
 		}
 	}
 	else
@@ -472,56 +413,52 @@ PressedState InputSimulator::getTouchRegionPressedState(const InputMap& m, Input
 	return state;
 }
 
-void InputSimulator::applyMap(const InputMap& m, InputModifier const* modifier, PressedState state, float analog)
+void InputSimulator::applyMap(uint32_t index, InputModifier const* modifier, PressedState state, float analog)
 {
-	switch (m.simulatorType)
+	const InputMap& m = *program.bindings.maps[index];
+
+	switch (program.ops[index])
 	{
-		case SimulatorType::input:
-			switch (m.outputType)
+		case BindingOp::xinput:
+			if (m.xinputButtons.has_value())
 			{
-				case OutputType::xinput:
-					if (m.xinputButtons.has_value())
-					{
-						simulateXInputButton(m.xinputButtons.value(), state);
-					}
-
-					if (m.xinputAxes.has_value())
-					{
-						simulateXInputAxis(m.xinputAxes.value(), analog);
-					}
-
-					break;
+				simulateXInputButton(m.xinputButtons.value(), state);
+			}
 
-				case OutputType::keyboard:
-					simulateKeyboard(m, state);
-					break;
+			if (m.xinputAxes.has_value())
+			{
+				simulateXInputAxis(m.xinputAxes.value().axes, program.xinputNegativeAxes[index], analog);
+			}
 
-					// TODO: AxisOptions thing for mouse
-				case OutputType::mouse:
-					simulateMouse(m, state, analog);
-					break;
+			break;
 
-				default:
-					throw std::out_of_range("invalid OutputType");
-			}
+		case BindingOp::keyboard:
+			simulateKeyboard(m, state);
+			break;
 
+			// TODO: AxisOptions thing for mouse
+		case BindingOp::mouse:
+			simulateMouse(m, state, analog);
 			break;
 
-		case SimulatorType::action:
-			if (!m.action.has_value() || m.action.value() == +ActionType::none)
+		case BindingOp::action:
+			if (m.isActive() && (modifier && modifier->isActive()))
 			{
-				throw std::invalid_argument("action has invalid or no value");
+				runAction(m.action.value());
 			}
 
-			if (m.isActive() && (modifier && modifier->isActive()))
+			break;
+
+		case BindingOp::macro:
+			if (state == PressedState::pressed && (!modifier || modifier->isActive()))
 			{
-				runAction(m.action.value());
+				startMacro(index);
 			}
 
 			break;
 
 		default:
-			throw std::out_of_range("invalid SimulatorType");
+			throw std::out_of_range("invalid BindingOp");
 	}
 }
 
@@ -532,11 +469,11 @@ void InputSimulator::simulateMouse(const InputMap& m, PressedState state, float
 		switch (state)
 		{
 			case PressedState::pressed:
-				mouse.buttonDown(m.mouseButton.value());
+				outputBuffer.mouseButton(m.mouseButton.value(), true);
 				break;
 
 			case PressedState::released:
-				mouse.buttonUp(m.mouseButton.value());
+				outputBuffer.mouseButton(m.mouseButton.value(), false);
 				break;
 
 			default:
@@ -554,45 +491,29 @@ void InputSimulator::simulateMouse(const InputMap& m, PressedState state, float
 	// TODO: /!\ getAxisOptions for mouse
 	const Direction_t direction = m.mouseAxes.value().directions;
 
-	int x = 0;
-	int y = 0;
-
 	if ((direction & (Direction::left | Direction::right)) != (Direction::left | Direction::right))
 	{
 		if (direction & Direction::right)
 		{
-			x = static_cast<int>(analog);
+			mouseMotion.x += analog;
 		}
 		else if (direction & Direction::left)
 		{
-			x = static_cast<int>(-analog);
+			mouseMotion.x -= analog;
 		}
 	}
-	else
-	{
-		x = 0;
-	}
 
 	if ((direction & (Direction::up | Direction::down)) != (Direction::up | Direction::down))
 	{
 		if (direction & Direction::up)
 		{
-			y = static_cast<int>(-analog);
+			mouseMotion.y -= analog;
 		}
 		else if (direction & Direction::down)
 		{
-			y = static_cast<int>(analog);
+			mouseMotion.y += analog;
 		}
 	}
-	else
-	{
-		y = 0;
-	}
-
-	if (x != 0 || y != 0)
-	{
-		MouseSimulator::moveBy(x, y);
-	}
 }
 
 void InputSimulator::simulateKeyboard(const InputMap& m, PressedState state)
@@ -607,26 +528,26 @@ void InputSimulator::simulateKeyboard(const InputMap& m, PressedState state)
 	switch (state)
 	{
 		case PressedState::pressed:
-			keyboard.keyDown(keyCode);
+			outputBuffer.keyboardKey(keyCode, true);
 
 			if (!m.keyCodeModifiers.empty())
 			{
 				for (VirtualKeyCode k : m.keyCodeModifiers)
 				{
-					keyboard.keyDown(k);
+					outputBuffer.keyboardKey(k, true);
 				}
 			}
 
 			break;
 
 		case PressedState::released:
-			keyboard.keyUp(keyCode);
+			outputBuffer.keyboardKey(keyCode, false);
 
 			if (!m.keyCodeModifiers.empty())
 			{
 				for (VirtualKeyCode k : m.keyCodeModifiers)
 				{
-					keyboard.keyUp(k);
+					outputBuffer.keyboardKey(k, false);
 				}
 			}
 
@@ -637,6 +558,54 @@ void InputSimulator::simulateKeyboard(const InputMap& m, PressedState state)
 	}
 }
 
+void InputSimulator::flushOutput()
+{
+	const int dx = takeWholePixels(mouseMotion.x, mouseRemainder.x);
+	const int dy = takeWholePixels(mouseMotion.y, mouseRemainder.y);
+
+	mouseMotion = Vector2::zero;
+	outputBuffer.mouseMove(dx, dy);
+
+	if (parent->profile.useXInput)
+	{
+		outputBuffer.xinputState(xinputPad);
+	}
+
+	if (outputBuffer.empty())
+	{
+		return;
+	}
+
+	if (outputSink != nullptr)
+	{
+		outputBuffer.send(*outputSink);
+	}
+	else
+	{
+		outputBuffer.send(win32Output);
+		outputBuffer.send(vigemOutput);
+	}
+
+	outputBuffer.clear();
+}
+
+int InputSimulator::takeWholePixels(float motion, float& remainder)
+{
+	// nothing moved this axis this tick, so drop the leftover instead of
+	// letting it add a stray pixel to the next, unrelated motion
+	if (gmath::is_zero(motion))
+	{
+		remainder = 0.0f;
+		return 0;
+	}
+
+	const float total = motion + remainder;
+	const auto whole = static_cast<int>(total);
+
+	remainder = total - static_cast<float>(whole);
+	return whole;
+}
+
 void InputSimulator::runAction(ActionType action) const
 {
 	switch (action)
@@ -656,389 +625,785 @@ void InputSimulator::runAction(ActionType action) const
 
 void InputSimulator::updateDeltaTime()
 {
-	deltaTime = static_cast<float>(duration_cast<milliseconds>(deltaStopwatch.elapsed()).count()) / deltaTimeTarget;
-	deltaStopwatch.start();
+	tickTime = Stopwatch::now();
+
+	const auto elapsed = std::clamp(duration_cast<microseconds>(tickTime - lastTickTime), microseconds::zero(), maxTickDuration);
+	lastTickTime = tickTime;
+
+	deltaTime = DeltaTime(elapsed).count();
+
+	stepRemainder += elapsed;
+	stepCount = static_cast<size_t>(stepRemainder / fixedStep);
+	stepRemainder %= fixedStep;
+	stepAlpha = static_cast<float>(stepRemainder.count()) / static_cast<float>(fixedStep.count());
 }
 
-void InputSimulator::updateModifierStates()
+void InputSimulator::markChangedInputs()
 {
-	auto visitor = [&](InputModifier* m) -> bool
-	{
-		return updateModifierState(*m);
-	};
+	evaluateAll = evaluateAllNextTick;
+	evaluateAllNextTick = false;
 
-	for (const Ds4Buttons_t bit : Ds4Buttons_values)
+	if (++generation == 0)
 	{
-		modifiers.visitButtonMaps(bit, visitor);
-	}
+		// stamps from the last time around could be mistaken for current ones
+		std::fill(modifierGenerations.begin(), modifierGenerations.end(), 0);
+		std::fill(bindingGenerations.begin(), bindingGenerations.end(), 0);
+		dirtyTopLevel.clear();
 
-	for (const Ds4Axes_t bit : Ds4Axes_values)
-	{
-		modifiers.visitAxisMaps(bit, visitor);
+		generation = 1;
+		evaluateAll = true;
 	}
 
-	for (auto& pair : touchRegions)
+	if (evaluateAll)
 	{
-		modifiers.visitTouchMaps(pair.first, visitor);
+		return;
 	}
-}
 
-void InputSimulator::updateBindingStates()
-{
-	auto visitor = [&](InputMap* m) -> bool
+	const Ds4Input& input = parent->input;
+	const Ds4Buttons_t buttons = input.pressedButtons | input.releasedButtons;
+
+	const bool touched = input.touchChanged || (input.heldButtons & touchMask) != 0 || !liveTouchRegions.empty() ||
+	                     gestures.changed();
+
+	program.modifiers.dependents.visit(buttons, input.axes, touched, [&](uint32_t index) -> void
 	{
-		return updateBindingState(*m, nullptr);
-	};
+		modifierGenerations[index] = generation;
+	});
 
-	for (const Ds4Buttons_t bit : Ds4Buttons_values)
+	program.bindings.dependents.visit(buttons, input.axes, touched, [&](uint32_t index) -> void
 	{
-		bindings.visitButtonMaps(bit, visitor);
-	}
+		markBinding(index, generation);
+	});
+}
+
+void InputSimulator::addRapidFireTimers()
+{
+	modifierTimers.assign(program.modifiers.size(), TimerWheel::invalidTimer);
+	bindingTimers.assign(program.bindings.size(), TimerWheel::invalidTimer);
 
-	for (const Ds4Axes_t bit : Ds4Axes_values)
+	// each expiry flips the map between the halves of its cycle and schedules the next
+	// a whole number of intervals later, so the cycle doesn't drift with tick timing
+	for (uint32_t i = 0; i < program.modifiers.size(); ++i)
 	{
-		bindings.visitAxisMaps(bit, visitor);
+		if (program.modifiers.maps[i]->rapidFire == true)
+		{
+			modifierTimers[i] = timerWheel.add([this, i](Stopwatch::TimePoint deadline)
+			{
+				InputModifier& modifier = *program.modifiers.maps[i];
+				modifier.advanceRapidFire();
+				timerWheel.schedule(modifierTimers[i], nextRapidFireDeadline(deadline, modifier.getRapidFireInterval()));
+				modifierGenerations[i] = generation + 1;
+			});
+		}
 	}
 
-	for (auto& pair : touchRegions)
+	for (uint32_t i = 0; i < program.bindings.size(); ++i)
 	{
-		bindings.visitTouchMaps(pair.first, visitor);
+		if (program.bindings.maps[i]->rapidFire == true)
+		{
+			bindingTimers[i] = timerWheel.add([this, i](Stopwatch::TimePoint deadline)
+			{
+				InputMap& map = *program.bindings.maps[i];
+				map.advanceRapidFire();
+				timerWheel.schedule(bindingTimers[i], nextRapidFireDeadline(deadline, map.getRapidFireInterval()));
+				markBinding(i, generation + 1);
+			});
+		}
 	}
 }
 
-void InputSimulator::startTick()
+Stopwatch::TimePoint InputSimulator::nextRapidFireDeadline(Stopwatch::TimePoint deadline, microseconds interval) const
 {
-	parent->output.leftMotor  = 0;
-	parent->output.rightMotor = 0;
+	Stopwatch::TimePoint next = deadline + interval;
 
-	bindings.reset();
-	modifiers.reset();
+	if (next <= tickTime && interval > microseconds::zero())
+	{
+		const auto missed = (tickTime - deadline) / interval;
+		next = deadline + interval * (missed + 1);
+	}
 
-	updateDeltaTime();
-	
-	simulatedXInputAxis = 0;
+	return next;
 }
 
-void InputSimulator::setRumble(float leftMotor, float rightMotor) const
+void InputSimulator::removeRapidFireTimers()
 {
-	leftMotor  = std::clamp(leftMotor, 0.0f, 1.0f);
-	rightMotor = std::clamp(rightMotor, 0.0f, 1.0f);
+	for (const TimerWheel::TimerId timer : modifierTimers)
+	{
+		timerWheel.remove(timer);
+	}
 
-	parent->output.leftMotor  = std::max(static_cast<uint8_t>(leftMotor * 255.0f),  parent->output.leftMotor);
-	parent->output.rightMotor = std::max(static_cast<uint8_t>(rightMotor * 255.0f), parent->output.rightMotor);
+	for (const TimerWheel::TimerId timer : bindingTimers)
+	{
+		timerWheel.remove(timer);
+	}
+
+	modifierTimers.clear();
+	bindingTimers.clear();
 }
 
-bool InputSimulator::addSimulator(ISimulator* simulator)
+void InputSimulator::updateRapidFireTimer(TimerWheel::TimerId timer, const InputMapBase& map)
 {
-	if (simulator == nullptr)
+	if (timer == TimerWheel::invalidTimer)
 	{
-		return false;
+		return;
 	}
 
-	const auto it = simulators.find(simulator);
-
-	if (it != simulators.end())
+	if (!map.isActive())
 	{
-		return false;
+		timerWheel.cancel(timer);
+	}
+	else if (!timerWheel.scheduled(timer))
+	{
+		timerWheel.schedule(timer, tickTime + map.getRapidFireInterval());
 	}
-
-	simulators.insert(simulator);
-	simulator->activate(deltaTime);
-	return true;
 }
 
-bool InputSimulator::removeSimulator(ISimulator* simulator)
+void InputSimulator::updateLatch(std::vector<uint32_t>& list, std::vector<uint32_t>& slots, uint32_t index, bool latched) // static
 {
-	if (simulator == nullptr)
+	const uint32_t slot = slots[index];
+
+	if (latched == (slot != notLatched))
 	{
-		return false;
+		return;
 	}
 
-	const auto it = simulators.find(simulator);
-
-	if (it == simulators.end())
+	if (latched)
 	{
-		return false;
+		slots[index] = static_cast<uint32_t>(list.size());
+		list.push_back(index);
+		return;
 	}
 
-	simulators.erase(it);
-	return true;
+	// move the last entry into the vacated slot
+	const uint32_t last = list.back();
+	list[slot] = last;
+	slots[last] = slot;
+
+	list.pop_back();
+	slots[index] = notLatched;
 }
 
-void InputSimulator::runSimulators()
+void InputSimulator::addMacroTimers()
 {
-	for (auto it = simulators.begin(); it != simulators.end();)
-	{
-		ISimulator* ptr = *it;
-		ptr->update(deltaTime);
+	macroTimers.assign(program.bindings.size(), TimerWheel::invalidTimer);
+	macroNext = program.macroEnd;
+	macroStart.assign(program.bindings.size(), Stopwatch::TimePoint {});
 
-		if (ptr->state == SimulatorState::inactive)
+	for (uint32_t i = 0; i < program.bindings.size(); ++i)
+	{
+		if (program.macroBegin[i] != program.macroEnd[i])
 		{
-			ptr->deactivate(deltaTime);
-			it = simulators.erase(it);
+			macroTimers[i] = timerWheel.add([this, i](Stopwatch::TimePoint deadline)
+			{
+				playMacro(i, deadline);
+			});
 		}
-		else
-		{
-			++it;
+	}
+}
+
+void InputSimulator::removeMacroTimers()
+{
+	for (uint32_t i = 0; i < macroTimers.size(); ++i)
+	{
+		if (macroTimers[i] != TimerWheel::invalidTimer)
+		{
+			stopMacro(i);
+			timerWheel.remove(macroTimers[i]);
 		}
 	}
+
+	macroTimers.clear();
+	macroNext.clear();
+	macroStart.clear();
 }
 
-void InputSimulator::runMaps()
+void InputSimulator::startMacro(uint32_t index)
 {
-	startTick();
+	// pressing again mid-macro doesn't restart it, so a restart can't cut off its releases
+	if (macroTimers[index] == TimerWheel::invalidTimer || macroNext[index] < program.macroEnd[index])
+	{
+		return;
+	}
 
-	updateTouchRegions();
-	updateModifierStates();
-	updateBindingStates();
+	macroNext[index]  = program.macroBegin[index];
+	macroStart[index] = tickTime;
 
-	runSimulators();
+	playMacro(index, tickTime);
+}
+
+void InputSimulator::playMacro(uint32_t index, Stopwatch::TimePoint now)
+{
+	const uint32_t end = program.macroEnd[index];
+	uint32_t& next = macroNext[index];
+
+	// events at the same time are played together, in order
+	while (next < end && macroStart[index] + program.macroEvents[next].time <= now)
+	{
+		emitMacroEvent(program.macroEvents[next]);
+		++next;
+	}
 
-	if (parent->profile.useXInput &&
-	    xinputTarget && xinputTarget->connected() &&
-	    xinputPad != xinputLast)
+	if (next < end)
 	{
-		xinputLast = xinputPad;
-		xinputTarget->update(xinputPad);
+		timerWheel.schedule(macroTimers[index], macroStart[index] + program.macroEvents[next].time);
 	}
 }
 
-void InputSimulator::runPersistent()
+void InputSimulator::stopMacro(uint32_t index)
 {
-	startTick();
+	timerWheel.cancel(macroTimers[index]);
+
+	const uint32_t end = program.macroEnd[index];
 
-	for (InputModifier* modifier : modifiers.allMaps())
+	for (uint32_t& next = macroNext[index]; next < end; ++next)
 	{
-		if (modifier->isPersistent())
+		const MacroEvent& event = program.macroEvents[next];
+
+		if (event.isRelease())
 		{
-			updateModifierState(*modifier);
+			emitMacroEvent(event);
 		}
 	}
+}
 
-	for (InputMap* map : bindings.allMaps())
+void InputSimulator::emitMacroEvent(const MacroEvent& event)
+{
+	switch (event.type)
 	{
-		if (map->isPersistent())
-		{
-			updateBindingState(*map, nullptr);
-		}
+		case MacroEvent::Type::keyboardKey:
+			outputBuffer.keyboardKey(event.x, event.y != 0);
+			break;
+
+		case MacroEvent::Type::mouseButton:
+			outputBuffer.mouseButton(MouseButton::_from_integral(event.x), event.y != 0);
+			break;
+
+		case MacroEvent::Type::mouseMove:
+			outputBuffer.mouseMove(event.x, event.y);
+			break;
+
+		case MacroEvent::Type::xinputState:
+			xinputPad = event.xinput;
+			break;
+
+		default:
+			throw std::out_of_range("invalid MacroEvent::Type");
 	}
+}
 
-	runSimulators();
+void InputSimulator::markBinding(uint32_t index, uint32_t due)
+{
+	if (bindingGenerations[index] == due)
+	{
+		return;
+	}
+
+	bindingGenerations[index] = due;
+
+	if (index >= program.topLevelBegin)
+	{
+		dirtyTopLevel.push_back(index);
+	}
 }
 
-void InputSimulator::updateTouchRegions()
+bool InputSimulator::isSettled(const InputMapBase& map) // static
 {
-	Ds4Buttons_t disallow = 0;
+	return map.pressedState == PressedState::off && !map.isActive();
+}
 
-	std::sort(sortableTouchRegions.begin(), sortableTouchRegions.end(), [](const Ds4TouchRegion* a, const Ds4TouchRegion* b)
+void InputSimulator::updateModifierStates()
+{
+	for (uint32_t i = 0; i < program.modifiers.size(); ++i)
 	{
-		return (a->isTouchActive(touchMask) && !a->allowCrossOver) && !(b->isTouchActive(touchMask) && !b->allowCrossOver);
-	});
+		updateModifierState(i, evaluateAll);
+	}
+}
 
-	const Ds4Buttons_t inactiveTouchPoints = (parent->input.heldButtons & touchMask) ^ touchMask;
+void InputSimulator::updateBindingStates()
+{
+	pendingTopLevel.swap(dirtyTopLevel);
 
-	auto makeInactive = [&](Ds4Buttons_t touchId, Ds4TouchRegion* region, const Ds4Vector2& point)
+	if (evaluateAll)
 	{
-		if ((inactiveTouchPoints & touchId) && region->isTouchActive(touchId))
+		for (uint32_t i = program.topLevelBegin; i < program.bindings.size(); ++i)
 		{
-			region->deactivateTouch(touchId, point);
+			updateBindingState(i, nullptr);
 		}
-	};
+	}
+	else
+	{
+		// evaluate in program order so the outcome doesn't depend on which input changed first
+		std::sort(pendingTopLevel.begin(), pendingTopLevel.end());
 
-	// TODO: devise a cleaner way to get and manipulate touch data for each touch point
+		for (const uint32_t i : pendingTopLevel)
+		{
+			updateBindingState(i, nullptr);
+		}
+	}
+
+	pendingTopLevel.clear();
+}
+
+void InputSimulator::startTick()
+{
+	parent->output.leftMotor  = 0;
+	parent->output.rightMotor = 0;
 
-	for (auto& region : sortableTouchRegions)
+	updateDeltaTime();
+	
+	simulatedXInputAxis = 0;
+
+	timerWheel.advance(tickTime);
+}
+
+void InputSimulator::setRumble(float leftMotor, float rightMotor) const
+{
+	leftMotor  = std::clamp(leftMotor, 0.0f, 1.0f);
+	rightMotor = std::clamp(rightMotor, 0.0f, 1.0f);
+
+	parent->output.leftMotor  = std::max(static_cast<uint8_t>(leftMotor * 255.0f),  parent->output.leftMotor);
+	parent->output.rightMotor = std::max(static_cast<uint8_t>(rightMotor * 255.0f), parent->output.rightMotor);
+}
+
+void InputSimulator::setOutputSink(IOutputSink* sink)
+{
+	outputSink = sink;
+	outputBuffer.reset();
+}
+
+TimerWheel& InputSimulator::timers()
+{
+	return timerWheel;
+}
+
+Stopwatch::TimePoint InputSimulator::time() const
+{
+	return tickTime;
+}
+
+std::optional<Stopwatch::TimePoint> InputSimulator::nextDeadline() const
+{
+	return timerWheel.nextDeadline();
+}
+
+bool InputSimulator::addSimulator(ISimulator* simulator)
+{
+	if (simulator == nullptr)
 	{
-		if (region->isTouchActive(inactiveTouchPoints))
+		return false;
+	}
+
+	if (simulator->registrySlot != ISimulator::unregistered)
+	{
+		return false;
+	}
+
+	simulator->registrySlot = static_cast<uint32_t>(simulators.size());
+	simulators.push_back(simulator);
+	simulator->activate(deltaTime);
+	return true;
+}
+
+bool InputSimulator::removeSimulator(ISimulator* simulator)
+{
+	if (simulator == nullptr)
+	{
+		return false;
+	}
+
+	if (simulator->registrySlot == ISimulator::unregistered)
+	{
+		return false;
+	}
+
+	simulators[simulator->registrySlot] = nullptr;
+	simulator->registrySlot = ISimulator::unregistered;
+	++removedSimulators;
+	return true;
+}
+
+void InputSimulator::runSimulators()
+{
+	const float fixedDeltaTime = DeltaTime(fixedStep).count();
+
+	// simulators may be added while this runs, so the size is read on every pass
+	for (size_t i = 0; i < simulators.size(); ++i)
+	{
+		ISimulator* ptr = simulators[i];
+
+		if (ptr == nullptr)
 		{
-			makeInactive(Ds4Buttons::touch1, region, parent->input.data.touchPoint1);
-			makeInactive(Ds4Buttons::touch2, region, parent->input.data.touchPoint2);
 			continue;
 		}
 
-		updateTouchRegion(*region, Ds4Buttons::touch1, parent->input.data.touchPoint1, disallow);
-		updateTouchRegion(*region, Ds4Buttons::touch2, parent->input.data.touchPoint2, disallow);
+		if (ptr->fixedStep())
+		{
+			for (size_t step = 0; step < stepCount && ptr->state == SimulatorState::active; ++step)
+			{
+				ptr->update(fixedDeltaTime);
+			}
+
+			ptr->interpolate(stepAlpha);
+		}
+		else
+		{
+			ptr->update(deltaTime);
+		}
+
+		if (ptr->state == SimulatorState::inactive && ptr->registrySlot == i)
+		{
+			removeSimulator(ptr);
+		}
+	}
+
+	if (removedSimulators != 0)
+	{
+		compactSimulators();
 	}
 }
 
-void InputSimulator::updateTouchRegion(Ds4TouchRegion& region, Ds4Buttons_t sender, const Ds4Vector2& point, Ds4Buttons_t& disallow) const
+void InputSimulator::compactSimulators()
 {
-	if (!!(disallow & sender) || !(parent->input.heldButtons & sender) || !region.isInRegion(sender, point))
+	size_t count = 0;
+
+	for (ISimulator* simulator : simulators)
 	{
-		region.deactivateTouch(sender, point);
-		return;
+		if (simulator != nullptr)
+		{
+			simulator->registrySlot = static_cast<uint32_t>(count);
+			simulators[count++] = simulator;
+		}
 	}
 
-	region.activateTouch(sender, point);
+	simulators.resize(count);
+	removedSimulators = 0;
+}
 
-	if (!region.allowCrossOver)
+void InputSimulator::runMaps()
+{
+	startTick();
+
+	// one sample per report, stamped once with the report's arrival time
+	touchHistory.push(parent->input.data, tickTime);
+	gestures.update(touchHistory.newest());
+
+	updateTouchRegions();
+	markChangedInputs();
+	updateModifierStates();
+	updateBindingStates();
+
+	runSimulators();
+	flushOutput();
+}
+
+void InputSimulator::runPersistent()
+{
+	startTick();
+
+	// run in program order as a full tick would
+	persistentModifiers.assign(latchedModifiers.begin(), latchedModifiers.end());
+	std::sort(persistentModifiers.begin(), persistentModifiers.end());
+
+	persistentBindings.assign(latchedBindings.begin(), latchedBindings.end());
+	std::sort(persistentBindings.begin(), persistentBindings.end());
+
+	for (const uint32_t i : persistentModifiers)
 	{
-		disallow |= sender;
+		updateModifierState(i, true);
+	}
+
+	for (const uint32_t i : persistentBindings)
+	{
+		const uint32_t parent = program.parents[i];
+
+		if (parent == BindingProgram::noParent)
+		{
+			updateBindingState(i, nullptr);
+		}
+		else if (!std::binary_search(persistentModifiers.begin(), persistentModifiers.end(), parent))
+		{
+			// bindings of a latched modifier set already ran with it
+			updateBindingState(i, program.modifiers.maps[parent]);
+		}
 	}
+
+	runSimulators();
+	flushOutput();
 }
 
-void InputSimulator::updatePressedState(InputMapBase& instance, const std::function<void()>& press, const std::function<void()>& release)
+bool InputSimulator::needsTick() const
 {
-	if (isOverriddenByModifierSet(instance))
+	for (const ISimulator* simulator : simulators)
 	{
-		release();
-		return;
+		if (simulator != nullptr && simulator->needsTick())
+		{
+			return true;
+		}
 	}
 
-	for (InputType_t value : InputType_values)
+	return false;
+}
+
+void InputSimulator::wake() const
+{
+	parent->wake();
+}
+
+void InputSimulator::updateTouchRegions()
+{
+	const Ds4Input& input = parent->input;
+
+	if (++touchRegionGeneration == 0)
 	{
-		if ((instance.inputType & value) == 0)
+		// stamps from the last time around could be mistaken for current ones
+		std::fill(touchRegionStamps.begin(), touchRegionStamps.end(), 0);
+		touchRegionGeneration = 1;
+	}
+
+	Ds4Buttons_t disallow = 0;
+
+	const Ds4Buttons_t inactiveTouchPoints = (input.heldButtons & touchMask) ^ touchMask;
+
+	auto makeInactive = [&](Ds4Buttons_t touchId, Ds4TouchRegion* region)
+	{
+		if ((inactiveTouchPoints & touchId) && region->isTouchActive(touchId))
 		{
-			continue;
+			region->deactivateTouch(touchId);
 		}
+	};
+
+	// TODO: devise a cleaner way to get and manipulate touch data for each touch point
 
-		switch (value)
+	touchRegionVisits.clear();
+
+	const auto visit = [&](uint32_t index)
+	{
+		if (touchRegionStamps[index] == touchRegionGeneration)
 		{
-			case InputType::button:
-				if ((instance.inputButtons.value() & parent->input.heldButtons) == instance.inputButtons)
-				{
-					press();
-				}
-				else
-				{
-					release();
-				}
+			return;
+		}
 
-				break;
+		touchRegionStamps[index] = touchRegionGeneration;
 
-			case InputType::axis:
-			{
-				if (instance.inputAxes.value_or(0) == 0)
-				{
-					throw std::invalid_argument("inputAxes has invalid or no value");
-				}
+		Ds4TouchRegion* region = touchRegionList[index];
 
-				const gsl::span<const Ds4Axes_t> axes(Ds4Axes_values);
+		if (region->isTouchActive(inactiveTouchPoints))
+		{
+			makeInactive(Ds4Buttons::touch1, region);
+			makeInactive(Ds4Buttons::touch2, region);
+		}
+		else
+		{
+			updateTouchRegion(*region, Ds4Buttons::touch1, input.data.touchPoint1, disallow);
+			updateTouchRegion(*region, Ds4Buttons::touch2, input.data.touchPoint2, disallow);
+		}
 
-				const size_t target = std::count_if(axes.begin(), axes.end(), [&](Ds4Axes_t x) -> bool
-				{
-					return (x & instance.inputAxes.value()) != 0;
-				});
+		if (isLive(*region))
+		{
+			touchRegionVisits.push_back(index);
+		}
+	};
 
-				size_t count = 0;
+	// Regions holding a touch without allowing cross-over keep it even outside their bounds,
+	// so they claim their touch points first.
+	for (const uint32_t index : liveTouchRegions)
+	{
+		if (isLocked(*touchRegionList[index]))
+		{
+			visit(index);
+		}
+	}
 
-				for (Ds4Axes_t bit : Ds4Axes_values)
-				{
-					if (!(instance.inputAxes.value() & bit))
-					{
-						continue;
-					}
-
-					InputAxisOptions options = instance.getAxisOptions(bit);
-
-					const float axis = parent->input.getAxis(instance.inputAxes.value(), options.polarity);
-
-					if (axis >= options.deadZone.value_or(0.0f))
-					{
-						++count;
-					}
-					else
-					{
-						break;
-					}
-				}
+	const auto lockedEnd = static_cast<ptrdiff_t>(touchRegionVisits.size());
 
-				if (count == target)
-				{
-					press();
-				}
-				else
-				{
-					release();
-				}
+	// The rest go in priority order: the remaining live regions and the candidates under
+	// each touch point are all sorted by index, so they are merged as they are walked.
+	const gsl::span<const uint32_t> live(liveTouchRegions.data(), static_cast<ptrdiff_t>(liveTouchRegions.size()));
 
-				break;
-			}
+	const gsl::span<const uint32_t> candidates1 = input.heldButtons & Ds4Buttons::touch1
+	                                              ? touchGrid.candidatesAt(input.data.touchPoint1)
+	                                              : gsl::span<const uint32_t>();
 
-			case InputType::touchRegion:
-			{
-				auto it = touchRegions.find(instance.inputTouchRegion);
+	const gsl::span<const uint32_t> candidates2 = input.heldButtons & Ds4Buttons::touch2
+	                                              ? touchGrid.candidatesAt(input.data.touchPoint2)
+	                                              : gsl::span<const uint32_t>();
 
-				if (it == touchRegions.end())
-				{
-					break;
-				}
+	ptrdiff_t l = 0, c1 = 0, c2 = 0;
 
-				Ds4TouchRegion* region = it->second;
-				const auto direction = instance.inputTouchDirection.value_or(Direction::none);
+	while (true)
+	{
+		uint32_t next = UINT32_MAX;
 
-				if (region->isActive(Ds4Buttons::touch1, direction) ||
-				    region->isActive(Ds4Buttons::touch2, direction))
-				{
-					press();
-				}
-				else
-				{
-					release();
-				}
+		if (l < live.size())
+		{
+			next = std::min(next, live[l]);
+		}
 
-				break;
-			}
+		if (c1 < candidates1.size())
+		{
+			next = std::min(next, candidates1[c1]);
+		}
 
-			case InputType::none:
-				break;
+		if (c2 < candidates2.size())
+		{
+			next = std::min(next, candidates2[c2]);
+		}
 
-			default:
-				throw std::out_of_range("invalid InputType");
+		if (next == UINT32_MAX)
+		{
+			break;
+		}
+
+		if (l < live.size() && live[l] == next)
+		{
+			++l;
+		}
+
+		if (c1 < candidates1.size() && candidates1[c1] == next)
+		{
+			++c1;
+		}
+
+		if (c2 < candidates2.size() && candidates2[c2] == next)
+		{
+			++c2;
 		}
+
+		visit(next);
 	}
+
+	// both runs are in priority order
+	liveTouchRegions.clear();
+	std::merge(touchRegionVisits.begin(), touchRegionVisits.begin() + lockedEnd,
+	           touchRegionVisits.begin() + lockedEnd, touchRegionVisits.end(),
+	           std::back_inserter(liveTouchRegions));
 }
 
-bool InputSimulator::updateModifierState(InputModifier& modifier)
+bool InputSimulator::isLocked(const Ds4TouchRegion& region)
 {
-	const PressedState oldPressedState = modifier.pressedState;
+	return region.isTouchActive(touchMask) && !region.allowCrossOver;
+}
 
-	const auto press = [&]() -> void
+bool InputSimulator::isLive(const Ds4TouchRegion& region)
+{
+	return region.isTouchActive(touchMask) ||
+	       region.state1.pressedState != PressedState::off ||
+	       region.state2.pressedState != PressedState::off;
+}
+
+void InputSimulator::updateTouchRegion(Ds4TouchRegion& region, Ds4Buttons_t sender, const Ds4Vector2& point, Ds4Buttons_t& disallow) const
+{
+	if (!!(disallow & sender) || !(parent->input.heldButtons & sender) || !region.isInRegion(sender, point))
 	{
-		modifier.press();
-	};
+		region.deactivateTouch(sender);
+		return;
+	}
 
-	const auto release = [&]() -> void
+	region.activateTouch(sender, point);
+
+	if (!region.allowCrossOver)
 	{
-		modifier.release();
-	};
+		disallow |= sender;
+	}
+}
+
+bool InputSimulator::updateModifierState(uint32_t index, bool force)
+{
+	InputModifier& modifier = *program.modifiers.maps[index];
+	const PressedState oldPressedState = modifier.pressedState;
 
-	updatePressedState(modifier, press, release);
+	const bool evaluate = force || modifierGenerations[index] == generation || !isSettled(modifier);
 
-	if (!modifier.bindings.empty())
+	if (evaluate)
 	{
-		for (InputMap& bind : modifier.bindings)
+		if (program.isOverridden(program.modifiers, index, activeChildren))
 		{
-			updateBindingState(bind, &modifier);
+			modifier.release();
+		}
+		else
+		{
+			switch (program.evaluate(program.modifiers, index, parent->input, gestures))
+			{
+				case BindingInput::active:
+					modifier.press();
+					break;
+
+				case BindingInput::inactive:
+					modifier.release();
+					break;
+
+				default:
+					break;
+			}
+		}
+
+		updateRapidFireTimer(modifierTimers[index], modifier);
+		updateLatch(latchedModifiers, modifierLatchSlots, index, modifier.isLatched());
+	}
+
+	// every binding depends on the state of its modifier set as well as its own inputs
+	const bool allBindings = force || oldPressedState != modifier.pressedState || !isSettled(modifier);
+
+	for (uint32_t i = program.childBegin[index]; i < program.childEnd[index]; ++i)
+	{
+		if (allBindings || bindingGenerations[i] == generation)
+		{
+			updateBindingState(i, &modifier);
 		}
 	}
 
 	return oldPressedState != modifier.pressedState;
 }
 
-bool InputSimulator::updateBindingState(InputMap& map, InputModifier* modifier)
+bool InputSimulator::updateBindingState(uint32_t index, InputModifier* modifier)
 {
+	InputMap& map = *program.bindings.maps[index];
 	const PressedState oldPressedState = map.pressedState;
+	const bool wasActive = map.isActive();
 
 	if (modifier != nullptr && map.toggle != true && !modifier->isActive())
 	{
 		map.release();
-		runMap(map, modifier);
-		return map.pressedState != oldPressedState;
 	}
+	else if (program.isOverridden(program.bindings, index, activeChildren))
+	{
+		map.release();
+	}
+	else
+	{
+		switch (program.evaluate(program.bindings, index, parent->input, gestures))
+		{
+			case BindingInput::active:
+				map.pressWithModifier(modifier);
+				break;
 
-	const auto press = [&]() -> void
+			case BindingInput::inactive:
+				map.release();
+				break;
+
+			default:
+				break;
+		}
+	}
+
+	updateRapidFireTimer(bindingTimers[index], map);
+	runBinding(index, modifier);
+	updateLatch(latchedBindings, bindingLatchSlots, index, map.isLatched());
+
+	if (!isSettled(map))
 	{
-		map.pressWithModifier(modifier);
-	};
+		markBinding(index, generation + 1);
+	}
 
-	const auto release = [&]() -> void
+	// bindings of a modifier set override other maps with the same inputs while active
+	if (modifier != nullptr && wasActive != map.isActive())
 	{
-		map.release();
-	};
+		activeChildren[index / 64] ^= 1ull << (index % 64);
+
+		evaluateAll = true;
+		evaluateAllNextTick = true;
+	}
 
-	updatePressedState(map, press, release);
-	runMap(map, modifier);
 	return oldPressedState != map.pressedState;
 }
 
@@ -1125,6 +1490,8 @@ bool InputSimulator::xinputTargetOpen()
 
 		xinputRumbleSimulator = std::make_unique<XInputRumbleSimulator>(this);
 		xinputRumbleSimulator->xinputTarget = xinputTarget;
+
+		vigemOutput.target = xinputTarget;
 	}
 
 	return true;
@@ -1139,5 +1506,6 @@ void InputSimulator::xinputTargetClose()
 	}
 
 	xinputDisconnect();
+	vigemOutput.target = nullptr;
 	xinputTarget = nullptr;
 }
@@ -1,20 +1,24 @@
 #pragma once
 
-#include <functional>
-#include <unordered_set>
 #include <unordered_map>
 
-#include "KeyboardSimulator.h"
-#include "MouseSimulator.h"
+#include "Vector2.h"
 #include "enums.h"
 #include "Pressable.h"
 #include "InputMap.h"
 #include "XInputGamepad.h"
 #include "ViGEmTarget.h"
-#include "MapCache.h"
+#include "BindingProgram.h"
+#include "Ds4GestureRecognizer.h"
+#include "Ds4TouchGrid.h"
 #include "ISimulator.h"
+#include "IOutputSink.h"
+#include "OutputBuffer.h"
+#include "Win32OutputSink.h"
+#include "ViGEmOutputSink.h"
 #include "XInputRumbleSimulator.h"
 #include "RumbleSequence.h"
+#include "TimerWheel.h"
 
 class Ds4Device;
 
@@ -23,34 +27,213 @@ class Ds4Device;
  */
 class InputSimulator
 {
+	friend class InputBenchmarks;
+
 	static constexpr Ds4Buttons_t touchMask = Ds4Buttons::touch1 | Ds4Buttons::touch2;
+	static constexpr uint32_t notLatched = UINT32_MAX;
 
 	Ds4Device* parent = nullptr;
 
-	KeyboardSimulator keyboard;
-	MouseSimulator mouse;
+	/**
+	 * \brief Every timed behaviour of the device. Declared first so that it
+	 * outlives the simulators that register timers with it.
+	 * \sa timers
+	 */
+	TimerWheel timerWheel;
+
+	/**
+	 * \brief Output produced during the current tick. Delivered by \c flushOutput to
+	 * \c outputSink if set, otherwise to the system through \c win32Output and \c vigemOutput.
+	 */
+	OutputBuffer outputBuffer;
+	Win32OutputSink win32Output;
+	ViGEmOutputSink vigemOutput;
+
+	/**
+	 * \brief Mouse motion produced by bindings this tick, in pixels. Queued once per tick by \c flushOutput.
+	 */
+	Vector2 mouseMotion {};
+
+	/**
+	 * \brief Fraction of a pixel left over on each axis after the last tick's motion was sent.
+	 */
+	Vector2 mouseRemainder {};
 
 	Ds4TouchRegionCache touchRegions;
-	std::vector<Ds4TouchRegion*> sortableTouchRegions;
 
-	std::unordered_map<InputModifier*, MapCacheCollection<InputMap>> modifierMaps;
-	MapCacheCollection<InputModifier> modifiers;
-	MapCacheCollection<InputMap> bindings;
+	/**
+	 * \brief Every touch region of the profile in priority order, which is profile order.
+	 */
+	std::vector<Ds4TouchRegion*> touchRegionList;
+
+	Ds4TouchGrid touchGrid;
+
+	/**
+	 * \brief Touch points of the most recent input reports, read by every touch region.
+	 */
+	Ds4TouchHistoryRing touchHistory;
+
+	/**
+	 * \brief Touch gestures recognized from \c touchHistory.
+	 */
+	Ds4GestureRecognizer gestures;
+
+	/**
+	 * \brief Indices into \c touchRegionList of regions with an active touch or a press that hasn't settled,
+	 * which must be updated even when no touch point is over them. Kept in priority order.
+	 */
+	std::vector<uint32_t> liveTouchRegions;
+
+	/**
+	 * \brief Regions that are live after the current tick, as the runs built by \c updateTouchRegions
+	 * before they are merged into \c liveTouchRegions. Kept as a member only to reuse its storage.
+	 */
+	std::vector<uint32_t> touchRegionVisits;
+
+	/**
+	 * \brief The \c touchRegionGeneration each region was last updated in, so that a region
+	 * reached both as live and as a grid candidate is only updated once per tick.
+	 */
+	std::vector<uint32_t> touchRegionStamps;
+	uint32_t touchRegionGeneration = 0;
+
+	BindingProgram program;
+
+	/**
+	 * \brief Bitset over \c program.bindings of the modifier set bindings that are currently active.
+	 * \sa BindingProgram::isOverridden
+	 */
+	std::vector<uint64_t> activeChildren;
+
+	/**
+	 * \brief Incremented by every input tick; identifies the tick entries are due in.
+	 * \sa markChangedInputs
+	 */
+	uint32_t generation = 0;
+
+	/**
+	 * \brief The generation each modifier set and binding is next due to be evaluated in.
+	 * Entries stamped with an older generation are up to date and are skipped.
+	 */
+	std::vector<uint32_t> modifierGenerations;
+	std::vector<uint32_t> bindingGenerations;
+
+	/**
+	 * \brief Top-level bindings due in the upcoming \c updateBindingStates, in no particular order.
+	 */
+	std::vector<uint32_t> dirtyTopLevel;
+	std::vector<uint32_t> pendingTopLevel;
+
+	/**
+	 * \brief Modifier sets and bindings that are latched, in no particular order.
+	 * Only these are run on ticks without input.
+	 * \sa InputMapBase::isLatched, runPersistent
+	 */
+	std::vector<uint32_t> latchedModifiers;
+	std::vector<uint32_t> latchedBindings;
+
+	/**
+	 * \brief Position of each modifier set and binding in \c latchedModifiers or \c latchedBindings, or \c notLatched.
+	 */
+	std::vector<uint32_t> modifierLatchSlots;
+	std::vector<uint32_t> bindingLatchSlots;
+
+	/**
+	 * \brief Snapshots of the latched lists taken by \c runPersistent, since running an entry may unlatch it.
+	 * Kept as members only to reuse their storage.
+	 */
+	std::vector<uint32_t> persistentModifiers;
+	std::vector<uint32_t> persistentBindings;
+
+	/**
+	 * \brief Rapid fire timer of each modifier set and binding, or \c TimerWheel::invalidTimer if it has no rapid fire.
+	 */
+	std::vector<TimerWheel::TimerId> modifierTimers;
+	std::vector<TimerWheel::TimerId> bindingTimers;
+
+	/**
+	 * \brief Macro playback timer of each binding, or \c TimerWheel::invalidTimer if it doesn't play a macro.
+	 */
+	std::vector<TimerWheel::TimerId> macroTimers;
+
+	/**
+	 * \brief Index into \c BindingProgram::macroEvents of the next event played by each binding's macro,
+	 * or its \c BindingProgram::macroEnd while the macro isn't playing.
+	 */
+	std::vector<uint32_t> macroNext;
+
+	/**
+	 * \brief When each binding's macro last started playing. Event times are relative to this.
+	 */
+	std::vector<Stopwatch::TimePoint> macroStart;
+
+	/**
+	 * \brief Evaluates every modifier set and binding this tick regardless of input changes,
+	 * e.g. after a profile change or when modifier set overrides may have changed.
+	 */
+	bool evaluateAll = true;
+	bool evaluateAllNextTick = true;
 
 	XInputGamepad xinputPad {};
-	XInputGamepad xinputLast {};
 	std::shared_ptr<vigem::XInputTarget> xinputTarget;
 	XInputAxis_t simulatedXInputAxis = 0;
 
+	/**
+	 * \brief Unit of \c deltaTime: one 60th of a second, which every speed and friction setting is tuned for.
+	 */
+	using DeltaTime = std::chrono::duration<float, std::ratio<1, 60>>;
+
+	/**
+	 * \brief Length of the fixed steps run by simulators that use them.
+	 * \sa ISimulator::fixedStep
+	 */
+	static constexpr std::chrono::microseconds fixedStep { 1000 };
+
+	/**
+	 * \brief Longest time a single tick accounts for, so that a tick after
+	 * a long idle period doesn't produce a huge jump or thousands of steps.
+	 */
+	static constexpr std::chrono::microseconds maxTickDuration { 100'000 };
+
 	// TODO: refactor delta time to be the elapsed time of the last tick in seconds
-	Stopwatch deltaStopwatch {};
-	const float deltaTimeTarget = 1000.0f / 60.0f;
 	float deltaTime = 1.0f;
 
+	/**
+	 * \brief Time of the current tick, read from \c Stopwatch::now once when the tick starts
+	 * so that it can be driven by a \c VirtualClock.
+	 */
+	Stopwatch::TimePoint tickTime {};
+	Stopwatch::TimePoint lastTickTime {};
+
+	/**
+	 * \brief Elapsed time not yet consumed by a fixed step.
+	 */
+	std::chrono::microseconds stepRemainder {};
+
+	/**
+	 * \brief Number of fixed steps to run this tick.
+	 */
+	size_t stepCount = 0;
+
+	/**
+	 * \brief How far this tick is between the last fixed step and the next one, in [0, 1).
+	 */
+	float stepAlpha = 0.0f;
+
 	std::unique_ptr<XInputRumbleSimulator> xinputRumbleSimulator;
-	std::unordered_set<ISimulator*> simulators;
+
+	/**
+	 * \brief Tracked simulators in the order they were added, which is the order they are updated in.
+	 * Removed simulators leave \c nullptr behind until \c compactSimulators runs at the end of
+	 * \c runSimulators, so simulators may be added and removed while others are being updated.
+	 */
+	std::vector<ISimulator*> simulators;
+	size_t removedSimulators = 0;
+
 	std::unique_ptr<RumbleSequence> rumbleSequence;
 
+	IOutputSink* outputSink = nullptr;
+
 public:
 	/** \brief \c InputSimulator cannot be copied or moved. */
 	InputSimulator() = delete;
@@ -82,17 +265,11 @@ private:
 	/**
 	 * \brief Simulates XInput axes.
 	 * \param axes The axes to simulate.
+	 * \param negative The subset of \p axes with negative polarity.
 	 * \param m The magnitude of the axes.
 	 */
-	void simulateXInputAxis(const XInputAxes& axes, float m);
+	void simulateXInputAxis(XInputAxis_t axes, XInputAxis_t negative, float m);
 	
-	/**
-	 * \brief Checks if the given input map is overridden by an input map from the currently-active modifier set.
-	 * \param map The map whose overridden state is to be checked.
-	 * \return \c true if overridden by a modifier.
-	 */
-	bool isOverriddenByModifierSet(const InputMapBase& map);
-
 	/**
 	 * \brief Given an axis, get the associated stick vector if applicable, and apply axis options.
 	 * \param axes The axes for the stick whose vector will be used.
@@ -102,11 +279,11 @@ private:
 	[[nodiscard]] float getAxisWithOptionsApplied(Ds4Axes_t axes, const InputAxisOptions& options) const;
 
 	/**
-	 * \brief Runs an input map with an optional parent modifier.
-	 * \param m The map to run.
+	 * \brief Runs a compiled binding with an optional parent modifier.
+	 * \param index Index of the binding in \c program.bindings.
 	 * \param modifier The parent modifier, if any.
 	 */
-	void runMap(const InputMap& m, InputModifier const* modifier);
+	void runBinding(uint32_t index, InputModifier const* modifier);
 
 public:
 	/**
@@ -126,13 +303,13 @@ private:
 	static PressedState getTouchRegionPressedState(const InputMap& m, InputModifier const* modifier, const Pressable& pressable);
 
 	/**
-	 * \brief Applies a map's state as determined by \sa runMap
-	 * \param m The mapping to apply.
+	 * \brief Applies a map's state as determined by \sa runBinding
+	 * \param index Index of the mapping in \c program.bindings.
 	 * \param modifier Parent modifier set, if any.
 	 * \param state The pressed state to apply, if applicable.
 	 * \param analog Analog value to apply, if applicable.
 	 */
-	void applyMap(const InputMap& m, InputModifier const* modifier, PressedState state, float analog);
+	void applyMap(uint32_t index, InputModifier const* modifier, PressedState state, float analog);
 
 	/**
 	 * \brief Simulates mouse inputs.
@@ -148,6 +325,20 @@ private:
 	 * \param state Pressed state to apply.
 	 */
 	void simulateKeyboard(const InputMap& m, PressedState state);
+
+	/**
+	 * \brief Queues the whole pixels of this tick's mouse motion and the XInput state,
+	 * then delivers everything output this tick to the sinks.
+	 */
+	void flushOutput();
+
+	/**
+	 * \brief Adds \p remainder to \p motion and splits off the whole pixels.
+	 * \param motion Motion on one axis this tick.
+	 * \param remainder Sub-pixel motion carried over; receives the new remainder.
+	 * \return Whole pixels to move by.
+	 */
+	static int takeWholePixels(float motion, float& remainder);
 	
 	/**
 	 * \brief Performs a special action, such as powering off wireless devices.
@@ -156,10 +347,90 @@ private:
 	void runAction(ActionType action) const;
 
 	/**
-	 * \brief Updates the delta time scale. Called by \sa startTick
+	 * \brief Reads the tick time and updates the delta time scale and fixed step count. Called by \sa startTick
 	 */
 	void updateDeltaTime();
 
+	/**
+	 * \brief Flags the modifier sets and bindings whose inputs changed since the last tick.
+	 * Bindings that have not settled were already flagged when they were last evaluated.
+	 */
+	void markChangedInputs();
+
+	/**
+	 * \brief Schedules a binding to be evaluated in the given generation.
+	 * \param index Index of the binding in \c program.bindings.
+	 * \param due \c generation for the current tick, or \c generation + 1 for the next.
+	 */
+	void markBinding(uint32_t index, uint32_t due);
+
+	/**
+	 * \brief Registers a rapid fire timer for every modifier set and binding that uses rapid fire.
+	 */
+	void addRapidFireTimers();
+
+	void removeRapidFireTimers();
+
+	/**
+	 * \brief Gets the expiry of a rapid fire timer that follows the one due at \p deadline.
+	 * Periods that were missed entirely, e.g. because the device loop stalled, are skipped
+	 * rather than fired back to back.
+	 */
+	[[nodiscard]] Stopwatch::TimePoint nextRapidFireDeadline(Stopwatch::TimePoint deadline, std::chrono::microseconds interval) const;
+
+	/**
+	 * \brief Starts the rapid fire cycle of a map once it becomes active, or stops it once it doesn't.
+	 * \param timer The rapid fire timer of \p map.
+	 * \param map The map that was just evaluated.
+	 */
+	void updateRapidFireTimer(TimerWheel::TimerId timer, const InputMapBase& map);
+
+	/**
+	 * \brief Adds an entry to or removes it from a latched list in constant time.
+	 * \param list \c latchedModifiers or \c latchedBindings
+	 * \param slots \c modifierLatchSlots or \c bindingLatchSlots
+	 * \param index The entry.
+	 * \param latched \c true if the entry should be in the list.
+	 */
+	static void updateLatch(std::vector<uint32_t>& list, std::vector<uint32_t>& slots, uint32_t index, bool latched);
+
+	/**
+	 * \brief Registers a playback timer for every binding that plays a macro.
+	 */
+	void addMacroTimers();
+
+	/**
+	 * \brief Stops every macro and unregisters the playback timers.
+	 * \sa stopMacro
+	 */
+	void removeMacroTimers();
+
+	/**
+	 * \brief Starts playing the macro of a binding from the time of the current tick.
+	 * Nothing happens if it is already playing.
+	 */
+	void startMacro(uint32_t index);
+
+	/**
+	 * \brief Emits every event of a binding's macro that is due by \p now, then schedules the next one.
+	 * \param index Index of the binding in \c program.bindings.
+	 * \param now The current tick time, or the deadline of the playback timer.
+	 */
+	void playMacro(uint32_t index, Stopwatch::TimePoint now);
+
+	/**
+	 * \brief Stops a binding's macro, emitting the key and button releases it has yet to play so that nothing stays held.
+	 */
+	void stopMacro(uint32_t index);
+
+	void emitMacroEvent(const MacroEvent& event);
+
+	/**
+	 * \brief Indicates if a map is fully released and produces no output,
+	 * and so only needs to be evaluated when its inputs change.
+	 */
+	static bool isSettled(const InputMapBase& map);
+
 	/**
 	 * \brief Updates the pressed states of all the managed modifier sets.
 	 */
@@ -173,7 +444,7 @@ private:
 	/**
 	 * \brief
 	 * Called at the start of a tick.
-	 * Resets any unwanted states from the last simulation tick.
+	 * Resets any unwanted states from the last simulation tick and runs the timers that have expired.
 	 */
 	void startTick();
 
@@ -185,8 +456,35 @@ public:
 	 */
 	void setRumble(float leftMotor, float rightMotor) const;
 
+	/**
+	 * \brief Redirects all simulated keyboard, mouse and XInput output to \p sink.
+	 * While a sink is set, no virtual XInput controller is connected and nothing is sent to the system.
+	 * Any keys or buttons held on the previous sink are forgotten, not released.
+	 * Must be set before \c applyProfile.
+	 * \param sink The sink to use, or \c nullptr to output to the system again.
+	 */
+	void setOutputSink(IOutputSink* sink);
+
+	/**
+	 * \brief Gets the timers of this device. They are advanced at the start of every tick,
+	 * and the device doesn't wait for input past the earliest deadline.
+	 * \sa nextDeadline
+	 */
+	TimerWheel& timers();
+
+	/**
+	 * \brief Time of the current tick. Timers should be scheduled relative to this rather than \c Stopwatch::now.
+	 */
+	[[nodiscard]] Stopwatch::TimePoint time() const;
+
+	/**
+	 * \brief Gets the time at which the next timer expires, or \c std::nullopt if none are scheduled.
+	 */
+	[[nodiscard]] std::optional<Stopwatch::TimePoint> nextDeadline() const;
+
 	/**
 	 * \brief Add a simulator to be tracked an updated each tick.
+	 * A simulator added while simulators are running is first updated in the same tick.
 	 * \param simulator The simulator to add.
 	 * \return \c true if the simulator is not already tracked.
 	 */
@@ -202,9 +500,15 @@ public:
 private:
 	/**
 	 * \brief Runs all tracked simulators for this tick.
+	 * Simulators using fixed steps are updated once per step due and then interpolated.
 	 */
 	void runSimulators();
 
+	/**
+	 * \brief Closes the gaps left by removed simulators, keeping the rest in order.
+	 */
+	void compactSimulators();
+
 public:
 	/**
 	 * \brief Runs all input maps managed by this instance.
@@ -212,13 +516,29 @@ public:
 	void runMaps();
 	
 	/**
-	 * \brief Runs all persistent input maps (e.g rapid fire) managed by this instance.
+	 * \brief Runs the latched input maps (e.g. rapid fire) managed by this instance.
+	 * Called when the device wakes without input, e.g. because a timer expired.
+	 * Costs nothing beyond the simulators while no map is latched.
 	 */
 	void runPersistent();
 
+	/**
+	 * \brief Indicates that simulators need to be run regularly, even when the device isn't sending any input.
+	 * Anything that only changes at a known time uses \c timers instead.
+	 * \sa runPersistent, nextDeadline
+	 */
+	[[nodiscard]] bool needsTick() const;
+
+	/**
+	 * \brief Wakes the parent device if it's waiting for input, e.g. because
+	 * a simulator's state was changed from another thread.
+	 */
+	void wake() const;
+
 private:
 	/**
-	 * \brief Runs all touch regions managed by this instance.
+	 * \brief Runs the touch regions under each touch point and those still holding a touch.
+	 * Regions that keep a touch even once it leaves their bounds are run first.
 	 * \sa updateTouchRegion
 	 */
 	void updateTouchRegions();
@@ -230,23 +550,25 @@ private:
 	 * \param point The point on the touch pad that \a sender was fired from.
 	 * \param disallow Buttons to disallow if a region does not allow overlap.
 	 */
-	void updateTouchRegion(Ds4TouchRegion& region, Ds4Buttons_t sender,
-	                       const Ds4Vector2& point, Ds4Buttons_t& disallow) const;
-	
+	void updateTouchRegion(Ds4TouchRegion& region, Ds4Buttons_t sender, const Ds4Vector2& point, Ds4Buttons_t& disallow) const;
+
 	/**
-	 * \brief Internal implementation of \sa updatePressedState
-	 * \param instance Input map whose state is to be updated.
-	 * \param press Press callback.
-	 * \param release Release callback.
+	 * \brief Indicates if \p region holds a touch that it keeps even outside its bounds.
 	 */
-	void updatePressedState(InputMapBase& instance, const std::function<void()>& press, const std::function<void()>& release);
+	static bool isLocked(const Ds4TouchRegion& region);
 
+	/**
+	 * \brief Indicates if \p region must be updated even when no touch point is over it.
+	 */
+	static bool isLive(const Ds4TouchRegion& region);
+	
 	/**
 	 * \brief Updates the pressed state of a modifier set and its managed child bindings.
-	 * \param modifier The modifier to update.
+	 * \param index Index of the modifier set in \c program.modifiers.
+	 * \param force Evaluate the modifier set and all of its bindings even if their inputs haven't changed.
 	 * \return \c true if the active state of the modifier has changed.
 	 */
-	bool updateModifierState(InputModifier& modifier);
+	bool updateModifierState(uint32_t index, bool force);
 
 	/**
 	 * \brief
@@ -255,12 +577,12 @@ private:
 	 * If provided, the parent \p modifier must be active for \p map to be activated.
 	 * Otherwise, the map's pressed state is made inactive.
 	 * 
-	 * \param map The map to update.
+	 * \param index Index of the map in \c program.bindings.
 	 * \param modifier The parent modifier set, if any.
 	 *
 	 * \return \c true if the pressed state of the map has changed.
 	 */
-	bool updateBindingState(InputMap& map, InputModifier* modifier);
+	bool updateBindingState(uint32_t index, InputModifier* modifier);
 
 	/**
 	 * \brief Connects a virtual XInput device to the system.
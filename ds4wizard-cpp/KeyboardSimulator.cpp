@@ -1,28 +1,42 @@
 #include "pch.h"
 #include <Windows.h>
 #include "KeyboardSimulator.h"
+#include "SendInputBuffer.h"
+
+KeyboardSimulator::KeyboardSimulator(SendInputBuffer* buffer)
+	: buffer(buffer)
+{
+}
 
 KeyboardSimulator::~KeyboardSimulator()
 {
-	for (auto keyCode : pressedKeys)
+	for (size_t keyCode = 0; keyCode < pressedKeys.size(); ++keyCode)
+	{
+		if (pressedKeys[keyCode])
+		{
+			keyUp(static_cast<int>(keyCode));
+		}
+	}
+
+	if (buffer != nullptr)
 	{
-		keyUp(keyCode);
+		buffer->flush();
 	}
 }
 
 void KeyboardSimulator::keyUp(int keyCode)
 {
-	pressedKeys.erase(keyCode);
+	pressedKeys.reset(static_cast<uint8_t>(keyCode));
 	press(keyCode, false);
 }
 
 void KeyboardSimulator::keyDown(int keyCode)
 {
-	pressedKeys.insert(keyCode);
+	pressedKeys.set(static_cast<uint8_t>(keyCode));
 	press(keyCode, true);
 }
 
-void KeyboardSimulator::press(int keyCode, bool down)
+void KeyboardSimulator::press(int keyCode, bool down) const
 {
 	INPUT input;
 
@@ -40,5 +54,12 @@ void KeyboardSimulator::press(int keyCode, bool down)
 		input.ki.dwFlags |= KEYEVENTF_KEYUP; // 0 indicates pressed
 	}
 
-	SendInput(1, &input, sizeof(INPUT));
+	if (buffer != nullptr)
+	{
+		buffer->add(input);
+	}
+	else
+	{
+		SendInput(1, &input, sizeof(INPUT));
+	}
 }
@@ -1,16 +1,28 @@
 #pragma once
 
-#include <unordered_set>
+#include <bitset>
+
+class SendInputBuffer;
 
 /**
  * \brief Object used for simulating keyboard input.
  */
 class KeyboardSimulator
 {
-	std::unordered_set<int> pressedKeys;
+	/**
+	 * \brief Keys pressed by this instance, indexed by virtual key code (which are one byte).
+	 */
+	std::bitset<256> pressedKeys;
+
+	SendInputBuffer* buffer = nullptr;
 
 public:
 	KeyboardSimulator() = default;
+
+	/**
+	 * \param buffer Buffer to queue key presses in, or \c nullptr to send them immediately.
+	 */
+	explicit KeyboardSimulator(SendInputBuffer* buffer);
 	KeyboardSimulator(KeyboardSimulator&&) = default;
 
 	~KeyboardSimulator();
@@ -41,8 +53,9 @@ public:
 
 	/**
 	 * \brief Presses or releases a key specified by \a keyCode.
+	 * The input is queued if this instance has a buffer.
 	 * \param keyCode The key code to press or release.
 	 * \param down If \c true, the key is pressed. If \c false, the key is released.
 	 */
-	static void press(int keyCode, bool down);
+	void press(int keyCode, bool down) const;
 };
@@ -0,0 +1,286 @@
+#include "pch.h"
+
+#include <charconv>
+#include <string_view>
+
+#include <fmt/format.h>
+
+#include "Macro.h"
+#include "RecordingOutputSink.h"
+
+using namespace std::chrono;
+
+namespace
+{
+	template <typename T>
+	T parseNumber(std::string_view text, int base = 10)
+	{
+		T value {};
+		const char* end = text.data() + text.size();
+		const auto result = std::from_chars(text.data(), end, value, base);
+
+		if (result.ec != std::errc() || result.ptr != end)
+		{
+			throw std::invalid_argument("malformed number in macro: " + std::string(text));
+		}
+
+		return value;
+	}
+
+	std::vector<std::string_view> split(std::string_view text, char separator)
+	{
+		std::vector<std::string_view> result;
+
+		for (size_t start = 0;;)
+		{
+			const size_t end = text.find(separator, start);
+
+			if (end == std::string_view::npos)
+			{
+				result.push_back(text.substr(start));
+				return result;
+			}
+
+			result.push_back(text.substr(start, end - start));
+			start = end + 1;
+		}
+	}
+
+	/**
+	 * \brief Parses the \c + or \c - that follows the type of a key or button token.
+	 */
+	bool parseDown(std::string_view token)
+	{
+		if (token.size() < 3 || (token[1] != '+' && token[1] != '-'))
+		{
+			throw std::invalid_argument("malformed macro token: " + std::string(token));
+		}
+
+		return token[1] == '+';
+	}
+
+	MacroEvent::Type toEventType(RecordedOutput::Type type)
+	{
+		switch (type)
+		{
+			case RecordedOutput::Type::keyboardKey:
+				return MacroEvent::Type::keyboardKey;
+
+			case RecordedOutput::Type::mouseButton:
+				return MacroEvent::Type::mouseButton;
+
+			case RecordedOutput::Type::mouseMove:
+				return MacroEvent::Type::mouseMove;
+
+			case RecordedOutput::Type::xinputState:
+				return MacroEvent::Type::xinputState;
+
+			default:
+				throw std::out_of_range("invalid RecordedOutput::Type");
+		}
+	}
+}
+
+bool MacroEvent::isRelease() const
+{
+	return (type == Type::keyboardKey || type == Type::mouseButton) && y == 0;
+}
+
+bool MacroEvent::operator==(const MacroEvent& other) const
+{
+	return time == other.time &&
+	       type == other.type &&
+	       x == other.x &&
+	       y == other.y &&
+	       xinput == other.xinput;
+}
+
+bool MacroEvent::operator!=(const MacroEvent& other) const
+{
+	return !(*this == other);
+}
+
+// static
+Macro Macro::fromRecording(const std::vector<RecordedOutput>& recording)
+{
+	Macro result;
+
+	if (recording.empty())
+	{
+		return result;
+	}
+
+	const nanoseconds start = recording.front().time;
+	result.events.reserve(recording.size());
+
+	for (const RecordedOutput& output : recording)
+	{
+		MacroEvent event {};
+		event.time   = duration_cast<microseconds>(output.time - start);
+		event.type   = toEventType(output.type);
+		event.x      = output.x;
+		event.y      = output.y;
+		event.xinput = output.xinput;
+
+		result.events.push_back(event);
+	}
+
+	return result;
+}
+
+// static
+Macro Macro::parse(const std::string& text)
+{
+	Macro result;
+	microseconds time {};
+
+	for (const std::string_view token : split(text, ' '))
+	{
+		if (token.empty())
+		{
+			continue;
+		}
+
+		const std::string_view arguments = token.substr(1);
+		MacroEvent event {};
+
+		switch (token[0])
+		{
+			case 'w':
+				time += microseconds(parseNumber<uint32_t>(arguments));
+				continue;
+
+			case 'k':
+				event.type = MacroEvent::Type::keyboardKey;
+				event.y    = parseDown(token) ? 1 : 0;
+				event.x    = parseNumber<uint8_t>(token.substr(2));
+				break;
+
+			case 'b':
+				event.type = MacroEvent::Type::mouseButton;
+				event.y    = parseDown(token) ? 1 : 0;
+				event.x    = MouseButton::_from_string(std::string(token.substr(2)).c_str())._to_integral();
+				break;
+
+			case 'm':
+			{
+				const auto values = split(arguments, ',');
+
+				if (values.size() != 2)
+				{
+					throw std::invalid_argument("malformed macro token: " + std::string(token));
+				}
+
+				event.type = MacroEvent::Type::mouseMove;
+				event.x    = parseNumber<int>(values[0]);
+				event.y    = parseNumber<int>(values[1]);
+				break;
+			}
+
+			case 'x':
+			{
+				const auto values = split(arguments, ',');
+
+				if (values.size() != 7)
+				{
+					throw std::invalid_argument("malformed macro token: " + std::string(token));
+				}
+
+				event.type = MacroEvent::Type::xinputState;
+
+				event.xinput.wButtons      = parseNumber<uint16_t>(values[0], 16);
+				event.xinput.bLeftTrigger  = parseNumber<uint8_t>(values[1]);
+				event.xinput.bRightTrigger = parseNumber<uint8_t>(values[2]);
+				event.xinput.sThumbLX      = parseNumber<int16_t>(values[3]);
+				event.xinput.sThumbLY      = parseNumber<int16_t>(values[4]);
+				event.xinput.sThumbRX      = parseNumber<int16_t>(values[5]);
+				event.xinput.sThumbRY      = parseNumber<int16_t>(values[6]);
+				break;
+			}
+
+			default:
+				throw std::invalid_argument("unknown macro token: " + std::string(token));
+		}
+
+		event.time = time;
+		result.events.push_back(event);
+	}
+
+	return result;
+}
+
+std::string Macro::toString() const
+{
+	std::string result;
+	microseconds time {};
+
+	const auto append = [&](const std::string& token)
+	{
+		if (!result.empty())
+		{
+			result += ' ';
+		}
+
+		result += token;
+	};
+
+	for (const MacroEvent& event : events)
+	{
+		if (event.time > time)
+		{
+			append(fmt::format("w{}", (event.time - time).count()));
+			time = event.time;
+		}
+
+		switch (event.type)
+		{
+			case MacroEvent::Type::keyboardKey:
+				append(fmt::format("k{}{}", event.y ? '+' : '-', event.x));
+				break;
+
+			case MacroEvent::Type::mouseButton:
+				append(fmt::format("b{}{}", event.y ? '+' : '-', MouseButton::_from_integral(event.x)._to_string()));
+				break;
+
+			case MacroEvent::Type::mouseMove:
+				append(fmt::format("m{},{}", event.x, event.y));
+				break;
+
+			case MacroEvent::Type::xinputState:
+				append(fmt::format("x{:X},{},{},{},{},{},{}",
+				                   event.xinput.wButtons, event.xinput.bLeftTrigger, event.xinput.bRightTrigger,
+				                   event.xinput.sThumbLX, event.xinput.sThumbLY, event.xinput.sThumbRX, event.xinput.sThumbRY));
+				break;
+
+			default:
+				throw std::out_of_range("invalid MacroEvent::Type");
+		}
+	}
+
+	return result;
+}
+
+microseconds Macro::duration() const
+{
+	return events.empty() ? microseconds::zero() : events.back().time;
+}
+
+bool Macro::operator==(const Macro& other) const
+{
+	return events == other.events;
+}
+
+bool Macro::operator!=(const Macro& other) const
+{
+	return !(*this == other);
+}
+
+void Macro::readJson(const nlohmann::json& json)
+{
+	*this = parse(json["events"].get<std::string>());
+}
+
+void Macro::writeJson(nlohmann::json& json) const
+{
+	json["events"] = toString();
+}
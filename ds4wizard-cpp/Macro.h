@@ -0,0 +1,101 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "JsonData.h"
+#include "XInputGamepad.h"
+
+struct RecordedOutput;
+
+/**
+ * \brief A single output event of a \c Macro.
+ */
+struct MacroEvent
+{
+	enum class Type : uint8_t
+	{
+		keyboardKey,
+		mouseButton,
+		mouseMove,
+		xinputState
+	};
+
+	/**
+	 * \brief Time of the event since the start of the macro.
+	 */
+	std::chrono::microseconds time {};
+
+	Type type = Type::keyboardKey;
+
+	/**
+	 * \brief The key code, the mouse button, or the X delta of a mouse move.
+	 */
+	int x = 0;
+
+	/**
+	 * \brief \c 1 if a key or button was pressed and \c 0 if released, or the Y delta of a mouse move.
+	 */
+	int y = 0;
+
+	XInputGamepad xinput {};
+
+	/**
+	 * \brief Indicates if the event releases a key or mouse button.
+	 */
+	[[nodiscard]] bool isRelease() const;
+
+	bool operator==(const MacroEvent& other) const;
+	bool operator!=(const MacroEvent& other) const;
+};
+
+/**
+ * \brief A recorded sequence of output events that a binding plays back with \c ActionType::macro.
+ *
+ * In a profile, the events are stored as a single string of space-separated tokens,
+ * e.g. \c "k+65 w50000 k-65" taps A for 50 milliseconds:
+ * - \c k+code and \c k-code press and release a keyboard key by virtual key code.
+ * - \c b+button and \c b-button press and release a mouse button by name.
+ * - \c mdx,dy moves the mouse.
+ * - \c xbuttons,lt,rt,lx,ly,rx,ry sets the XInput state; \c buttons is hexadecimal.
+ * - \c wus waits that many microseconds before the events that follow.
+ * \sa DeviceProfile::macros
+ */
+class Macro : public JsonData
+{
+public:
+	/**
+	 * \brief The events of the macro in order of time.
+	 */
+	std::vector<MacroEvent> events;
+
+	/**
+	 * \brief Builds a macro from output captured by a \c RecordingOutputSink.
+	 * Times are taken relative to the first event.
+	 */
+	static Macro fromRecording(const std::vector<RecordedOutput>& recording);
+
+	/**
+	 * \brief Parses the compact event string described above.
+	 * \throw std::invalid_argument if a token is malformed.
+	 */
+	static Macro parse(const std::string& text);
+
+	/**
+	 * \brief Formats the events as the compact event string described above.
+	 */
+	[[nodiscard]] std::string toString() const;
+
+	/**
+	 * \brief Time of the last event.
+	 */
+	[[nodiscard]] std::chrono::microseconds duration() const;
+
+	bool operator==(const Macro& other) const;
+	bool operator!=(const Macro& other) const;
+
+	void readJson(const nlohmann::json& json) override;
+	void writeJson(nlohmann::json& json) const override;
+};
@@ -1,28 +1,57 @@
 #include "pch.h"
 #include <Windows.h>
 #include "MouseSimulator.h"
+#include "SendInputBuffer.h"
+
+namespace
+{
+	void send(SendInputBuffer* buffer, INPUT& input)
+	{
+		if (buffer != nullptr)
+		{
+			buffer->add(input);
+		}
+		else
+		{
+			SendInput(1, &input, sizeof(INPUT));
+		}
+	}
+}
+
+MouseSimulator::MouseSimulator(SendInputBuffer* buffer)
+	: buffer(buffer)
+{
+}
 
 MouseSimulator::~MouseSimulator()
 {
-	for (auto button : pressedButtons)
+	for (size_t i = 0; i < pressedButtons.size(); ++i)
+	{
+		if (pressedButtons[i])
+		{
+			buttonUp(MouseButton::_from_index(i));
+		}
+	}
+
+	if (buffer != nullptr)
 	{
-		buttonUp(MouseButton::_from_integral(button));
+		buffer->flush();
 	}
 }
 
 void MouseSimulator::buttonUp(MouseButton button)
 {
-	pressedButtons.erase(button);
+	pressedButtons.reset(button._to_index());
 	press(button, false);
 }
 
 void MouseSimulator::buttonDown(MouseButton button)
 {
-	pressedButtons.insert(button);
+	pressedButtons.set(button._to_index());
 	press(button, true);
 }
 
-void MouseSimulator::moveBy(int dx, int dy)
+void MouseSimulator::moveBy(int dx, int dy) const
 {
 	INPUT input;
 
@@ -31,10 +60,10 @@ void MouseSimulator::moveBy(int dx, int dy)
 	input.mi.dx      = dx;
 	input.mi.dy      = dy;
 
-	SendInput(1, &input, sizeof(INPUT));
+	send(buffer, input);
 }
 
-void MouseSimulator::press(MouseButton button, bool down)
+void MouseSimulator::press(MouseButton button, bool down) const
 {
 	INPUT input;
 
@@ -68,5 +97,5 @@ void MouseSimulator::press(MouseButton button, bool down)
 			return;
 	}
 
-	SendInput(1, &input, sizeof(INPUT));
+	send(buffer, input);
 }
@@ -1,17 +1,29 @@
 #pragma once
 
-#include <unordered_set>
+#include <bitset>
 #include "enums.h"
 
+class SendInputBuffer;
+
 /**
  * \brief An object for simulating mouse input.
  */
 class MouseSimulator
 {
-	std::unordered_set<MouseButton::_integral> pressedButtons;
+	/**
+	 * \brief Buttons pressed by this instance, indexed by \c MouseButton value.
+	 */
+	std::bitset<MouseButton::_size()> pressedButtons;
+
+	SendInputBuffer* buffer = nullptr;
 
 public:
 	MouseSimulator() = default;
+
+	/**
+	 * \param buffer Buffer to queue input in, or \c nullptr to send it immediately.
+	 */
+	explicit MouseSimulator(SendInputBuffer* buffer);
 	MouseSimulator(MouseSimulator&&) = default;
 
 	~MouseSimulator();
@@ -42,15 +54,17 @@ public:
 
 	/**
 	 * \brief Moves the cursor relative to its current position.
+	 * The input is queued if this instance has a buffer.
 	 * \param dx X delta to move by, in pixels.
 	 * \param dy Y delta to move by, in pixels.
 	 */
-	static void moveBy(int dx, int dy);
+	void moveBy(int dx, int dy) const;
 
 	/**
 	 * \brief Presses or releases a mouse button.
+	 * The input is queued if this instance has a buffer.
 	 * \param button The button to press or release.
 	 * \param down If \c true, the button is pressed. If \c false, the button is released.
 	 */
-	static void press(MouseButton button, bool down);
+	void press(MouseButton button, bool down) const;
 };
@@ -0,0 +1,115 @@
+#include <stdexcept>
+
+#include "OutputBuffer.h"
+#include "IOutputSink.h"
+
+OutputBuffer::OutputBuffer()
+{
+	// enough for several bindings with modifier keys changing in the same tick;
+	// the buffer keeps whatever capacity it grows to.
+	events.reserve(32);
+}
+
+void OutputBuffer::keyboardKey(int keyCode, bool down)
+{
+	const auto index = static_cast<uint8_t>(keyCode);
+
+	if (keys[index] == down)
+	{
+		return;
+	}
+
+	keys[index] = down;
+	events.push_back({ Event::Type::keyboardKey, keyCode, down ? 1 : 0 });
+}
+
+void OutputBuffer::mouseButton(MouseButton button, bool down)
+{
+	const size_t index = button._to_index();
+
+	if (buttons[index] == down)
+	{
+		return;
+	}
+
+	buttons[index] = down;
+	events.push_back({ Event::Type::mouseButton, button._to_integral(), down ? 1 : 0 });
+}
+
+void OutputBuffer::mouseMove(int dx, int dy)
+{
+	if (dx == 0 && dy == 0)
+	{
+		return;
+	}
+
+	events.push_back({ Event::Type::mouseMove, dx, dy });
+}
+
+void OutputBuffer::xinputState(const XInputGamepad& state)
+{
+	xinput = state;
+	xinputPending = xinputPending || xinput != xinputSent;
+}
+
+void OutputBuffer::send(IOutputSink& sink) const
+{
+	for (const Event& event : events)
+	{
+		switch (event.type)
+		{
+			case Event::Type::keyboardKey:
+				sink.keyboardKey(event.x, event.y != 0);
+				break;
+
+			case Event::Type::mouseButton:
+				sink.mouseButton(MouseButton::_from_integral(event.x), event.y != 0);
+				break;
+
+			case Event::Type::mouseMove:
+				sink.mouseMove(event.x, event.y);
+				break;
+
+			default:
+				throw std::out_of_range("invalid OutputBuffer::Event::Type");
+		}
+	}
+
+	if (xinputPending)
+	{
+		sink.xinputState(xinput);
+	}
+
+	sink.flush();
+}
+
+void OutputBuffer::clear()
+{
+	events.clear();
+
+	if (xinputPending)
+	{
+		xinputSent = xinput;
+		xinputPending = false;
+	}
+}
+
+void OutputBuffer::resendXInput()
+{
+	xinputPending = true;
+}
+
+void OutputBuffer::reset()
+{
+	events.clear();
+	keys.reset();
+	buttons.reset();
+	xinput = {};
+	xinputSent = {};
+	xinputPending = false;
+}
+
+bool OutputBuffer::empty() const
+{
+	return events.empty() && !xinputPending;
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <bitset>
+#include <cstdint>
+#include <vector>
+
+#include "enums.h"
+#include "XInputGamepad.h"
+
+class IOutputSink;
+
+/**
+ * \brief Collects the simulated output of a tick so that it can be delivered to sinks in one go.
+ * Presses and releases that don't change the state of a key or button are dropped,
+ * and the gamepad state is only delivered when it differs from what was last delivered.
+ */
+class OutputBuffer
+{
+public:
+	struct Event
+	{
+		enum class Type : uint8_t
+		{
+			keyboardKey,
+			mouseButton,
+			mouseMove
+		};
+
+		Type type;
+
+		/**
+		 * \brief The key code, the mouse button, or the X delta of a mouse move.
+		 */
+		int x;
+
+		/**
+		 * \brief \c 1 if a key or button was pressed and \c 0 if released, or the Y delta of a mouse move.
+		 */
+		int y;
+	};
+
+private:
+	std::vector<Event> events;
+
+	/**
+	 * \brief State of every key and mouse button as of the last queued event.
+	 */
+	std::bitset<256> keys;
+	std::bitset<MouseButton::_size()> buttons;
+
+	XInputGamepad xinput {};
+	XInputGamepad xinputSent {};
+	bool xinputPending = false;
+
+public:
+	OutputBuffer();
+
+	/**
+	 * \brief Queues a key press or release, unless the key is already in that state.
+	 * \param keyCode Virtual key code of the key.
+	 * \param down \c true to press, \c false to release.
+	 */
+	void keyboardKey(int keyCode, bool down);
+
+	/**
+	 * \brief Queues a mouse button press or release, unless the button is already in that state.
+	 * \param button The button.
+	 * \param down \c true to press, \c false to release.
+	 */
+	void mouseButton(MouseButton button, bool down);
+
+	/**
+	 * \brief Queues relative mouse motion. Motion of zero is dropped.
+	 * \param dx X delta in pixels.
+	 * \param dy Y delta in pixels.
+	 */
+	void mouseMove(int dx, int dy);
+
+	/**
+	 * \brief Sets the state of the virtual XInput controller for this tick.
+	 * Only the last state set before \c clear is delivered, and only if it changed.
+	 * \param state The new state.
+	 */
+	void xinputState(const XInputGamepad& state);
+
+	/**
+	 * \brief Delivers every queued event to \p sink in order, followed by the gamepad state if it changed,
+	 * then calls \c IOutputSink::flush. May be called for several sinks before \c clear.
+	 */
+	void send(IOutputSink& sink) const;
+
+	/**
+	 * \brief Empties the buffer once it has been sent to every sink.
+	 */
+	void clear();
+
+	/**
+	 * \brief Forces the current gamepad state to be delivered with the next \c send,
+	 * e.g. once a virtual controller has been connected.
+	 */
+	void resendXInput();
+
+	/**
+	 * \brief Forgets all queued events and tracked state, e.g. when switching sinks.
+	 */
+	void reset();
+
+	[[nodiscard]] bool empty() const;
+};
@@ -0,0 +1,102 @@
+#include "pch.h"
+
+#include <fmt/format.h>
+
+#include "RecordingOutputSink.h"
+#include "Stopwatch.h"
+
+using namespace std::chrono;
+
+bool RecordedOutput::operator==(const RecordedOutput& other) const
+{
+	return time == other.time &&
+	       type == other.type &&
+	       x == other.x &&
+	       y == other.y &&
+	       xinput == other.xinput;
+}
+
+bool RecordedOutput::operator!=(const RecordedOutput& other) const
+{
+	return !(*this == other);
+}
+
+std::string RecordedOutput::toString() const
+{
+	const auto us = duration_cast<microseconds>(time).count();
+
+	switch (type)
+	{
+		case Type::keyboardKey:
+			return fmt::format("{} key {} {}", us, x, y ? "down" : "up");
+
+		case Type::mouseButton:
+			return fmt::format("{} mouse-button {} {}", us, MouseButton::_from_integral(x)._to_string(), y ? "down" : "up");
+
+		case Type::mouseMove:
+			return fmt::format("{} mouse-move {} {}", us, x, y);
+
+		case Type::xinputState:
+			return fmt::format("{} xinput {:04X} {} {} {} {} {} {}", us,
+			                   xinput.wButtons, xinput.bLeftTrigger, xinput.bRightTrigger,
+			                   xinput.sThumbLX, xinput.sThumbLY, xinput.sThumbRX, xinput.sThumbRY);
+
+		default:
+			throw std::out_of_range("invalid RecordedOutput::Type");
+	}
+}
+
+void RecordingOutputSink::keyboardKey(int keyCode, bool down)
+{
+	add(RecordedOutput::Type::keyboardKey, keyCode, down ? 1 : 0);
+}
+
+void RecordingOutputSink::mouseButton(MouseButton button, bool down)
+{
+	add(RecordedOutput::Type::mouseButton, button._to_integral(), down ? 1 : 0);
+}
+
+void RecordingOutputSink::mouseMove(int dx, int dy)
+{
+	add(RecordedOutput::Type::mouseMove, dx, dy);
+}
+
+void RecordingOutputSink::xinputState(const XInputGamepad& state)
+{
+	add(RecordedOutput::Type::xinputState, 0, 0);
+	events_.back().xinput = state;
+}
+
+const std::vector<RecordedOutput>& RecordingOutputSink::events() const
+{
+	return events_;
+}
+
+void RecordingOutputSink::clear()
+{
+	events_.clear();
+}
+
+std::string RecordingOutputSink::toText() const
+{
+	std::string result;
+
+	for (const RecordedOutput& event : events_)
+	{
+		result += event.toString();
+		result += '\n';
+	}
+
+	return result;
+}
+
+void RecordingOutputSink::add(RecordedOutput::Type type, int x, int y)
+{
+	RecordedOutput event {};
+	event.time = duration_cast<nanoseconds>(Stopwatch::now().time_since_epoch());
+	event.type = type;
+	event.x    = x;
+	event.y    = y;
+
+	events_.push_back(event);
+}
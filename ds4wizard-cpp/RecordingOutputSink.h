@@ -0,0 +1,75 @@
+#pragma once
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "IOutputSink.h"
+
+/**
+ * \brief A single event captured by \c RecordingOutputSink.
+ */
+struct RecordedOutput
+{
+	enum class Type
+	{
+		keyboardKey,
+		mouseButton,
+		mouseMove,
+		xinputState
+	};
+
+	/**
+	 * \brief \c Stopwatch time the event was produced at, relative to the clock's epoch.
+	 * Under a \c VirtualClock started at zero, this is the time into the replayed trace.
+	 */
+	std::chrono::nanoseconds time;
+
+	Type type;
+
+	/**
+	 * \brief The key code, the mouse button, or the X delta of a mouse move.
+	 */
+	int x = 0;
+
+	/**
+	 * \brief \c 1 if a key or button was pressed and \c 0 if released, or the Y delta of a mouse move.
+	 */
+	int y = 0;
+
+	XInputGamepad xinput {};
+
+	bool operator==(const RecordedOutput& other) const;
+	bool operator!=(const RecordedOutput& other) const;
+
+	/**
+	 * \brief Formats the event as a single line of text, e.g. \c "1250 key 65 down".
+	 * The time is in microseconds.
+	 */
+	[[nodiscard]] std::string toString() const;
+};
+
+/**
+ * \brief Keeps every event it receives in memory, for golden-output comparisons and tests.
+ */
+class RecordingOutputSink : public IOutputSink
+{
+	std::vector<RecordedOutput> events_;
+
+public:
+	void keyboardKey(int keyCode, bool down) override;
+	void mouseButton(MouseButton button, bool down) override;
+	void mouseMove(int dx, int dy) override;
+	void xinputState(const XInputGamepad& state) override;
+
+	[[nodiscard]] const std::vector<RecordedOutput>& events() const;
+	void clear();
+
+	/**
+	 * \brief All events formatted with \c RecordedOutput::toString, one per line.
+	 */
+	[[nodiscard]] std::string toText() const;
+
+private:
+	void add(RecordedOutput::Type type, int x, int y);
+};
@@ -5,33 +5,50 @@
 using namespace std::chrono;
 
 RumbleSequence::RumbleSequence(InputSimulator* parent)
-	: ISimulator(parent),
-	  currentElement(std::nullopt)
+	: ISimulator(parent)
 {
+	timer = parent->timers().add([this](Stopwatch::TimePoint deadline)
+	{
+		// the next element starts exactly when this one was due to end
+		if (++current < sequence.size())
+		{
+			startElement(deadline);
+		}
+	});
+}
+
+RumbleSequence::~RumbleSequence()
+{
+	parent->timers().remove(timer);
 }
 
 void RumbleSequence::update(float deltaTime)
 {
-	if (sequence.empty())
+	if (!playing)
 	{
-		deactivate(deltaTime);
-		return;
-	}
+		if (sequence.empty())
+		{
+			deactivate(deltaTime);
+			return;
+		}
 
-	const auto elapsed = stopwatch.elapsed();
+		playing = true;
+		current = 0;
+		startElement(parent->time());
+	}
 
-	if (!currentElement.has_value() ||
-	    elapsed >= milliseconds(currentElement->durationMilliseconds))
+	if (current >= sequence.size())
 	{
-		stopwatch.start();
-		currentElement = sequence.front();
-		sequence.pop();
+		deactivate(deltaTime);
+		return;
 	}
 
-	switch (currentElement.value().blending)
+	const RumbleSequenceElement& element = sequence[current];
+
+	switch (element.blending)
 	{
 		case RumbleSequenceBlending::none:
-			parent->setRumble(currentElement->leftMotor, currentElement->rightMotor);
+			parent->setRumble(element.leftMotor, element.rightMotor);
 			break;
 
 		case RumbleSequenceBlending::linear:
@@ -39,19 +56,21 @@ void RumbleSequence::update(float deltaTime)
 			float left  = 0.0f;
 			float right = 0.0f;
 
-			if (!sequence.empty())
+			if (current + 1 < sequence.size())
 			{
-				const auto& front = sequence.front();
+				const auto& next = sequence[current + 1];
 
-				left  = front.leftMotor;
-				right = front.rightMotor;
+				left  = next.leftMotor;
+				right = next.rightMotor;
 			}
 
-			int64_t elapsedMilliseconds = duration_cast<milliseconds>(elapsed).count();
-			double f = static_cast<double>(elapsedMilliseconds) / static_cast<double>(currentElement->durationMilliseconds);
+			const auto elapsed = parent->time() - elementStart;
+
+			const double f = std::clamp(duration<double, std::milli>(elapsed).count() / static_cast<double>(element.durationMilliseconds),
+			                            0.0, 1.0);
 
-			left  = gmath::lerp(currentElement->leftMotor, left, f);
-			right = gmath::lerp(currentElement->rightMotor, right, f);
+			left  = gmath::lerp(element.leftMotor, left, f);
+			right = gmath::lerp(element.rightMotor, right, f);
 
 			parent->setRumble(left, right);
 			break;
@@ -64,7 +83,38 @@ void RumbleSequence::update(float deltaTime)
 
 void RumbleSequence::add(const RumbleSequenceElement& element)
 {
-	sequence.push(element);
+	sequence.push_back(element);
+}
+
+bool RumbleSequence::needsTick() const
+{
+	if (state != SimulatorState::active)
+	{
+		return false;
+	}
+
+	// the first element starts from the time it is first updated
+	if (!playing)
+	{
+		return true;
+	}
+
+	return current < sequence.size() && sequence[current].blending == RumbleSequenceBlending::linear;
+}
+
+void RumbleSequence::startElement(Stopwatch::TimePoint start)
+{
+	elementStart = start;
+	parent->timers().schedule(timer, start + milliseconds(sequence[current].durationMilliseconds));
+}
+
+void RumbleSequence::onDeactivate(float deltaTime)
+{
+	parent->timers().cancel(timer);
+
+	sequence.clear();
+	current = 0;
+	playing = false;
 }
 
 RumbleTimer::RumbleTimer(InputSimulator* parent, Stopwatch::Duration duration, float left, float right)
@@ -73,16 +123,26 @@ RumbleTimer::RumbleTimer(InputSimulator* parent, Stopwatch::Duration duration, f
 	  left(left),
 	  right(right)
 {
+	timer = parent->timers().add([this](Stopwatch::TimePoint)
+	{
+		expired = true;
+	});
+}
+
+RumbleTimer::~RumbleTimer()
+{
+	parent->timers().remove(timer);
 }
 
 void RumbleTimer::reset()
 {
-	stopwatch.start();
+	expired = false;
+	parent->timers().schedule(timer, parent->time() + duration);
 }
 
 void RumbleTimer::update(float deltaTime)
 {
-	if (stopwatch.elapsed() >= duration)
+	if (expired)
 	{
 		deactivate(deltaTime);
 		return;
@@ -95,3 +155,13 @@ void RumbleTimer::onActivate(float deltaTime)
 {
 	reset();
 }
+
+bool RumbleTimer::needsTick() const
+{
+	return false;
+}
+
+void RumbleTimer::onDeactivate(float deltaTime)
+{
+	parent->timers().cancel(timer);
+}
@@ -1,10 +1,11 @@
 #pragma once
 
-#include <queue>
 #include <cstdint>
+#include <vector>
 
 #include "ISimulator.h"
 #include "Stopwatch.h"
+#include "TimerWheel.h"
 
 enum class RumbleSequenceBlending
 {
@@ -24,31 +25,71 @@ class InputSimulator;
 
 class RumbleSequence : public ISimulator
 {
-	std::queue<RumbleSequenceElement> sequence;
-	std::optional<RumbleSequenceElement> currentElement;
-	Stopwatch stopwatch;
+	std::vector<RumbleSequenceElement> sequence;
+	size_t current = 0;
+	bool playing = false;
+
+	/**
+	 * \brief When the current element started. Advanced to exactly each element's deadline
+	 * so that late ticks don't stretch the sequence.
+	 */
+	Stopwatch::TimePoint elementStart {};
+
+	/**
+	 * \brief Expires when the current element ends.
+	 */
+	TimerWheel::TimerId timer = TimerWheel::invalidTimer;
 
 public:
 	explicit RumbleSequence(InputSimulator* parent);
+	~RumbleSequence() override;
+
+	RumbleSequence(const RumbleSequence&) = delete;
+	RumbleSequence& operator=(const RumbleSequence&) = delete;
 
 	void update(float deltaTime) override;
 	void add(const RumbleSequenceElement& element);
+
+	/**
+	 * \brief Only a linear blend changes between the deadlines of its elements.
+	 */
+	[[nodiscard]] bool needsTick() const override;
+
+private:
+	void startElement(Stopwatch::TimePoint start);
+	void onDeactivate(float deltaTime) override;
 };
 
 class RumbleTimer : public ISimulator
 {
-	Stopwatch stopwatch;
+	TimerWheel::TimerId timer = TimerWheel::invalidTimer;
+	bool expired = false;
 
 public:
 	RumbleTimer(InputSimulator* parent, Stopwatch::Duration duration,
 	            float left, float right);
+	~RumbleTimer() override;
+
+	RumbleTimer(const RumbleTimer&) = delete;
+	RumbleTimer& operator=(const RumbleTimer&) = delete;
 
 	Stopwatch::Duration duration;
 	float left;
 	float right;
 
+	/**
+	 * \brief Restarts the timer from the time of the current tick.
+	 */
 	void reset();
 
 	void update(float deltaTime) override;
 	void onActivate(float deltaTime) override;
+
+	/**
+	 * \brief The rumble is constant, so the device only needs to wake when the timer expires.
+	 */
+	[[nodiscard]] bool needsTick() const override;
+
+private:
+	void onDeactivate(float deltaTime) override;
 };
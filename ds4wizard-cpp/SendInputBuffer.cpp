@@ -0,0 +1,30 @@
+#include "pch.h"
+#include "SendInputBuffer.h"
+
+SendInputBuffer::SendInputBuffer()
+{
+	// a tick rarely produces more than a handful of inputs;
+	// the buffer keeps whatever capacity it grows to.
+	inputs.reserve(32);
+}
+
+void SendInputBuffer::add(const INPUT& input)
+{
+	inputs.push_back(input);
+}
+
+void SendInputBuffer::flush()
+{
+	if (inputs.empty())
+	{
+		return;
+	}
+
+	SendInput(static_cast<UINT>(inputs.size()), inputs.data(), sizeof(INPUT));
+	inputs.clear();
+}
+
+bool SendInputBuffer::empty() const
+{
+	return inputs.empty();
+}
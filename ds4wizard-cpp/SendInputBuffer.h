@@ -0,0 +1,28 @@
+#pragma once
+
+#include <vector>
+#include <Windows.h>
+
+/**
+ * \brief Collects simulated keyboard and mouse input so that everything
+ * produced in a tick is submitted to the system with a single \c SendInput call.
+ */
+class SendInputBuffer
+{
+	std::vector<INPUT> inputs;
+
+public:
+	SendInputBuffer();
+
+	/**
+	 * \brief Queues an input to be sent on the next \c flush.
+	 */
+	void add(const INPUT& input);
+
+	/**
+	 * \brief Sends every queued input in the order it was added, then empties the buffer.
+	 */
+	void flush();
+
+	[[nodiscard]] bool empty() const;
+};
@@ -5,7 +5,9 @@ bool Settings::operator==(const Settings& rhs) const
 {
 	return preferredConnection == rhs.preferredConnection &&
 	       startMinimized      == rhs.startMinimized &&
-	       minimizeToTray      == rhs.minimizeToTray;
+	       minimizeToTray      == rhs.minimizeToTray &&
+	       deviceThreading     == rhs.deviceThreading &&
+	       captureTraces       == rhs.captureTraces;
 }
 
 bool Settings::operator!=(const Settings& rhs) const
@@ -29,6 +31,16 @@ void Settings::readJson(const nlohmann::json& json)
 	{
 		minimizeToTray = json["minimizeToTray"];
 	}
+
+	if (json.find("deviceThreading") != json.end())
+	{
+		deviceThreading = DeviceThreading::_from_string(json["deviceThreading"].get<std::string>().c_str());
+	}
+
+	if (json.find("captureTraces") != json.end())
+	{
+		captureTraces = json["captureTraces"];
+	}
 }
 
 void Settings::writeJson(nlohmann::json& json) const
@@ -36,4 +48,6 @@ void Settings::writeJson(nlohmann::json& json) const
 	json["preferredConnection"] = preferredConnection._to_string();
 	json["startMinimized"]      = startMinimized;
 	json["minimizeToTray"]      = minimizeToTray;
+	json["deviceThreading"]     = deviceThreading._to_string();
+	json["captureTraces"]       = captureTraces;
 }
@@ -1,5 +1,6 @@
 #pragma once
 #include "ConnectionType.h"
+#include "DeviceThreading.h"
 #include "JsonData.h"
 
 /**
@@ -25,6 +26,16 @@ struct Settings : JsonData
 	 */
 	bool minimizeToTray = true;
 
+	/**
+	 * \brief Specifies how device I/O is distributed across threads. Default is \c DeviceThreading::reactor
+	 */
+	DeviceThreading deviceThreading = DeviceThreading::reactor;
+
+	/**
+	 * \brief If \c true, every report from every device is captured to a trace file in \c Program::tracesPath.
+	 */
+	bool captureTraces = false;
+
 	Settings& operator=(const Settings& rhs) = default;
 	bool operator==(const Settings& rhs) const;
 	bool operator!=(const Settings& rhs) const;
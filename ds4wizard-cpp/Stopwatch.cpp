@@ -1,6 +1,11 @@
 #include "pch.h"
 #include "Stopwatch.h"
 
+namespace
+{
+	thread_local VirtualClock* currentClock = nullptr;
+}
+
 Stopwatch::Stopwatch(bool start_now)
 {
 	if (start_now)
@@ -12,19 +17,19 @@ Stopwatch::Stopwatch(bool start_now)
 void Stopwatch::start()
 {
 	running_ = true;
-	start_time_ = Clock::now();
+	start_time_ = now();
 }
 
 Stopwatch::Duration Stopwatch::stop()
 {
-	end_time_ = Clock::now();
+	end_time_ = now();
 	running_ = false;
 	return elapsed();
 }
 
 Stopwatch::Duration Stopwatch::elapsed() const
 {
-	return (running_ ? Clock::now() : end_time_) - start_time_;
+	return (running_ ? now() : end_time_) - start_time_;
 }
 
 bool Stopwatch::running() const
@@ -41,3 +46,40 @@ Stopwatch::TimePoint Stopwatch::end_time() const
 {
 	return end_time_;
 }
+
+Stopwatch::TimePoint Stopwatch::now()
+{
+	return currentClock != nullptr ? currentClock->now() : Clock::now();
+}
+
+VirtualClock::VirtualClock(Stopwatch::TimePoint start)
+	: previous(currentClock),
+	  time_(start)
+{
+	currentClock = this;
+}
+
+VirtualClock::~VirtualClock()
+{
+	currentClock = previous;
+}
+
+Stopwatch::TimePoint VirtualClock::now() const
+{
+	return time_;
+}
+
+void VirtualClock::set(Stopwatch::TimePoint value)
+{
+	time_ = value;
+}
+
+void VirtualClock::advance(Stopwatch::Duration amount)
+{
+	time_ += amount;
+}
+
+VirtualClock* VirtualClock::current()
+{
+	return currentClock;
+}
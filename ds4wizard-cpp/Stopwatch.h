@@ -24,4 +24,38 @@ public:
 	bool running() const;
 	[[nodiscard]] TimePoint start_time() const;
 	[[nodiscard]] TimePoint end_time() const;
+
+	/**
+	 * \brief The current time as seen by stopwatches on the calling thread.
+	 * This is \c Clock::now() unless a \c VirtualClock is active on the thread.
+	 * \sa VirtualClock
+	 */
+	[[nodiscard]] static TimePoint now();
+};
+
+/**
+ * \brief Replaces the time seen by every \c Stopwatch on the current thread for as long as it exists.
+ * This lets trace replay drive time-dependent behaviour (rapid fire, rumble, trackball, delta time)
+ * from recorded time stamps instead of the wall clock.
+ */
+class VirtualClock
+{
+	VirtualClock* previous;
+	Stopwatch::TimePoint time_;
+
+public:
+	explicit VirtualClock(Stopwatch::TimePoint start = {});
+	~VirtualClock();
+
+	VirtualClock(const VirtualClock&) = delete;
+	VirtualClock& operator=(const VirtualClock&) = delete;
+
+	[[nodiscard]] Stopwatch::TimePoint now() const;
+	void set(Stopwatch::TimePoint value);
+	void advance(Stopwatch::Duration amount);
+
+	/**
+	 * \brief The clock active on the calling thread, or \c nullptr if there isn't one.
+	 */
+	[[nodiscard]] static VirtualClock* current();
 };
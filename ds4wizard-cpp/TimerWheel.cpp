@@ -0,0 +1,395 @@
+#include "pch.h"
+
+#include <algorithm>
+#include <intrin.h>
+
+#include "TimerWheel.h"
+
+using namespace std::chrono;
+
+namespace
+{
+	size_t lowestBit(uint64_t mask)
+	{
+		unsigned long index;
+		_BitScanForward64(&index, mask);
+		return index;
+	}
+}
+
+TimerWheel::TimerWheel()
+{
+	heads.fill(invalidTimer);
+}
+
+TimerWheel::TimerId TimerWheel::add(Callback callback)
+{
+	TimerId id;
+
+	if (!freeTimers.empty())
+	{
+		id = freeTimers.back();
+		freeTimers.pop_back();
+	}
+	else
+	{
+		id = static_cast<TimerId>(timers.size());
+		timers.emplace_back();
+	}
+
+	timers[id].callback = std::move(callback);
+	return id;
+}
+
+void TimerWheel::remove(TimerId id)
+{
+	if (id == invalidTimer)
+	{
+		return;
+	}
+
+	cancel(id);
+	timers[id].callback = nullptr;
+	freeTimers.push_back(id);
+}
+
+void TimerWheel::schedule(TimerId id, TimePoint deadline)
+{
+	cancel(id);
+
+	Timer& timer = timers[id];
+	timer.deadline = deadline;
+	timer.tick = toTick(deadline, true);
+
+	++scheduledCount;
+
+	if (started)
+	{
+		place(id);
+	}
+	else
+	{
+		link(id, pendingList);
+	}
+}
+
+void TimerWheel::cancel(TimerId id)
+{
+	Timer& timer = timers[id];
+
+	switch (timer.list)
+	{
+		case unscheduled:
+			return;
+
+		case expiringList:
+			// it is skipped when its turn comes in advance
+			timer.list = unscheduled;
+			return;
+
+		default:
+			unlink(id);
+			--scheduledCount;
+			break;
+	}
+}
+
+bool TimerWheel::scheduled(TimerId id) const
+{
+	const uint16_t list = timers[id].list;
+	return list != unscheduled && list != expiringList;
+}
+
+bool TimerWheel::empty() const
+{
+	return scheduledCount == 0;
+}
+
+std::optional<TimerWheel::TimePoint> TimerWheel::nextDeadline() const
+{
+	if (heads[dueList] != invalidTimer)
+	{
+		return earliestDeadline(dueList);
+	}
+
+	if (heads[pendingList] != invalidTimer)
+	{
+		return earliestDeadline(pendingList);
+	}
+
+	// the slot of the next event holds the earliest timers; every other slot is further away
+	uint64_t tick;
+	const std::optional<uint16_t> list = nextEvent(tick);
+
+	if (!list.has_value())
+	{
+		return std::nullopt;
+	}
+
+	return earliestDeadline(*list);
+}
+
+void TimerWheel::advance(TimePoint now)
+{
+	const uint64_t target = toTick(now, false);
+
+	if (!started)
+	{
+		started = true;
+		currentTick = target;
+		cascade(pendingList);
+	}
+
+	uint64_t tick;
+
+	while (currentTick < target && nextEvent(tick).has_value() && tick <= target)
+	{
+		processTick(tick);
+	}
+
+	currentTick = std::max(currentTick, target);
+
+	if (heads[dueList] == invalidTimer)
+	{
+		return;
+	}
+
+	expiring.clear();
+
+	for (TimerId id = heads[dueList]; id != invalidTimer;)
+	{
+		Timer& timer = timers[id];
+
+		expiring.push_back(id);
+		scheduledCount--;
+
+		const TimerId next = timer.next;
+		timer.previous = invalidTimer;
+		timer.next     = invalidTimer;
+		timer.list     = expiringList;
+
+		id = next;
+	}
+
+	heads[dueList] = invalidTimer;
+
+	std::sort(expiring.begin(), expiring.end(), [&](TimerId a, TimerId b)
+	{
+		return timers[a].deadline < timers[b].deadline;
+	});
+
+	for (const TimerId id : expiring)
+	{
+		Timer& timer = timers[id];
+
+		// cancelled or rescheduled by an earlier callback
+		if (timer.list != expiringList)
+		{
+			continue;
+		}
+
+		timer.list = unscheduled;
+		timer.callback(timer.deadline);
+	}
+}
+
+// static
+uint64_t TimerWheel::toTick(TimePoint time, bool roundUp)
+{
+	const auto since = time.time_since_epoch();
+	const auto ticks = duration_cast<microseconds>(since);
+
+	if (ticks.count() <= 0)
+	{
+		return 0;
+	}
+
+	auto result = static_cast<uint64_t>(ticks.count());
+
+	if (roundUp && since > ticks)
+	{
+		++result;
+	}
+
+	return result;
+}
+
+// static
+uint16_t TimerWheel::slotList(size_t level, uint64_t tick)
+{
+	const size_t slot = (tick >> (slotBits * level)) & (slotCount - 1);
+	return static_cast<uint16_t>(level * slotCount + slot);
+}
+
+void TimerWheel::link(TimerId id, uint16_t list)
+{
+	Timer& timer = timers[id];
+
+	timer.list     = list;
+	timer.previous = invalidTimer;
+	timer.next     = heads[list];
+
+	if (timer.next != invalidTimer)
+	{
+		timers[timer.next].previous = id;
+	}
+
+	heads[list] = id;
+
+	if (list < dueList)
+	{
+		occupied[list / slotCount] |= uint64_t(1) << (list % slotCount);
+	}
+}
+
+void TimerWheel::unlink(TimerId id)
+{
+	Timer& timer = timers[id];
+	const uint16_t list = timer.list;
+
+	if (timer.previous != invalidTimer)
+	{
+		timers[timer.previous].next = timer.next;
+	}
+	else
+	{
+		heads[list] = timer.next;
+	}
+
+	if (timer.next != invalidTimer)
+	{
+		timers[timer.next].previous = timer.previous;
+	}
+
+	if (list < dueList && heads[list] == invalidTimer)
+	{
+		occupied[list / slotCount] &= ~(uint64_t(1) << (list % slotCount));
+	}
+
+	timer.previous = invalidTimer;
+	timer.next     = invalidTimer;
+	timer.list     = unscheduled;
+}
+
+void TimerWheel::place(TimerId id)
+{
+	const uint64_t tick = timers[id].tick;
+
+	if (tick <= currentTick)
+	{
+		link(id, dueList);
+		return;
+	}
+
+	// the level is that of the highest digit the deadline and the current tick differ in,
+	// so the timer is cascaded down exactly when the wheel reaches that digit
+	const uint64_t difference = tick ^ currentTick;
+	size_t level = 0;
+
+	while (level < levelCount && (difference >> (slotBits * (level + 1))) != 0)
+	{
+		++level;
+	}
+
+	if (level == levelCount)
+	{
+		link(id, overflowList);
+		return;
+	}
+
+	link(id, slotList(level, tick));
+}
+
+void TimerWheel::cascade(uint16_t list)
+{
+	TimerId id = heads[list];
+
+	if (id == invalidTimer)
+	{
+		return;
+	}
+
+	heads[list] = invalidTimer;
+
+	if (list < dueList)
+	{
+		occupied[list / slotCount] &= ~(uint64_t(1) << (list % slotCount));
+	}
+
+	while (id != invalidTimer)
+	{
+		const TimerId next = timers[id].next;
+		place(id);
+		id = next;
+	}
+}
+
+std::optional<uint16_t> TimerWheel::nextEvent(uint64_t& tick) const
+{
+	// a level's occupied slots are always ahead of the current tick in its current rotation,
+	// and anything on a lower level comes before anything on a higher one
+	for (size_t level = 0; level < levelCount; ++level)
+	{
+		const size_t shift = slotBits * level;
+		const size_t index = (currentTick >> shift) & (slotCount - 1);
+
+		const uint64_t ahead = index + 1 < slotCount ? occupied[level] & (~uint64_t(0) << (index + 1)) : 0;
+
+		if (ahead == 0)
+		{
+			continue;
+		}
+
+		const size_t slot = lowestBit(ahead);
+		const uint64_t rotation = (currentTick >> (shift + slotBits)) << (shift + slotBits);
+
+		tick = rotation | (static_cast<uint64_t>(slot) << shift);
+		return static_cast<uint16_t>(level * slotCount + slot);
+	}
+
+	if (heads[overflowList] != invalidTimer)
+	{
+		constexpr size_t shift = slotBits * levelCount;
+		tick = ((currentTick >> shift) + 1) << shift;
+		return overflowList;
+	}
+
+	return std::nullopt;
+}
+
+TimerWheel::TimePoint TimerWheel::earliestDeadline(uint16_t list) const
+{
+	TimePoint result = TimePoint::max();
+
+	for (TimerId id = heads[list]; id != invalidTimer; id = timers[id].next)
+	{
+		result = std::min(result, timers[id].deadline);
+	}
+
+	return result;
+}
+
+void TimerWheel::processTick(uint64_t tick)
+{
+	currentTick = tick;
+
+	constexpr uint64_t rotationMask = (uint64_t(1) << (slotBits * levelCount)) - 1;
+
+	if ((tick & rotationMask) == 0)
+	{
+		cascade(overflowList);
+	}
+
+	for (size_t level = levelCount - 1; level > 0; --level)
+	{
+		const uint64_t mask = (uint64_t(1) << (slotBits * level)) - 1;
+
+		if ((tick & mask) == 0)
+		{
+			cascade(slotList(level, tick));
+		}
+	}
+
+	// everything in this slot is due now, so it all lands in the due list
+	cascade(slotList(0, tick));
+}
@@ -0,0 +1,162 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <vector>
+
+#include "Stopwatch.h"
+
+/**
+ * \brief A hierarchical timing wheel with a resolution of one microsecond.
+ * Timers are bucketed by how far away their deadline is, so scheduling, cancelling
+ * and expiring a timer are constant time, and time can be advanced by any amount
+ * at a cost proportional to the number of buckets that are actually occupied.
+ * Timers are registered once and can then be scheduled any number of times without allocating.
+ * \sa InputSimulator::timers
+ */
+class TimerWheel
+{
+public:
+	using TimePoint = Stopwatch::TimePoint;
+	using TimerId   = uint32_t;
+
+	/**
+	 * \brief Called when a timer expires.
+	 * The timer may be scheduled again from its own callback, e.g. one period after \p deadline.
+	 */
+	using Callback = std::function<void(TimePoint deadline)>;
+
+	static constexpr TimerId invalidTimer = std::numeric_limits<TimerId>::max();
+
+	static constexpr size_t slotBits   = 6;
+	static constexpr size_t slotCount  = 1 << slotBits;
+	static constexpr size_t levelCount = 6;
+
+private:
+	static constexpr uint16_t unscheduled  = std::numeric_limits<uint16_t>::max();
+	static constexpr uint16_t dueList      = levelCount * slotCount;
+	static constexpr uint16_t overflowList = dueList + 1;
+	static constexpr uint16_t pendingList  = dueList + 2;
+	static constexpr uint16_t expiringList = dueList + 3;
+	static constexpr size_t   listCount    = pendingList + 1;
+
+	struct Timer
+	{
+		Callback callback;
+		TimePoint deadline {};
+		uint64_t tick = 0;
+		TimerId previous = invalidTimer;
+		TimerId next = invalidTimer;
+
+		/**
+		 * \brief The list the timer is linked into, or \c unscheduled.
+		 */
+		uint16_t list = unscheduled;
+	};
+
+	/**
+	 * \brief Every registered timer by ID. A deque so that callbacks may register timers while they run.
+	 */
+	std::deque<Timer> timers;
+	std::vector<TimerId> freeTimers;
+
+	/**
+	 * \brief First timer of each slot of each level, followed by the due, overflow and pending lists.
+	 */
+	std::array<TimerId, listCount> heads {};
+
+	/**
+	 * \brief Bitset of the occupied slots of each level.
+	 */
+	std::array<uint64_t, levelCount> occupied {};
+
+	/**
+	 * \brief Timers expiring in the current call to \c advance. Kept as a member only to reuse its storage.
+	 */
+	std::vector<TimerId> expiring;
+
+	bool started = false;
+	uint64_t currentTick = 0;
+	size_t scheduledCount = 0;
+
+public:
+	TimerWheel();
+
+	TimerWheel(const TimerWheel&) = delete;
+	TimerWheel& operator=(const TimerWheel&) = delete;
+
+	/**
+	 * \brief Registers a timer. It does nothing until it is scheduled.
+	 * \return The ID of the timer, which stays valid until \c remove is called with it.
+	 */
+	TimerId add(Callback callback);
+
+	/**
+	 * \brief Cancels and unregisters a timer. Removing \c invalidTimer does nothing.
+	 */
+	void remove(TimerId id);
+
+	/**
+	 * \brief Schedules a timer to expire at \p deadline, replacing its current deadline if it has one.
+	 * A deadline that has already passed expires on the next call to \c advance.
+	 */
+	void schedule(TimerId id, TimePoint deadline);
+
+	/**
+	 * \brief Cancels a timer if it's scheduled.
+	 */
+	void cancel(TimerId id);
+
+	[[nodiscard]] bool scheduled(TimerId id) const;
+
+	/**
+	 * \brief Indicates if no timer is scheduled.
+	 */
+	[[nodiscard]] bool empty() const;
+
+	/**
+	 * \brief Gets the earliest deadline of every scheduled timer, or \c std::nullopt if none are.
+	 */
+	[[nodiscard]] std::optional<TimePoint> nextDeadline() const;
+
+	/**
+	 * \brief Advances the wheel to \p now and runs the callback of every timer that expired, in order of expiry.
+	 * The first call sets the time the wheel starts at; time never goes backwards.
+	 */
+	void advance(TimePoint now);
+
+private:
+	static uint64_t toTick(TimePoint time, bool roundUp);
+	static uint16_t slotList(size_t level, uint64_t tick);
+
+	void link(TimerId id, uint16_t list);
+	void unlink(TimerId id);
+
+	/**
+	 * \brief Links a timer into the list for its tick relative to \c currentTick.
+	 */
+	void place(TimerId id);
+
+	/**
+	 * \brief Re-places every timer of a list, e.g. when the wheel reaches the slot they were waiting in.
+	 */
+	void cascade(uint16_t list);
+
+	/**
+	 * \brief Finds the next tick after \c currentTick at which a slot must be cascaded or expired.
+	 * \param tick Receives the tick.
+	 * \return The list that must be cascaded or expired at \p tick, or \c std::nullopt if none are scheduled.
+	 */
+	std::optional<uint16_t> nextEvent(uint64_t& tick) const;
+
+	[[nodiscard]] TimePoint earliestDeadline(uint16_t list) const;
+
+	/**
+	 * \brief Moves the wheel to \p tick, cascading slots it reaches and moving expired timers to the due list.
+	 */
+	void processTick(uint64_t tick);
+};
@@ -155,12 +155,33 @@ TrackballSimulator::TrackballState TrackballSimulator::applyDirectionalForce(boo
 	return result;
 }
 
+Vector2 TrackballSimulator::interpolatedVelocity() const
+{
+	return Vector2::lerp(previousVelocity, velocity, alpha);
+}
+
 void TrackballSimulator::update(float deltaTime)
 {
+	previousVelocity = velocity;
 	simulate(deltaTime, Ds4Buttons::touch1);
 	//simulate(deltaTime, Ds4Buttons::touch2);
 }
 
+bool TrackballSimulator::needsTick() const
+{
+	return state == SimulatorState::active && rolling();
+}
+
+bool TrackballSimulator::fixedStep() const
+{
+	return true;
+}
+
+void TrackballSimulator::interpolate(float alpha)
+{
+	this->alpha = alpha;
+}
+
 void TrackballSimulator::accelerate(const Vector2& direction, float factor, float deltaTime)
 {
 	const float m = settings.ballSpeed * settings.touchFriction * factor * deltaTime;
@@ -210,10 +231,9 @@ void TrackballSimulator::decelerate(float deltaTime)
 	velocity = Vector2::clamp(velocity, -settings.ballSpeed, settings.ballSpeed);
 }
 
-template <ptrdiff_t N>
-void selectPoints(const circular_buffer<Ds4TouchHistory, N>& points,
-                  std::optional<Ds4TouchHistory>& newest,
-                  std::optional<Ds4TouchHistory>& oldest)
+static void selectPoints(const Ds4TouchHistoryView& points,
+                         std::optional<Ds4TouchHistory>& newest,
+                         std::optional<Ds4TouchHistory>& oldest)
 {
 	newest = points.newest();
 	oldest = points.oldest();
@@ -49,6 +49,12 @@ public:
 	Vector2 velocity {};
 	[[nodiscard]] bool rolling() const;
 
+	/**
+	 * \brief The velocity of the ball at the current time, interpolated between the last two fixed steps.
+	 * This is what outputs driven by the ball should read.
+	 */
+	[[nodiscard]] Vector2 interpolatedVelocity() const;
+
 	/**
 	 * \brief Indicates the state of the emulated trackball.
 	 */
@@ -84,7 +90,22 @@ public:
 	 */
 	void update(float deltaTime) override;
 
+	/**
+	 * \brief The ball only needs to be simulated between input reports while it's rolling.
+	 */
+	[[nodiscard]] bool needsTick() const override;
+
+	/**
+	 * \brief The ball is simulated in fixed steps so that it rolls the same at any report rate.
+	 */
+	[[nodiscard]] bool fixedStep() const override;
+
+	void interpolate(float alpha) override;
+
 private:
+	Vector2 previousVelocity {};
+	float alpha = 1.0f;
+
 	/** \brief Accelerate the ball! */
 	void accelerate(const Vector2& direction, float factor, float deltaTime);
 	/** \brief Assume ball is being touched and slow the ball to a stop. */
@@ -0,0 +1,400 @@
+// Built without the precompiled header, which is Windows-only.
+#ifdef __linux__
+
+#include <fcntl.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+#include <linux/uinput.h>
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <stdexcept>
+
+#include "UinputOutputSink.h"
+
+namespace
+{
+	constexpr uint16_t vendorId = 0x045E;
+
+	/**
+	 * \brief Product IDs of an Xbox 360 controller, so games pick a sensible layout,
+	 * and of an arbitrary keyboard and mouse.
+	 */
+	constexpr uint16_t gamepadProductId  = 0x028E;
+	constexpr uint16_t keyboardProductId = 0xD540;
+
+	/**
+	 * \brief Maps Windows virtual key codes to Linux key codes; \c KEY_RESERVED where there is none.
+	 */
+	std::array<uint16_t, 256> makeKeyMap()
+	{
+		std::array<uint16_t, 256> map {};
+
+		constexpr std::array<uint16_t, 26> letters = {
+			KEY_A, KEY_B, KEY_C, KEY_D, KEY_E, KEY_F, KEY_G, KEY_H, KEY_I, KEY_J, KEY_K, KEY_L, KEY_M,
+			KEY_N, KEY_O, KEY_P, KEY_Q, KEY_R, KEY_S, KEY_T, KEY_U, KEY_V, KEY_W, KEY_X, KEY_Y, KEY_Z
+		};
+
+		constexpr std::array<uint16_t, 10> digits = {
+			KEY_0, KEY_1, KEY_2, KEY_3, KEY_4, KEY_5, KEY_6, KEY_7, KEY_8, KEY_9
+		};
+
+		constexpr std::array<uint16_t, 10> numpad = {
+			KEY_KP0, KEY_KP1, KEY_KP2, KEY_KP3, KEY_KP4, KEY_KP5, KEY_KP6, KEY_KP7, KEY_KP8, KEY_KP9
+		};
+
+		constexpr std::array<uint16_t, 12> functionKeys = {
+			KEY_F1, KEY_F2, KEY_F3, KEY_F4, KEY_F5, KEY_F6, KEY_F7, KEY_F8, KEY_F9, KEY_F10, KEY_F11, KEY_F12
+		};
+
+		for (size_t i = 0; i < letters.size(); ++i)
+		{
+			map['A' + i] = letters[i];
+		}
+
+		for (size_t i = 0; i < digits.size(); ++i)
+		{
+			map['0' + i] = digits[i];
+			map[0x60 + i] = numpad[i];
+		}
+
+		for (size_t i = 0; i < functionKeys.size(); ++i)
+		{
+			map[0x70 + i] = functionKeys[i];
+		}
+
+		map[0x08] = KEY_BACKSPACE;
+		map[0x09] = KEY_TAB;
+		map[0x0D] = KEY_ENTER;
+		map[0x10] = KEY_LEFTSHIFT;
+		map[0x11] = KEY_LEFTCTRL;
+		map[0x12] = KEY_LEFTALT;
+		map[0x13] = KEY_PAUSE;
+		map[0x14] = KEY_CAPSLOCK;
+		map[0x1B] = KEY_ESC;
+		map[0x20] = KEY_SPACE;
+		map[0x21] = KEY_PAGEUP;
+		map[0x22] = KEY_PAGEDOWN;
+		map[0x23] = KEY_END;
+		map[0x24] = KEY_HOME;
+		map[0x25] = KEY_LEFT;
+		map[0x26] = KEY_UP;
+		map[0x27] = KEY_RIGHT;
+		map[0x28] = KEY_DOWN;
+		map[0x2C] = KEY_SYSRQ;
+		map[0x2D] = KEY_INSERT;
+		map[0x2E] = KEY_DELETE;
+		map[0x5B] = KEY_LEFTMETA;
+		map[0x5C] = KEY_RIGHTMETA;
+		map[0x5D] = KEY_COMPOSE;
+		map[0x6A] = KEY_KPASTERISK;
+		map[0x6B] = KEY_KPPLUS;
+		map[0x6D] = KEY_KPMINUS;
+		map[0x6E] = KEY_KPDOT;
+		map[0x6F] = KEY_KPSLASH;
+		map[0x90] = KEY_NUMLOCK;
+		map[0x91] = KEY_SCROLLLOCK;
+		map[0xA0] = KEY_LEFTSHIFT;
+		map[0xA1] = KEY_RIGHTSHIFT;
+		map[0xA2] = KEY_LEFTCTRL;
+		map[0xA3] = KEY_RIGHTCTRL;
+		map[0xA4] = KEY_LEFTALT;
+		map[0xA5] = KEY_RIGHTALT;
+		map[0xAD] = KEY_MUTE;
+		map[0xAE] = KEY_VOLUMEDOWN;
+		map[0xAF] = KEY_VOLUMEUP;
+		map[0xB0] = KEY_NEXTSONG;
+		map[0xB1] = KEY_PREVIOUSSONG;
+		map[0xB2] = KEY_STOPCD;
+		map[0xB3] = KEY_PLAYPAUSE;
+		map[0xBA] = KEY_SEMICOLON;
+		map[0xBB] = KEY_EQUAL;
+		map[0xBC] = KEY_COMMA;
+		map[0xBD] = KEY_MINUS;
+		map[0xBE] = KEY_DOT;
+		map[0xBF] = KEY_SLASH;
+		map[0xC0] = KEY_GRAVE;
+		map[0xDB] = KEY_LEFTBRACE;
+		map[0xDC] = KEY_BACKSLASH;
+		map[0xDD] = KEY_RIGHTBRACE;
+		map[0xDE] = KEY_APOSTROPHE;
+
+		return map;
+	}
+
+	const std::array<uint16_t, 256> keyMap = makeKeyMap();
+
+	struct GamepadButton
+	{
+		XInputButtons_t button;
+		uint16_t code;
+	};
+
+	constexpr std::array<GamepadButton, 11> gamepadButtons = {{
+		{ XInputButtons::a,             BTN_A },
+		{ XInputButtons::b,             BTN_B },
+		{ XInputButtons::x,             BTN_X },
+		{ XInputButtons::y,             BTN_Y },
+		{ XInputButtons::leftShoulder,  BTN_TL },
+		{ XInputButtons::rightShoulder, BTN_TR },
+		{ XInputButtons::back,          BTN_SELECT },
+		{ XInputButtons::start,         BTN_START },
+		{ XInputButtons::guide,         BTN_MODE },
+		{ XInputButtons::leftThumb,     BTN_THUMBL },
+		{ XInputButtons::rightThumb,    BTN_THUMBR }
+	}};
+
+	uint16_t toLinuxButton(MouseButton button)
+	{
+		switch (button)
+		{
+			case MouseButton::left:
+				return BTN_LEFT;
+
+			case MouseButton::right:
+				return BTN_RIGHT;
+
+			case MouseButton::middle:
+				return BTN_MIDDLE;
+
+			case MouseButton::ex1:
+				return BTN_SIDE;
+
+			case MouseButton::ex2:
+				return BTN_EXTRA;
+
+			default:
+				throw std::out_of_range("invalid MouseButton");
+		}
+	}
+
+	/**
+	 * \brief XInput's Y axes point up; evdev's point down.
+	 */
+	int32_t invertAxis(int16_t value)
+	{
+		return -std::max<int32_t>(value, -32767);
+	}
+
+	int32_t hatAxis(XInputButtons_t buttons, XInputButtons_t negative, XInputButtons_t positive)
+	{
+		return (buttons & positive ? 1 : 0) - (buttons & negative ? 1 : 0);
+	}
+
+	bool setAbs(int fd, uint16_t code, int32_t minimum, int32_t maximum, int32_t fuzz, int32_t flat)
+	{
+		uinput_abs_setup setup {};
+		setup.code = code;
+		setup.absinfo.minimum = minimum;
+		setup.absinfo.maximum = maximum;
+		setup.absinfo.fuzz    = fuzz;
+		setup.absinfo.flat    = flat;
+
+		return ioctl(fd, UI_ABS_SETUP, &setup) == 0;
+	}
+
+	bool createDevice(int fd, const char* name, uint16_t productId)
+	{
+		uinput_setup setup {};
+		setup.id.bustype = BUS_VIRTUAL;
+		setup.id.vendor  = vendorId;
+		setup.id.product = productId;
+		std::strncpy(setup.name, name, UINPUT_MAX_NAME_SIZE - 1);
+
+		return ioctl(fd, UI_DEV_SETUP, &setup) == 0 && ioctl(fd, UI_DEV_CREATE) == 0;
+	}
+}
+
+UinputOutputSink::UinputOutputSink()
+	: keyboardFd(createKeyboard()),
+	  gamepadFd(createGamepad())
+{
+	keyboardEvents.reserve(32);
+	gamepadEvents.reserve(32);
+}
+
+UinputOutputSink::~UinputOutputSink()
+{
+	// destroying a device releases anything still held on it
+	destroy(keyboardFd);
+	destroy(gamepadFd);
+}
+
+bool UinputOutputSink::isOpen() const
+{
+	return keyboardFd >= 0 && gamepadFd >= 0;
+}
+
+void UinputOutputSink::keyboardKey(int keyCode, bool down)
+{
+	const uint16_t code = keyMap[static_cast<uint8_t>(keyCode)];
+
+	if (code != KEY_RESERVED)
+	{
+		add(keyboardEvents, EV_KEY, code, down ? 1 : 0);
+	}
+}
+
+void UinputOutputSink::mouseButton(MouseButton button, bool down)
+{
+	add(keyboardEvents, EV_KEY, toLinuxButton(button), down ? 1 : 0);
+}
+
+void UinputOutputSink::mouseMove(int dx, int dy)
+{
+	if (dx != 0)
+	{
+		add(keyboardEvents, EV_REL, REL_X, dx);
+	}
+
+	if (dy != 0)
+	{
+		add(keyboardEvents, EV_REL, REL_Y, dy);
+	}
+}
+
+void UinputOutputSink::xinputState(const XInputGamepad& state)
+{
+	const XInputButtons_t buttons = state.wButtons;
+
+	for (const GamepadButton& b : gamepadButtons)
+	{
+		add(gamepadEvents, EV_KEY, b.code, buttons & b.button ? 1 : 0);
+	}
+
+	add(gamepadEvents, EV_ABS, ABS_HAT0X, hatAxis(buttons, XInputButtons::dPadLeft, XInputButtons::dPadRight));
+	add(gamepadEvents, EV_ABS, ABS_HAT0Y, hatAxis(buttons, XInputButtons::dPadUp, XInputButtons::dPadDown));
+
+	add(gamepadEvents, EV_ABS, ABS_X, state.sThumbLX);
+	add(gamepadEvents, EV_ABS, ABS_Y, invertAxis(state.sThumbLY));
+	add(gamepadEvents, EV_ABS, ABS_RX, state.sThumbRX);
+	add(gamepadEvents, EV_ABS, ABS_RY, invertAxis(state.sThumbRY));
+	add(gamepadEvents, EV_ABS, ABS_Z, state.bLeftTrigger);
+	add(gamepadEvents, EV_ABS, ABS_RZ, state.bRightTrigger);
+}
+
+void UinputOutputSink::flush()
+{
+	submit(keyboardFd, keyboardEvents);
+	submit(gamepadFd, gamepadEvents);
+}
+
+int UinputOutputSink::createKeyboard()
+{
+	const int fd = open("/dev/uinput", O_WRONLY | O_NONBLOCK | O_CLOEXEC);
+
+	if (fd < 0)
+	{
+		return -1;
+	}
+
+	bool ok = ioctl(fd, UI_SET_EVBIT, EV_KEY) == 0 &&
+	          ioctl(fd, UI_SET_EVBIT, EV_REL) == 0 &&
+	          ioctl(fd, UI_SET_RELBIT, REL_X) == 0 &&
+	          ioctl(fd, UI_SET_RELBIT, REL_Y) == 0;
+
+	for (const uint16_t code : keyMap)
+	{
+		if (code != KEY_RESERVED)
+		{
+			ok = ok && ioctl(fd, UI_SET_KEYBIT, code) == 0;
+		}
+	}
+
+	for (const MouseButton button : MouseButton::_values())
+	{
+		ok = ok && ioctl(fd, UI_SET_KEYBIT, toLinuxButton(button)) == 0;
+	}
+
+	if (!ok || !createDevice(fd, "ds4wizard keyboard and mouse", keyboardProductId))
+	{
+		close(fd);
+		return -1;
+	}
+
+	return fd;
+}
+
+int UinputOutputSink::createGamepad()
+{
+	const int fd = open("/dev/uinput", O_WRONLY | O_NONBLOCK | O_CLOEXEC);
+
+	if (fd < 0)
+	{
+		return -1;
+	}
+
+	bool ok = ioctl(fd, UI_SET_EVBIT, EV_KEY) == 0 &&
+	          ioctl(fd, UI_SET_EVBIT, EV_ABS) == 0;
+
+	for (const GamepadButton& b : gamepadButtons)
+	{
+		ok = ok && ioctl(fd, UI_SET_KEYBIT, b.code) == 0;
+	}
+
+	for (const uint16_t code : { ABS_X, ABS_Y, ABS_RX, ABS_RY })
+	{
+		ok = ok && ioctl(fd, UI_SET_ABSBIT, code) == 0 && setAbs(fd, code, -32768, 32767, 16, 128);
+	}
+
+	for (const uint16_t code : { ABS_Z, ABS_RZ })
+	{
+		ok = ok && ioctl(fd, UI_SET_ABSBIT, code) == 0 && setAbs(fd, code, 0, 255, 0, 0);
+	}
+
+	for (const uint16_t code : { ABS_HAT0X, ABS_HAT0Y })
+	{
+		ok = ok && ioctl(fd, UI_SET_ABSBIT, code) == 0 && setAbs(fd, code, -1, 1, 0, 0);
+	}
+
+	if (!ok || !createDevice(fd, "ds4wizard XInput controller", gamepadProductId))
+	{
+		close(fd);
+		return -1;
+	}
+
+	return fd;
+}
+
+void UinputOutputSink::destroy(int& fd)
+{
+	if (fd < 0)
+	{
+		return;
+	}
+
+	ioctl(fd, UI_DEV_DESTROY);
+	close(fd);
+	fd = -1;
+}
+
+void UinputOutputSink::add(std::vector<input_event>& events, uint16_t type, uint16_t code, int32_t value)
+{
+	input_event event {};
+	event.type  = type;
+	event.code  = code;
+	event.value = value;
+
+	events.push_back(event);
+}
+
+void UinputOutputSink::submit(int fd, std::vector<input_event>& events)
+{
+	if (events.empty())
+	{
+		return;
+	}
+
+	if (fd >= 0)
+	{
+		add(events, EV_SYN, SYN_REPORT, 0);
+
+		// a full kernel buffer only costs this tick's events; the next tick carries on
+		[[maybe_unused]] const ssize_t written = write(fd, events.data(), events.size() * sizeof(input_event));
+	}
+
+	events.clear();
+}
+
+#endif
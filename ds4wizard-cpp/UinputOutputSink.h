@@ -0,0 +1,54 @@
+#pragma once
+
+#ifdef __linux__
+
+#include <vector>
+#include <linux/input.h>
+
+#include "IOutputSink.h"
+
+/**
+ * \brief Sends output to two virtual devices created through Linux \c /dev/uinput:
+ * a keyboard and mouse, and an Xbox 360-style gamepad.
+ * Each tick is written with a single \c write per device, terminated by a \c SYN_REPORT.
+ */
+class UinputOutputSink : public IOutputSink
+{
+	int keyboardFd = -1;
+	int gamepadFd  = -1;
+
+	std::vector<input_event> keyboardEvents;
+	std::vector<input_event> gamepadEvents;
+
+public:
+	/**
+	 * \brief Creates the virtual devices. Check \c isOpen for success;
+	 * output for a device that could not be created is dropped.
+	 */
+	UinputOutputSink();
+	~UinputOutputSink() override;
+
+	UinputOutputSink(const UinputOutputSink&) = delete;
+	UinputOutputSink& operator=(const UinputOutputSink&) = delete;
+
+	/**
+	 * \brief Indicates if both virtual devices were created.
+	 */
+	[[nodiscard]] bool isOpen() const;
+
+	void keyboardKey(int keyCode, bool down) override;
+	void mouseButton(MouseButton button, bool down) override;
+	void mouseMove(int dx, int dy) override;
+	void xinputState(const XInputGamepad& state) override;
+	void flush() override;
+
+private:
+	static int createKeyboard();
+	static int createGamepad();
+	static void destroy(int& fd);
+
+	static void add(std::vector<input_event>& events, uint16_t type, uint16_t code, int32_t value);
+	static void submit(int fd, std::vector<input_event>& events);
+};
+
+#endif
@@ -250,6 +250,16 @@ float Vector3::dot(const Vector3& rhs) const
 	return (x * rhs.x) + (y * rhs.y) + (z * rhs.z);
 }
 
+Vector3 Vector3::cross(const Vector3& rhs) const
+{
+	return
+	{
+		(y * rhs.z) - (z * rhs.y),
+		(z * rhs.x) - (x * rhs.z),
+		(x * rhs.y) - (y * rhs.x)
+	};
+}
+
 bool Vector3::nearEqual(const Vector3& rhs) const
 {
 	return gmath::near_equal(x, rhs.x) &&
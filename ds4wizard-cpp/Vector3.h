@@ -60,6 +60,7 @@ public:
 	[[nodiscard]] bool isNormalized() const;
 
 	[[nodiscard]] float dot(const Vector3& rhs) const;
+	[[nodiscard]] Vector3 cross(const Vector3& rhs) const;
 	[[nodiscard]] bool nearEqual(const Vector3& rhs) const;
 
 	static Vector3 lerp(const Vector3& start, const Vector3& end, float amount);
@@ -0,0 +1,22 @@
+#include "pch.h"
+#include "ViGEmOutputSink.h"
+
+void ViGEmOutputSink::keyboardKey(int, bool)
+{
+}
+
+void ViGEmOutputSink::mouseButton(MouseButton, bool)
+{
+}
+
+void ViGEmOutputSink::mouseMove(int, int)
+{
+}
+
+void ViGEmOutputSink::xinputState(const XInputGamepad& state)
+{
+	if (target && target->connected())
+	{
+		target->update(state);
+	}
+}
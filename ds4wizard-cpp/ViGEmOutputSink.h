@@ -0,0 +1,24 @@
+#pragma once
+
+#include <memory>
+
+#include "IOutputSink.h"
+#include "ViGEmTarget.h"
+
+/**
+ * \brief Sends gamepad output to a virtual XInput controller provided by ViGEm.
+ * Keyboard and mouse output is ignored; see \c Win32OutputSink.
+ */
+class ViGEmOutputSink : public IOutputSink
+{
+public:
+	/**
+	 * \brief The controller to update. State is dropped while it is \c nullptr or not connected.
+	 */
+	std::shared_ptr<vigem::XInputTarget> target;
+
+	void keyboardKey(int keyCode, bool down) override;
+	void mouseButton(MouseButton button, bool down) override;
+	void mouseMove(int dx, int dy) override;
+	void xinputState(const XInputGamepad& state) override;
+};
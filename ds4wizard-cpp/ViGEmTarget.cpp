@@ -79,6 +79,10 @@ namespace vigem
 		return result;
 	}
 
+	static_assert(sizeof(XInputGamepad) == sizeof(XUSB_REPORT), "XInputGamepad must match XUSB_REPORT");
+	static_assert(offsetof(XInputGamepad, sThumbLX) == offsetof(XUSB_REPORT, sThumbLX), "XInputGamepad must match XUSB_REPORT");
+	static_assert(offsetof(XInputGamepad, sThumbRY) == offsetof(XUSB_REPORT, sThumbRY), "XInputGamepad must match XUSB_REPORT");
+
 	void XInputTarget::update(const XInputGamepad& data) const
 	{
 		auto guard = parent->lock();
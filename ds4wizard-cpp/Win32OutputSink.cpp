@@ -0,0 +1,46 @@
+#include "pch.h"
+#include "Win32OutputSink.h"
+
+Win32OutputSink::Win32OutputSink()
+	: keyboard(&buffer),
+	  mouse(&buffer)
+{
+}
+
+void Win32OutputSink::keyboardKey(int keyCode, bool down)
+{
+	if (down)
+	{
+		keyboard.keyDown(keyCode);
+	}
+	else
+	{
+		keyboard.keyUp(keyCode);
+	}
+}
+
+void Win32OutputSink::mouseButton(MouseButton button, bool down)
+{
+	if (down)
+	{
+		mouse.buttonDown(button);
+	}
+	else
+	{
+		mouse.buttonUp(button);
+	}
+}
+
+void Win32OutputSink::mouseMove(int dx, int dy)
+{
+	mouse.moveBy(dx, dy);
+}
+
+void Win32OutputSink::xinputState(const XInputGamepad&)
+{
+}
+
+void Win32OutputSink::flush()
+{
+	buffer.flush();
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "IOutputSink.h"
+#include "KeyboardSimulator.h"
+#include "MouseSimulator.h"
+#include "SendInputBuffer.h"
+
+/**
+ * \brief Sends keyboard and mouse output to the system with \c SendInput,
+ * one call per tick. Anything still held is released when the sink is destroyed.
+ * Gamepad output is ignored; see \c ViGEmOutputSink.
+ */
+class Win32OutputSink : public IOutputSink
+{
+	// declared before the simulators that queue input in it so that it outlives them
+	SendInputBuffer buffer;
+
+	KeyboardSimulator keyboard;
+	MouseSimulator mouse;
+
+public:
+	Win32OutputSink();
+
+	void keyboardKey(int keyCode, bool down) override;
+	void mouseButton(MouseButton button, bool down) override;
+	void mouseMove(int dx, int dy) override;
+	void xinputState(const XInputGamepad& state) override;
+	void flush() override;
+};
@@ -1,4 +1,3 @@
-#include "pch.h"
 #include "XInputGamepad.h"
 
 bool XInputGamepad::operator==(const XInputGamepad& r) const
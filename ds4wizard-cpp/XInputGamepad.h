@@ -1,12 +1,22 @@
 #pragma once
-#include <Xinput.h>
 #include <cstdint>
 
 /**
- * \brief Simple wrapper for \c XINPUT_GAMEPAD with comparison operators and method for outputting bytes.
+ * \brief The state of an Xbox 360 controller, with comparison operators and method for outputting bytes.
+ * Laid out exactly like \c XINPUT_GAMEPAD and \c XUSB_REPORT, but defined here so that
+ * output code doesn't depend on Windows headers.
+ * \sa XInputButtons
  */
-struct XInputGamepad : XINPUT_GAMEPAD
+struct XInputGamepad
 {
+	uint16_t wButtons;
+	uint8_t  bLeftTrigger;
+	uint8_t  bRightTrigger;
+	int16_t  sThumbLX;
+	int16_t  sThumbLY;
+	int16_t  sThumbRX;
+	int16_t  sThumbRY;
+
 	bool operator==(const XInputGamepad& r) const;
 	bool operator!=(const XInputGamepad& r) const;
 
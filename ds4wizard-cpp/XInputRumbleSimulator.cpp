@@ -14,6 +14,11 @@ void XInputRumbleSimulator::update(float deltaTime)
 	                  static_cast<float>(xinputVibration.wRightMotorSpeed >> 8) / 255.0f);
 }
 
+bool XInputRumbleSimulator::needsTick() const
+{
+	return false;
+}
+
 void XInputRumbleSimulator::onActivate(float deltaTime)
 {
 	if (xinputTarget)
@@ -23,6 +28,7 @@ void XInputRumbleSimulator::onActivate(float deltaTime)
 			{
 				this->xinputVibration.wLeftMotorSpeed  = (large << 8) | large;
 				this->xinputVibration.wRightMotorSpeed = (small << 8) | small;
+				this->parent->wake();
 			});
 	}
 }
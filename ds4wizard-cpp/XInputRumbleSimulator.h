@@ -19,6 +19,11 @@ public:
 
 	void update(float deltaTime) override;
 
+	/**
+	 * \brief Vibration only changes on notification, which wakes the device on its own.
+	 */
+	[[nodiscard]] bool needsTick() const override;
+
 private:
 	void onActivate(float deltaTime) override;
 	void onDeactivate(float deltaTime) override;
@@ -1,14 +1,19 @@
 #pragma once
 
-#include <vector>
+#include <array>
 
 #include "Stopwatch.h"
 
+/**
+ * \brief Averages values pushed over a period of time. Only a running sum is kept,
+ * so pushing never allocates regardless of how many values arrive per period.
+ */
 template <typename T>
 class timed_average
 {
 private:
-	std::vector<T> points;
+	T sum {};
+	size_t count = 0;
 	Stopwatch stopwatch;
 	Stopwatch::Duration target_duration;
 	T last_average {};
@@ -28,9 +33,10 @@ public:
 		}
 
 		dirty = true;
-		points.push_back(value);
+		sum += value;
+		++count;
 
-		// if we've met our target, cache the result now and clear the buffer
+		// if we've met our target, cache the result now and reset the sum
 		if (stopwatch.elapsed() >= target_duration)
 		{
 			this->value();
@@ -44,25 +50,13 @@ public:
 			return last_average;
 		}
 
-		if (dirty)
-		{
-			T temp {};
-
-			for (const auto& p : points)
-			{
-				temp += p / points.size();
-			}
-
-			last_average = temp;
-			dirty = false;
-		}
+		last_average = sum / count;
+		dirty = false;
 
-		if (stopwatch.elapsed() >= target_duration)
-		{
-			points.clear();
-			points.push_back(last_average);
-			stopwatch.start();
-		}
+		// carry the average into the next period as its first point
+		sum = last_average;
+		count = 1;
+		stopwatch.start();
 
 		return last_average;
 	}
@@ -50,16 +50,18 @@ void deserializeFlags_ ## TYPE ## (const std::string& input, TYPE ## _t& value)
 	}                                                                           \
 }
 
-const std::array<InputType_t, 3> InputType_values = {
+const std::array<InputType_t, 4> InputType_values = {
 	InputType::button,
 	InputType::axis,
-	InputType::touchRegion
+	InputType::touchRegion,
+	InputType::touchGesture
 };
 
 static const char* InputType_names[] = {
 	"button",
 	"axis",
-	"touchRegion"
+	"touchRegion",
+	"touchGesture"
 };
 
 SERIALIZE_DEF(InputType)
@@ -386,6 +388,28 @@ static const char* Direction_names[] = {
 
 SERIALIZE_DEF(Direction)
 
+const std::array<TouchGesture_t, 7> TouchGesture_values = {
+	TouchGesture::flick,
+	TouchGesture::swipe,
+	TouchGesture::pinchIn,
+	TouchGesture::pinchOut,
+	TouchGesture::tap,
+	TouchGesture::doubleTap,
+	TouchGesture::twoFingerTap
+};
+
+static const char* TouchGesture_names[] = {
+	"flick",
+	"swipe",
+	"pinchIn",
+	"pinchOut",
+	"tap",
+	"doubleTap",
+	"twoFingerTap"
+};
+
+SERIALIZE_DEF(TouchGesture)
+
 const std::array<OutputType_t, 3> OutputType_values = {
 	OutputType::xinput,
 	OutputType::keyboard,
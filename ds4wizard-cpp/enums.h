@@ -2,6 +2,8 @@
 
 #include <array>
 #include <cstdint>
+#include <string>
+
 #include <enum.h>
 
 #define ENUM_FLAGS(TYPE) \
@@ -36,11 +38,30 @@ BETTER_ENUM(DeadZoneSource, int,
             /** \brief Use the value of the axis as-is, accounting for polarity/direction. */
             axisValue)
 
+/**
+ * \brief The shape of an axis response curve.
+ * \sa AxisResponseCurve
+ */
+BETTER_ENUM(AxisResponseCurveType, int,
+            /** \brief Output is equal to input. */
+            linear,
+
+            /** \brief Output is input raised to a power, for finer control near rest. */
+            exponential,
+
+            /** \brief Output eases in and out of both ends of the range. */
+            sCurve,
+
+            /** \brief Output is interpolated between user-defined points. */
+            custom)
+
 // TODO: /!\ better name
 BETTER_ENUM(SimulatorType, int, none, input, action)
 
 // TODO: vibrate, set light color
-BETTER_ENUM(ActionType, int, none, bluetoothDisconnect)
+BETTER_ENUM(ActionType, int, none, bluetoothDisconnect,
+            /** \brief Plays back the \c Macro named by \c InputMap::macro. */
+            macro)
 
 BETTER_ENUM(MouseButton, int,
             /** \brief The left mouse button. */
@@ -74,12 +95,14 @@ struct InputType
 		/** \brief Requested input is an axis. */
 		axis = 1 << 1,
 		/** \brief Requested input is a user-configured touch region. */
-		touchRegion = 1 << 2
+		touchRegion = 1 << 2,
+		/** \brief Requested input is a touch pad gesture. */
+		touchGesture = 1 << 3
 	};
 };
 
 ENUM_FLAGS(InputType);
-ENUM_VALUES(InputType, 3);
+ENUM_VALUES(InputType, 4);
 
 using OutputType_t = uint32_t;
 
@@ -177,6 +200,37 @@ struct Direction
 ENUM_FLAGS(Direction);
 ENUM_VALUES(Direction, 4);
 
+using TouchGesture_t = uint32_t;
+
+/**
+ * \brief Bitfield representing gestures performed on the touch pad.
+ * \sa Ds4GestureRecognizer
+ */
+struct TouchGesture
+{
+	enum T : TouchGesture_t
+	{
+		none,
+		/** \brief A single touch released while moving quickly. */
+		flick = 1 << 0,
+		/** \brief A single touch moved far from where it started. */
+		swipe = 1 << 1,
+		/** \brief Two touches held closer together than they started. */
+		pinchIn = 1 << 2,
+		/** \brief Two touches held further apart than they started. */
+		pinchOut = 1 << 3,
+		/** \brief A single short touch that barely moved. */
+		tap = 1 << 4,
+		/** \brief A tap shortly after and close to another tap. */
+		doubleTap = 1 << 5,
+		/** \brief Two touches together that were short and barely moved. */
+		twoFingerTap = 1 << 6
+	};
+};
+
+ENUM_FLAGS(TouchGesture);
+ENUM_VALUES(TouchGesture, 7);
+
 /**
  * \brief The values that can be represented by a Hat Switch.
  */
@@ -3,6 +3,7 @@
 #include <QApplication>
 #include <singleapplication.h>
 #include "program.h"
+#include "replay.h"
 
 #ifdef QT_IS_BROKEN
 #include <Windows.h>
@@ -46,9 +47,28 @@ int main(int argc, char** argv)
 	SetPriorityClass(GetCurrentProcess(), HIGH_PRIORITY_CLASS);
 #endif
 
+	// headless, so it's handled before any of the single-instance and UI setup
+	if (const std::optional<int> replayResult = runReplayCommand(argc, argv); replayResult.has_value())
+	{
+		return *replayResult;
+	}
+
 	SingleApplication application(argc, argv, false,
 	                              SingleApplication::Mode::ExcludeAppPath | SingleApplication::Mode::User | SingleApplication::Mode::ExcludeAppVersion);
 
+	const QStringList arguments = application.arguments();
+	const int backendIndex = arguments.indexOf("--hid-backend");
+
+	if (backendIndex >= 0 && backendIndex + 1 < arguments.size())
+	{
+		const std::string backendName = arguments[backendIndex + 1].toStdString();
+
+		if (!hid::selectBackend(backendName))
+		{
+			qWarning() << "unknown HID backend" << backendName.c_str();
+		}
+	}
+
 	Program::initialize();
 	Program::loadSettings();
 
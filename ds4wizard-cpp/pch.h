@@ -52,6 +52,7 @@
 #include <fmt/format.h>
 
 // libhid
+#include <hid_backend.h>
 #include <hid_handle.h>
 #include <hid_instance.h>
 #include <hid_util.h>
@@ -61,7 +62,6 @@
 #include <ViGEm/Common.h>
 #include <ViGEm/km/BusShared.h>
 
-#include "MapCache.h"
 #include "average.h"
 #include "AxisOptions.h"
 #include "Bluetooth.h"
@@ -99,6 +99,7 @@
 #include "Pressable.h"
 #include "ProfileEditorDialog.h"
 #include "program.h"
+#include "SendInputBuffer.h"
 #include "Settings.h"
 #include "Stopwatch.h"
 #include "stringutil.h"
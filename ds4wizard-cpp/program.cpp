@@ -33,6 +33,7 @@ QString Program::settingsPath;
 QString Program::settingsFilePath;
 std::string Program::profilesPath_;
 std::string Program::devicesFilePath_;
+std::string Program::tracesPath_;
 
 vigem::Driver Program::driver;
 
@@ -46,6 +47,11 @@ const std::string& Program::devicesFilePath()
 	return devicesFilePath_;
 }
 
+const std::string& Program::tracesPath()
+{
+	return tracesPath_;
+}
+
 bool Program::isElevated()
 {
 	return isElevated_;
@@ -66,6 +72,7 @@ void Program::initialize()
 	settingsFilePath = settingsPath + "/settings.json";
 	profilesPath_    = (settingsPath + "/profiles").toStdString();
 	devicesFilePath_ = (settingsPath + "/devices.json").toStdString();
+	tracesPath_      = (settingsPath + "/traces").toStdString();
 
 	isElevated_ = IsElevated() == TRUE;
 }
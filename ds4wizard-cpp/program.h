@@ -11,6 +11,7 @@ class Program
 	static QString settingsFilePath;
 	static std::string profilesPath_;
 	static std::string devicesFilePath_;
+	static std::string tracesPath_;
 	inline static bool isElevated_ = false;
 
 public:
@@ -42,6 +43,12 @@ public:
 	 */
 	static const std::string& devicesFilePath();
 
+	/**
+	 * \brief Filesystem path that device trace captures are written to.
+	 * \sa Settings::captureTraces
+	 */
+	static const std::string& tracesPath();
+
 	/**
 	 * \brief Indicates whether or not the program is running with elevated privileges.
 	 * \return \c true if the application is running with elevated privileges.
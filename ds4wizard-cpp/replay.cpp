@@ -0,0 +1,210 @@
+#include "pch.h"
+
+#include <cstdio>
+#include <sstream>
+#include <string>
+
+#include <QFile>
+
+#include <fmt/format.h>
+
+#include "DeviceProfile.h"
+#include "Ds4Trace.h"
+#include "Ds4TraceReplay.h"
+#include "RecordingOutputSink.h"
+#include "replay.h"
+
+using namespace std::chrono;
+
+namespace
+{
+	bool readFile(const std::string& path, std::string& contents)
+	{
+		QFile file(QString::fromStdString(path));
+
+		if (!file.open(QIODevice::ReadOnly))
+		{
+			return false;
+		}
+
+		contents = file.readAll().toStdString();
+		return true;
+	}
+
+	/**
+	 * \brief Prints the first line that differs between \p expected and \p actual.
+	 * \return \c true if they are identical.
+	 */
+	bool compareOutput(const std::string& expected, const std::string& actual)
+	{
+		std::istringstream expectedStream(expected);
+		std::istringstream actualStream(actual);
+
+		std::string expectedLine;
+		std::string actualLine;
+
+		for (size_t line = 1;; ++line)
+		{
+			const bool haveExpected = !!std::getline(expectedStream, expectedLine);
+			const bool haveActual   = !!std::getline(actualStream, actualLine);
+
+			if (!haveExpected && !haveActual)
+			{
+				return true;
+			}
+
+			if (haveExpected != haveActual || expectedLine != actualLine)
+			{
+				printf("output differs at line %zu\n", line);
+				printf("  expected: %s\n", haveExpected ? expectedLine.c_str() : "<end of output>");
+				printf("  actual:   %s\n", haveActual ? actualLine.c_str() : "<end of output>");
+				return false;
+			}
+		}
+	}
+}
+
+std::optional<int> runReplayCommand(int argc, char** argv)
+{
+	std::optional<std::string> tracePath;
+	std::optional<std::string> profilePath;
+	std::optional<std::string> outputPath;
+	std::optional<std::string> goldenPath;
+
+	auto speed = Ds4TraceReplay::Speed::unlimited;
+	size_t iterations = 1;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		const std::string arg(argv[i]);
+
+		if (arg == "--realtime")
+		{
+			speed = Ds4TraceReplay::Speed::realTime;
+			continue;
+		}
+
+		if (i + 1 >= argc)
+		{
+			break;
+		}
+
+		if (arg == "--replay")
+		{
+			tracePath = argv[++i];
+		}
+		else if (arg == "--profile")
+		{
+			profilePath = argv[++i];
+		}
+		else if (arg == "--iterations")
+		{
+			iterations = std::max<size_t>(std::stoul(argv[++i]), 1);
+		}
+		else if (arg == "--output")
+		{
+			outputPath = argv[++i];
+		}
+		else if (arg == "--golden")
+		{
+			goldenPath = argv[++i];
+		}
+	}
+
+	if (!tracePath.has_value())
+	{
+		return std::nullopt;
+	}
+
+#ifdef Q_OS_WIN
+	// this is a GUI application, so there's no console to print to unless we borrow the parent's
+	if (AttachConsole(ATTACH_PARENT_PROCESS))
+	{
+		freopen("CONOUT$", "w", stdout);
+	}
+#endif
+
+	if (!profilePath.has_value())
+	{
+		printf("--replay requires --profile <profile.json>\n");
+		return 1;
+	}
+
+	Ds4TraceReader trace;
+
+	if (!trace.open(*tracePath))
+	{
+		printf("unable to read trace %s\n", tracePath->c_str());
+		return 1;
+	}
+
+	std::string profileJson;
+
+	if (!readFile(*profilePath, profileJson))
+	{
+		printf("unable to read profile %s\n", profilePath->c_str());
+		return 1;
+	}
+
+	const auto profile = JsonData::fromJson<DeviceProfile>(nlohmann::json::parse(profileJson));
+
+	RecordingOutputSink sink;
+	Ds4TraceReplay replay(profile, &sink);
+
+	Ds4TraceReplay::Result total {};
+
+	for (size_t i = 0; i < iterations; ++i)
+	{
+		sink.clear();
+		const Ds4TraceReplay::Result result = replay.run(trace, speed);
+
+		total.reports += result.reports;
+		total.ticks   += result.ticks;
+		total.elapsed += result.elapsed;
+		total.dropped  = result.dropped;
+		total.traceDuration = result.traceDuration;
+	}
+
+	printf("trace:       %.3f s, %zu dropped\n", duration<double>(total.traceDuration).count(), total.dropped);
+	printf("iterations:  %zu\n", iterations);
+	printf("reports:     %zu\n", total.reports);
+	printf("idle ticks:  %zu\n", total.ticks);
+	printf("outputs:     %zu\n", sink.events().size());
+	printf("elapsed:     %.3f s\n", duration<double>(total.elapsed).count());
+	printf("reports/sec: %.0f (single thread)\n", total.reportsPerSecond());
+
+	const std::string output = sink.toText();
+
+	if (outputPath.has_value())
+	{
+		QFile file(QString::fromStdString(*outputPath));
+
+		if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+		{
+			printf("unable to write output %s\n", outputPath->c_str());
+			return 1;
+		}
+
+		file.write(output.data(), static_cast<qint64>(output.size()));
+	}
+
+	if (goldenPath.has_value())
+	{
+		std::string golden;
+
+		if (!readFile(*goldenPath, golden))
+		{
+			printf("unable to read golden output %s\n", goldenPath->c_str());
+			return 1;
+		}
+
+		if (!compareOutput(golden, output))
+		{
+			return 2;
+		}
+
+		printf("output matches %s\n", goldenPath->c_str());
+	}
+
+	return 0;
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <optional>
+
+/**
+ * \brief Runs a headless trace replay if \c --replay was given on the command line.
+ *
+ * Usage: \c --replay \c <trace> \c --profile \c <profile.json> [\c --realtime] [\c --iterations \c <n>]
+ * [\c --output \c <file>] [\c --golden \c <file>]
+ *
+ * \c --output writes the simulated output of the last iteration as text, and \c --golden
+ * compares it against a file written that way.
+ *
+ * \return The process exit code, or \c std::nullopt if no replay was requested.
+ * \sa Ds4TraceReplay
+ */
+std::optional<int> runReplayCommand(int argc, char** argv);
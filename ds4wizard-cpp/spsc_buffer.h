@@ -0,0 +1,114 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+
+#include <gsl/span>
+
+/**
+ * \brief Lock-free byte queue shared by exactly one producer thread and one consumer thread.
+ * The capacity is rounded up to a power of two and allocated once up front.
+ */
+class spsc_buffer
+{
+	std::unique_ptr<uint8_t[]> data;
+	const size_t mask;
+
+	// Kept on separate cache lines so the two threads don't contend for them.
+	alignas(64) std::atomic<size_t> head = 0; // total bytes written; owned by the producer
+	alignas(64) std::atomic<size_t> tail = 0; // total bytes read; owned by the consumer
+
+	static size_t round_capacity(size_t capacity)
+	{
+		size_t result = 1;
+
+		while (result < capacity)
+		{
+			result <<= 1;
+		}
+
+		return result;
+	}
+
+	void copy_in(size_t position, const uint8_t* source, size_t size)
+	{
+		if (!size)
+		{
+			return;
+		}
+
+		const size_t offset = position & mask;
+		const size_t first  = std::min(size, mask + 1 - offset);
+
+		std::memcpy(&data[offset], source, first);
+		std::memcpy(&data[0], source + first, size - first);
+	}
+
+public:
+	explicit spsc_buffer(size_t capacity)
+		: mask(round_capacity(capacity) - 1)
+	{
+		data = std::make_unique<uint8_t[]>(mask + 1);
+	}
+
+	spsc_buffer(const spsc_buffer&) = delete;
+	spsc_buffer& operator=(const spsc_buffer&) = delete;
+
+	[[nodiscard]] size_t capacity() const
+	{
+		return mask + 1;
+	}
+
+	/**
+	 * \brief Appends \p first followed by \p second, or nothing at all if they don't both fit.
+	 * Producer thread only.
+	 * \return \c true if the data was queued.
+	 */
+	bool push(gsl::span<const uint8_t> first, gsl::span<const uint8_t> second = {})
+	{
+		const size_t size = first.size() + second.size();
+		const size_t h = head.load(std::memory_order_relaxed);
+
+		if (capacity() - (h - tail.load(std::memory_order_acquire)) < size)
+		{
+			return false;
+		}
+
+		copy_in(h, first.data(), first.size());
+		copy_in(h + first.size(), second.data(), second.size());
+
+		head.store(h + size, std::memory_order_release);
+		return true;
+	}
+
+	/**
+	 * \brief Gets the oldest contiguous run of queued bytes without removing it.
+	 * Consumer thread only.
+	 * \return The queued bytes, or an empty span if nothing is queued.
+	 */
+	[[nodiscard]] gsl::span<const uint8_t> front() const
+	{
+		const size_t t = tail.load(std::memory_order_relaxed);
+		const size_t available = head.load(std::memory_order_acquire) - t;
+		const size_t offset = t & mask;
+
+		return gsl::span<const uint8_t>(&data[offset], std::min(available, mask + 1 - offset));
+	}
+
+	/**
+	 * \brief Removes \p size bytes previously returned by \c front.
+	 * Consumer thread only.
+	 */
+	void pop(size_t size)
+	{
+		tail.store(tail.load(std::memory_order_relaxed) + size, std::memory_order_release);
+	}
+
+	[[nodiscard]] bool empty() const
+	{
+		return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+	}
+};
@@ -1,17 +1,24 @@
+#ifdef _WIN32
 #define WIN32_LEAN_AND_MEAN
 #include <Windows.h>
+#endif
 
+#include <cstdio>
 #include <iostream>
 #include <optional>
 #include <vector>
 #include <string>
 
+#include <hid_backend.h>
 #include <hid_util.h>
 #include <hid_instance.h>
 
+#include "wait_benchmark.h"
+
 static std::shared_ptr<hid::HidInstance> device = nullptr;
 static std::optional<uint16_t> vendorId;
 static std::optional<uint16_t> productId;
+static std::optional<size_t> benchmarkDevices;
 
 bool enumFunc(std::shared_ptr<hid::HidInstance> inst)
 {
@@ -67,6 +74,33 @@ int main(int argc, char** argv)
 		{
 			productId = static_cast<uint16_t>(std::stoi(argv[++i], nullptr, 16));
 		}
+		else if (arg == "--bench-wait")
+		{
+			benchmarkDevices = static_cast<size_t>(std::stoul(argv[++i]));
+		}
+		else if (arg == "--backend")
+		{
+			const std::string name(argv[++i]);
+
+			if (!hid::selectBackend(name))
+			{
+				printf("unknown backend \"%s\". available:", name.c_str());
+
+				for (const auto& backendName : hid::backendNames())
+				{
+					printf(" %s", backendName.c_str());
+				}
+
+				printf("\n");
+				return -1;
+			}
+		}
+	}
+
+	if (benchmarkDevices.has_value())
+	{
+		runWaitBenchmark(*benchmarkDevices, 2.0);
+		return 0;
 	}
 
 	if (!vendorId.has_value() && !productId.has_value())
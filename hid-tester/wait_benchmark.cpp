@@ -0,0 +1,217 @@
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#else
+#include <ctime>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <hid_loopback.h>
+
+#include "wait_benchmark.h"
+
+using namespace std::chrono;
+
+namespace
+{
+	constexpr auto reportInterval = 1ms;
+
+	/**
+	 * \brief CPU time (user and kernel) used by every thread of the process so far.
+	 */
+	nanoseconds processCpuTime()
+	{
+	#ifdef _WIN32
+		FILETIME creation, exit, kernel, user;
+
+		if (!GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user))
+		{
+			return nanoseconds::zero();
+		}
+
+		const auto ticks = [](const FILETIME& t)
+		{
+			return (static_cast<int64_t>(t.dwHighDateTime) << 32) | t.dwLowDateTime;
+		};
+
+		// FILETIME is in 100 ns units
+		return nanoseconds((ticks(kernel) + ticks(user)) * 100);
+	#else
+		timespec ts {};
+		clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+		return seconds(ts.tv_sec) + nanoseconds(ts.tv_nsec);
+	#endif
+	}
+
+	struct Result
+	{
+		size_t threads;
+		double cpuPercent;
+		double reportsPerSecond;
+	};
+
+	size_t drain(hid::HidInstance& instance)
+	{
+		size_t count = 0;
+
+		while (instance.readAsync())
+		{
+			++count;
+		}
+
+		return count;
+	}
+
+	/**
+	 * \brief What \c Ds4Device::controllerThread does: drain the device, then block on it alone.
+	 */
+	void perDeviceThread(hid::HidInstance& instance, const std::atomic<bool>& running, std::atomic<size_t>& reports)
+	{
+		while (running)
+		{
+			reports += drain(instance);
+
+			if (running)
+			{
+				instance.waitForRead(hid::HidInstance::infiniteWait);
+			}
+		}
+	}
+
+	/**
+	 * \brief What a \c Ds4DeviceReactor worker does: block on a whole group and drain only the ready devices.
+	 */
+	void sharedThread(hid::HidBackend& backend, const std::vector<hid::HidInstance*>& group,
+	                  const std::atomic<bool>& running, std::atomic<size_t>& reports)
+	{
+		std::vector<hid::HidInstance*> ready(group);
+
+		while (running)
+		{
+			for (hid::HidInstance* instance : ready)
+			{
+				reports += drain(*instance);
+			}
+
+			if (running)
+			{
+				backend.waitAny(group, hid::HidInstance::infiniteWait, ready);
+			}
+		}
+	}
+
+	Result run(size_t deviceCount, bool shared, double secondsPerRun)
+	{
+		auto backend = std::make_shared<hid::LoopbackBackend>(std::make_shared<hid::LoopbackClock>(hid::LoopbackClock::Mode::realTime));
+
+		hid::HidCaps caps {};
+		caps.inputReportSize = 64;
+
+		std::vector<std::shared_ptr<hid::HidInstance>> instances;
+
+		for (size_t i = 0; i < deviceCount; ++i)
+		{
+			auto device = backend->addDevice(caps, {});
+
+			// real controllers aren't in phase with each other, so spread them across the interval
+			const auto phase = duration_cast<hid::LoopbackClock::duration>(reportInterval) * i / deviceCount;
+			device->setInputScript({ { backend->clock->now() + phase, std::vector<uint8_t>(64) } }, true, reportInterval);
+
+			auto instance = backend->create(device->path);
+			instance->readMetadata();
+			instance->open(hid::HidOpenFlags::async);
+
+			instances.push_back(std::move(instance));
+		}
+
+		std::atomic<bool> running = true;
+		std::atomic<size_t> reports = 0;
+		std::vector<std::thread> threads;
+		std::vector<std::vector<hid::HidInstance*>> groups;
+
+		if (shared)
+		{
+			const size_t capacity = std::max<size_t>(backend->maxWaitCount(), 1);
+
+			for (size_t i = 0; i < instances.size(); i += capacity)
+			{
+				std::vector<hid::HidInstance*> group;
+
+				for (size_t j = i; j < std::min(i + capacity, instances.size()); ++j)
+				{
+					group.push_back(instances[j].get());
+				}
+
+				groups.push_back(std::move(group));
+			}
+
+			for (const auto& group : groups)
+			{
+				threads.emplace_back(sharedThread, std::ref(*backend), std::cref(group), std::cref(running), std::ref(reports));
+			}
+		}
+		else
+		{
+			for (auto& instance : instances)
+			{
+				threads.emplace_back(perDeviceThread, std::ref(*instance), std::cref(running), std::ref(reports));
+			}
+		}
+
+		// let every thread settle into its wait before measuring
+		std::this_thread::sleep_for(100ms);
+
+		const size_t startReports = reports;
+		const nanoseconds startCpu = processCpuTime();
+		const auto startTime = steady_clock::now();
+
+		std::this_thread::sleep_for(duration<double>(secondsPerRun));
+
+		const nanoseconds cpu = processCpuTime() - startCpu;
+		const duration<double> elapsed = steady_clock::now() - startTime;
+		const size_t readCount = reports - startReports;
+
+		running = false;
+
+		for (auto& instance : instances)
+		{
+			instance->interruptWait();
+		}
+
+		for (auto& thread : threads)
+		{
+			thread.join();
+		}
+
+		return {
+			threads.size(),
+			100.0 * duration<double>(cpu).count() / elapsed.count(),
+			static_cast<double>(readCount) / elapsed.count()
+		};
+	}
+}
+
+void runWaitBenchmark(size_t maxDevices, double secondsPerRun)
+{
+	printf("%-8s | %-26s | %-26s\n", "devices", "thread per device", "shared wait");
+	printf("%-8s | %7s %8s %9s | %7s %8s %9s\n", "", "threads", "cpu %", "reports/s", "threads", "cpu %", "reports/s");
+
+	for (size_t count = 1; count <= std::max<size_t>(maxDevices, 1); count *= 2)
+	{
+		const Result perDevice = run(count, false, secondsPerRun);
+		const Result shared = run(count, true, secondsPerRun);
+
+		printf("%-8zu | %7zu %8.2f %9.0f | %7zu %8.2f %9.0f\n", count,
+		       perDevice.threads, perDevice.cpuPercent, perDevice.reportsPerSecond,
+		       shared.threads, shared.cpuPercent, shared.reportsPerSecond);
+
+		fflush(stdout);
+	}
+}
@@ -0,0 +1,13 @@
+#pragma once
+
+#include <cstddef>
+
+/**
+ * \brief Compares the CPU cost of waiting for input with one thread per device against
+ * a shared thread that waits on many devices at once with \c hid::HidBackend::waitAny.
+ * Runs on the loopback backend with every simulated device reporting at 1000 Hz,
+ * doubling the device count from 1 up to \p maxDevices.
+ * \param maxDevices Largest number of simulated devices.
+ * \param secondsPerRun How long each device count is measured for, per threading model.
+ */
+void runWaitBenchmark(size_t maxDevices, double secondsPerRun);
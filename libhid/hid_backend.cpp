@@ -0,0 +1,113 @@
+#include <limits>
+#include <mutex>
+
+#include "hid_backend.h"
+#include "hid_loopback.h"
+
+#ifdef _WIN32
+#include "hid_win32.h"
+#endif
+
+#ifdef __linux__
+#include "hid_hidraw.h"
+#endif
+
+using namespace hid;
+
+namespace
+{
+	std::mutex backend_mutex;
+	std::shared_ptr<HidBackend> active_backend;
+
+	std::shared_ptr<HidBackend> createDefaultBackend()
+	{
+	#if defined(_WIN32)
+		return std::make_shared<Win32HidBackend>();
+	#elif defined(__linux__)
+		return std::make_shared<HidrawBackend>();
+	#else
+		return nullptr;
+	#endif
+	}
+}
+
+std::shared_ptr<HidInstance> HidBackend::create(const std::wstring& path)
+{
+	return create(path, std::wstring());
+}
+
+size_t HidBackend::maxWaitCount() const
+{
+	return std::numeric_limits<size_t>::max();
+}
+
+std::shared_ptr<HidBackend> hid::backend()
+{
+	std::lock_guard<std::mutex> guard(backend_mutex);
+
+	if (active_backend == nullptr)
+	{
+		active_backend = createDefaultBackend();
+	}
+
+	return active_backend;
+}
+
+void hid::setBackend(std::shared_ptr<HidBackend> value)
+{
+	std::lock_guard<std::mutex> guard(backend_mutex);
+	active_backend = std::move(value);
+}
+
+std::shared_ptr<HidBackend> hid::createBackend(const std::string& name)
+{
+#ifdef _WIN32
+	if (name == "win32")
+	{
+		return std::make_shared<Win32HidBackend>();
+	}
+#endif
+
+#ifdef __linux__
+	if (name == "hidraw")
+	{
+		return std::make_shared<HidrawBackend>();
+	}
+#endif
+
+	if (name == "loopback")
+	{
+		return std::make_shared<LoopbackBackend>();
+	}
+
+	return nullptr;
+}
+
+bool hid::selectBackend(const std::string& name)
+{
+	auto result = createBackend(name);
+
+	if (result == nullptr)
+	{
+		return false;
+	}
+
+	setBackend(std::move(result));
+	return true;
+}
+
+std::vector<std::string> hid::backendNames()
+{
+	std::vector<std::string> result;
+
+#ifdef _WIN32
+	result.emplace_back("win32");
+#endif
+
+#ifdef __linux__
+	result.emplace_back("hidraw");
+#endif
+
+	result.emplace_back("loopback");
+	return result;
+}
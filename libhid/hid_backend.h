@@ -0,0 +1,86 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "hid_instance.h"
+
+namespace hid
+{
+	/**
+	 * \brief Platform-specific provider of \c HidInstance objects.
+	 * \sa HidInstance
+	 */
+	class HidBackend
+	{
+	public:
+		virtual ~HidBackend() = default;
+
+		/**
+		 * \brief The name this backend is selected by, e.g. \c "win32" or \c "hidraw".
+		 */
+		virtual const char* name() const = 0;
+
+		/**
+		 * \brief Creates an unopened instance for the device at \p path.
+		 * \param path Path to the device node.
+		 * \param instanceId Backend-specific identifier of the device instance. May be empty.
+		 */
+		virtual std::shared_ptr<HidInstance> create(const std::wstring& path, const std::wstring& instanceId) = 0;
+
+		/**
+		 * \brief Enumerates the paths and instance IDs of all present HID devices.
+		 * \param fn Callback; return \c true to stop enumeration.
+		 */
+		virtual void enumerate(const std::function<bool(const std::wstring& path, const std::wstring& instanceId)>& fn) = 0;
+
+		/**
+		 * \brief Blocks until a pending read on any of \p instances completes, one of them is
+		 * interrupted with \c HidInstance::interruptWait, or \p timeout elapses.
+		 * This lets a single thread serve many devices. All instances must have been created by this backend.
+		 * \param instances Instances to wait on; at most \c maxWaitCount.
+		 * \param timeout Maximum time to wait, or \c HidInstance::infiniteWait.
+		 * \param ready Receives the instances whose pending read may have completed or which were interrupted.
+		 * \return \c true if \p ready is non-empty.
+		 * \sa HidInstance::waitForRead
+		 */
+		virtual bool waitAny(const std::vector<HidInstance*>& instances, std::chrono::microseconds timeout, std::vector<HidInstance*>& ready) = 0;
+
+		/**
+		 * \brief Maximum number of instances a single call to \c waitAny can wait on.
+		 */
+		virtual size_t maxWaitCount() const;
+
+		std::shared_ptr<HidInstance> create(const std::wstring& path);
+	};
+
+	/**
+	 * \brief Returns the active backend. Defaults to the native backend of the platform.
+	 */
+	std::shared_ptr<HidBackend> backend();
+
+	/**
+	 * \brief Replaces the active backend. Passing \c nullptr restores the platform default.
+	 */
+	void setBackend(std::shared_ptr<HidBackend> value);
+
+	/**
+	 * \brief Creates a new instance of a built-in backend by name.
+	 * \return The backend, or \c nullptr if \p name is unknown or unsupported on this platform.
+	 * \sa backendNames
+	 */
+	std::shared_ptr<HidBackend> createBackend(const std::string& name);
+
+	/**
+	 * \brief Selects a built-in backend by name and makes it active.
+	 * \return \c true on success.
+	 */
+	bool selectBackend(const std::string& name);
+
+	/**
+	 * \brief Names of the built-in backends available on this platform.
+	 */
+	std::vector<std::string> backendNames();
+}
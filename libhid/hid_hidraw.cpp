@@ -0,0 +1,814 @@
+#ifdef __linux__
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/file.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+#include <linux/hidraw.h>
+#include <linux/input.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <utility>
+#include <vector>
+
+#include "hid_hidraw.h"
+
+using namespace hid;
+
+namespace fs = std::filesystem;
+
+namespace
+{
+	/**
+	 * \brief Converts a wait timeout for \c ppoll.
+	 * \return \p ts, or \c nullptr for \c HidInstance::infiniteWait.
+	 */
+	timespec* toTimespec(std::chrono::microseconds timeout, timespec& ts)
+	{
+		if (timeout == HidInstance::infiniteWait)
+		{
+			return nullptr;
+		}
+
+		const auto t = std::max(timeout, std::chrono::microseconds::zero());
+		const auto seconds = std::chrono::duration_cast<std::chrono::seconds>(t);
+
+		ts.tv_sec  = static_cast<time_t>(seconds.count());
+		ts.tv_nsec = static_cast<long>(std::chrono::duration_cast<std::chrono::nanoseconds>(t - seconds).count());
+		return &ts;
+	}
+
+	enum class ReportType
+	{
+		input,
+		output,
+		feature
+	};
+
+	struct ReportDescriptorState
+	{
+		uint16_t usagePage   = 0;
+		uint32_t reportSize  = 0;
+		uint32_t reportCount = 0;
+		uint8_t  reportId    = 0;
+	};
+
+	std::vector<uint8_t> readFile(const fs::path& path)
+	{
+		std::ifstream file(path, std::ios::binary);
+
+		if (!file.is_open())
+		{
+			return {};
+		}
+
+		return std::vector<uint8_t>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+	}
+
+	/**
+	 * \brief Reads \c bcdDevice of the USB device that a HID device belongs to.
+	 * The HID device sits below a USB interface, which in turn sits below the USB device,
+	 * so the first ancestor that has the attribute is the one that owns it.
+	 * \param hidDevice The sysfs directory of the HID device.
+	 * \return The version number, or \c 0 if it couldn't be read.
+	 */
+	uint16_t readUsbVersionNumber(const fs::path& hidDevice)
+	{
+		std::error_code ec;
+		const fs::path device = fs::canonical(hidDevice, ec);
+
+		if (ec)
+		{
+			return 0;
+		}
+
+		for (fs::path dir = device.parent_path(); dir.has_relative_path(); dir = dir.parent_path())
+		{
+			std::ifstream file(dir / "bcdDevice");
+
+			if (!file.is_open())
+			{
+				continue;
+			}
+
+			unsigned int value = 0;
+			file >> std::hex >> value;
+
+			return static_cast<uint16_t>(value);
+		}
+
+		return 0;
+	}
+
+	uint16_t reportByteLength(const std::map<uint8_t, uint32_t>& bits)
+	{
+		uint32_t result = 0;
+
+		for (const auto& pair : bits)
+		{
+			result = std::max(result, (pair.second + 7) / 8);
+		}
+
+		// Like Windows, the length always includes the report ID byte
+		// (which is zero for devices that don't number their reports).
+		return result > 0 ? static_cast<uint16_t>(result + 1) : 0;
+	}
+
+	/**
+	 * \brief Approximates HIDP_CAPS from a raw report descriptor.
+	 * Report lengths are exact; the button/value counts follow the
+	 * same rules as the Windows parser for simple descriptors.
+	 */
+	bool parseReportDescriptor(const std::vector<uint8_t>& descriptor, HidCaps& caps, bool& numberedReports)
+	{
+		caps = {};
+		numberedReports = false;
+
+		std::map<uint8_t, uint32_t> bits[3];
+		std::vector<ReportDescriptorState> stack;
+		ReportDescriptorState state;
+
+		std::vector<uint32_t> usages;
+		bool topLevelFound = false;
+		size_t collectionDepth = 0;
+
+		for (size_t i = 0; i < descriptor.size();)
+		{
+			const uint8_t prefix = descriptor[i++];
+
+			// long items carry no information we need
+			if (prefix == 0xFE)
+			{
+				if (i + 1 >= descriptor.size())
+				{
+					return false;
+				}
+
+				i += 2 + descriptor[i];
+				continue;
+			}
+
+			static constexpr size_t sizes[] = { 0, 1, 2, 4 };
+			const size_t size = sizes[prefix & 3u];
+
+			if (i + size > descriptor.size())
+			{
+				return false;
+			}
+
+			uint32_t value = 0;
+
+			for (size_t b = 0; b < size; ++b)
+			{
+				value |= static_cast<uint32_t>(descriptor[i + b]) << (8u * b);
+			}
+
+			i += size;
+
+			const uint8_t type = (prefix >> 2u) & 3u;
+			const uint8_t tag  = prefix >> 4u;
+
+			switch (type)
+			{
+				// main
+				case 0:
+				{
+					if (tag == 0x8 || tag == 0x9 || tag == 0xB)
+					{
+						const ReportType reportType = tag == 0x8 ? ReportType::input : tag == 0x9 ? ReportType::output : ReportType::feature;
+						const bool isConstant = !!(value & 1u);
+
+						bits[static_cast<size_t>(reportType)][state.reportId] += state.reportSize * state.reportCount;
+
+						if (!isConstant)
+						{
+							const bool isButton = state.reportSize == 1;
+							const auto indices = static_cast<uint16_t>(state.reportCount);
+
+							switch (reportType)
+							{
+								case ReportType::input:
+									++(isButton ? caps.inputButtonCaps : caps.inputValueCaps);
+									caps.inputDataIndices += indices;
+									break;
+
+								case ReportType::output:
+									++(isButton ? caps.outputButtonCaps : caps.outputValueCaps);
+									caps.outputDataIndices += indices;
+									break;
+
+								case ReportType::feature:
+									++(isButton ? caps.featureButtonCaps : caps.featureValueCaps);
+									caps.featureDataIndices += indices;
+									break;
+							}
+						}
+					}
+					else if (tag == 0xA)
+					{
+						++caps.linkCollectionNodes;
+
+						if (!topLevelFound && collectionDepth == 0)
+						{
+							topLevelFound = true;
+
+							const uint32_t usage = usages.empty() ? 0 : usages.front();
+							caps.usage     = static_cast<uint16_t>(usage & 0xFFFFu);
+							caps.usagePage = usage > 0xFFFFu ? static_cast<uint16_t>(usage >> 16u) : state.usagePage;
+						}
+
+						++collectionDepth;
+					}
+					else if (tag == 0xC && collectionDepth > 0)
+					{
+						--collectionDepth;
+					}
+
+					usages.clear();
+					break;
+				}
+
+				// global
+				case 1:
+					switch (tag)
+					{
+						case 0x0:
+							state.usagePage = static_cast<uint16_t>(value);
+							break;
+
+						case 0x7:
+							state.reportSize = value;
+							break;
+
+						case 0x8:
+							state.reportId = static_cast<uint8_t>(value);
+							numberedReports = true;
+							break;
+
+						case 0x9:
+							state.reportCount = value;
+							break;
+
+						case 0xA:
+							stack.push_back(state);
+							break;
+
+						case 0xB:
+							if (!stack.empty())
+							{
+								state = stack.back();
+								stack.pop_back();
+							}
+							break;
+
+						default:
+							break;
+					}
+
+					break;
+
+				// local
+				case 2:
+					if (tag == 0x0)
+					{
+						usages.push_back(value);
+					}
+
+					break;
+
+				default:
+					break;
+			}
+		}
+
+		caps.inputReportSize   = reportByteLength(bits[static_cast<size_t>(ReportType::input)]);
+		caps.outputReportSize  = reportByteLength(bits[static_cast<size_t>(ReportType::output)]);
+		caps.featureReportSize = reportByteLength(bits[static_cast<size_t>(ReportType::feature)]);
+
+		return topLevelFound;
+	}
+}
+
+HidrawInstance::HidrawInstance(std::wstring path, std::wstring instanceId)
+	: HidInstance(std::move(path), std::move(instanceId)),
+	  wakeFd(eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK))
+{
+}
+
+HidrawInstance::HidrawInstance(std::wstring path)
+	: HidInstance(std::move(path)),
+	  wakeFd(eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK))
+{
+}
+
+HidrawInstance::~HidrawInstance()
+{
+	close();
+
+	if (wakeFd >= 0)
+	{
+		::close(wakeFd);
+	}
+}
+
+bool HidrawInstance::isOpen() const
+{
+	return fd >= 0;
+}
+
+bool HidrawInstance::readMetadata()
+{
+	// Everything is available through sysfs, so the device node itself never needs to be opened.
+	return (readCaps() | readAttributes() | readSerial());
+}
+
+bool HidrawInstance::readCaps()
+{
+	nativeError_ = 0;
+
+	const std::vector<uint8_t> descriptor = readFile(fs::path(sysfsPath()) / "report_descriptor");
+
+	if (descriptor.empty())
+	{
+		nativeError_ = ENOENT;
+		return false;
+	}
+
+	if (!parseReportDescriptor(descriptor, caps_, numberedReports_))
+	{
+		nativeError_ = EINVAL;
+		return false;
+	}
+
+	inputBuffer.resize(caps().inputReportSize);
+	outputBuffer.resize(caps().outputReportSize);
+
+	return true;
+}
+
+bool HidrawInstance::readSerial()
+{
+	nativeError_ = 0;
+
+	std::string uniq = readUevent("HID_UNIQ");
+
+	if (uniq.empty())
+	{
+		nativeError_ = ENOENT;
+		return false;
+	}
+
+	// Windows reports Bluetooth MAC addresses without separators.
+	uniq.erase(std::remove(uniq.begin(), uniq.end(), ':'), uniq.end());
+	serialString = std::wstring(uniq.begin(), uniq.end());
+
+	return true;
+}
+
+bool HidrawInstance::readAttributes()
+{
+	nativeError_ = 0;
+
+	// HID_ID=<bus>:<vendor>:<product>, all in hex
+	const std::string id = readUevent("HID_ID");
+
+	unsigned int bus = 0;
+	unsigned int vendor = 0;
+	unsigned int product = 0;
+
+	if (sscanf(id.c_str(), "%x:%x:%x", &bus, &vendor, &product) != 3)
+	{
+		nativeError_ = ENOENT;
+		return false;
+	}
+
+	attributes_.vendorId = static_cast<uint16_t>(vendor);
+	attributes_.productId = static_cast<uint16_t>(product);
+
+	// Only USB devices have a version number. Anything else (e.g. Bluetooth) may still have
+	// a USB device further up the tree, such as the adapter, whose version must not be used.
+	attributes_.versionNumber = bus == BUS_USB ? readUsbVersionNumber(sysfsPath()) : 0;
+
+	return true;
+}
+
+bool HidrawInstance::getFeature(const gsl::span<uint8_t>& buffer) const
+{
+	return featureRequest(HIDIOCGFEATURE(buffer.size_bytes()), buffer);
+}
+
+bool HidrawInstance::setFeature(const gsl::span<uint8_t>& buffer) const
+{
+	if (!isOpen())
+	{
+		return false;
+	}
+
+	return featureRequest(HIDIOCSFEATURE(buffer.size_bytes()), buffer);
+}
+
+bool HidrawInstance::open(HidOpenFlags_t openFlags)
+{
+	close();
+
+	nativeError_ = 0;
+
+	const int asyncFlags = !!(openFlags & HidOpenFlags::async) ? O_NONBLOCK : 0;
+
+	fd = ::open(nodePath().c_str(), O_RDWR | O_CLOEXEC | asyncFlags);
+
+	if (fd < 0)
+	{
+		nativeError_ = errno;
+		return false;
+	}
+
+	// hidraw has no share modes; an advisory lock is the closest
+	// equivalent and is honored by other well-behaved clients.
+	if (!!(openFlags & HidOpenFlags::exclusive) && flock(fd, LOCK_EX | LOCK_NB) != 0)
+	{
+		nativeError_ = errno;
+		::close(fd);
+		fd = -1;
+		return false;
+	}
+
+	flags = openFlags;
+	return true;
+}
+
+void HidrawInstance::close()
+{
+	if (isOpen())
+	{
+		// release anyone still waiting on the descriptor
+		interruptWait();
+
+		::close(fd);
+		fd = -1;
+	}
+
+	pendingRead_ = false;
+	pendingWrite_ = false;
+
+	flags = 0;
+}
+
+bool HidrawInstance::read(void* buffer, size_t size) const
+{
+	if (!isOpen() || !size)
+	{
+		return false;
+	}
+
+	auto* data = static_cast<uint8_t*>(buffer);
+
+	if (!numberedReports_)
+	{
+		*data++ = 0;
+		--size;
+	}
+
+	return ::read(fd, data, size) >= 0;
+}
+
+bool HidrawInstance::readAsync()
+{
+	// hidraw keeps its own queue of reports per open file, so
+	// each call simply takes the next one if there is any.
+	if (!isOpen())
+	{
+		pendingRead_ = false;
+		return false;
+	}
+
+	const IoResult result = tryRead();
+	pendingRead_ = result == IoResult::pending;
+	return result == IoResult::complete;
+}
+
+bool HidrawInstance::write(const void* buffer, size_t size) const
+{
+	if (!isOpen())
+	{
+		return false;
+	}
+
+	return ::write(fd, buffer, size) == static_cast<ssize_t>(size);
+}
+
+bool HidrawInstance::writeAsync()
+{
+	if (pendingWrite_)
+	{
+		return asyncWriteInProgress();
+	}
+
+	if (!isOpen())
+	{
+		return false;
+	}
+
+	pendingWrite_ = tryWrite() == IoResult::pending;
+	return !pendingWrite_;
+}
+
+bool HidrawInstance::asyncReadInProgress()
+{
+	if (!pendingRead_)
+	{
+		return false;
+	}
+
+	pendingRead_ = isOpen() && tryRead() == IoResult::pending;
+	return pendingRead_;
+}
+
+bool HidrawInstance::asyncWriteInProgress()
+{
+	if (!pendingWrite_)
+	{
+		return false;
+	}
+
+	pendingWrite_ = isOpen() && tryWrite() == IoResult::pending;
+	return pendingWrite_;
+}
+
+void HidrawInstance::cancelAsyncReadAndWait()
+{
+	// Nothing is queued in the kernel on our behalf; a pending
+	// read simply hasn't been retried yet.
+	pendingRead_ = false;
+}
+
+void HidrawInstance::cancelAsyncWriteAndWait()
+{
+	pendingWrite_ = false;
+}
+
+bool HidrawInstance::waitForRead(std::chrono::microseconds timeout)
+{
+	if (!isOpen() || !pendingRead_)
+	{
+		return true;
+	}
+
+	pollfd fds[] = {
+		{ fd, POLLIN, 0 },
+		{ wakeFd, POLLIN, 0 }
+	};
+
+	timespec ts {};
+
+	if (ppoll(fds, wakeFd >= 0 ? 2 : 1, toTimespec(timeout, ts), nullptr) <= 0)
+	{
+		return false;
+	}
+
+	if (fds[1].revents & POLLIN)
+	{
+		uint64_t value;
+		(void)::read(wakeFd, &value, sizeof(value));
+	}
+
+	// errors and hang-ups are reported as completions so that the next read observes them
+	return (fds[0].revents & (POLLIN | POLLERR | POLLHUP)) != 0;
+}
+
+void HidrawInstance::interruptWait()
+{
+	if (wakeFd >= 0)
+	{
+		const uint64_t value = 1;
+		(void)::write(wakeFd, &value, sizeof(value));
+	}
+}
+
+bool HidrawInstance::setOutputReport(const gsl::span<uint8_t>& buffer) const
+{
+	if (!isOpen())
+	{
+		return false;
+	}
+
+	if (::write(fd, buffer.data(), buffer.size_bytes()) >= 0)
+	{
+		return true;
+	}
+
+	// A full queue only drops this report; the next one supersedes it.
+	if (errno == EAGAIN || errno == EWOULDBLOCK)
+	{
+		return true;
+	}
+
+	nativeError_ = errno;
+	return false;
+}
+
+std::string HidrawInstance::nodePath() const
+{
+	return fs::path(path).string();
+}
+
+std::string HidrawInstance::sysfsPath() const
+{
+	return (fs::path("/sys/class/hidraw") / fs::path(path).filename() / "device").string();
+}
+
+std::string HidrawInstance::readUevent(const std::string& key) const
+{
+	std::ifstream file(fs::path(sysfsPath()) / "uevent");
+	const std::string prefix = key + "=";
+
+	for (std::string line; std::getline(file, line);)
+	{
+		if (line.compare(0, prefix.size(), prefix) == 0)
+		{
+			return line.substr(prefix.size());
+		}
+	}
+
+	return std::string();
+}
+
+HidrawInstance::IoResult HidrawInstance::tryRead()
+{
+	uint8_t* data = inputBuffer.data();
+	size_t size = inputBuffer.size();
+
+	// Unnumbered reports are read without the leading zero byte
+	// that every other backend (and the caller) expects.
+	if (!numberedReports_ && size > 0)
+	{
+		*data++ = 0;
+		--size;
+	}
+
+	if (::read(fd, data, size) >= 0)
+	{
+		return IoResult::complete;
+	}
+
+	const int error = errno;
+
+	if (error == EAGAIN || error == EWOULDBLOCK || error == EINTR)
+	{
+		return IoResult::pending;
+	}
+
+	close();
+	nativeError_ = error;
+	return IoResult::failed;
+}
+
+HidrawInstance::IoResult HidrawInstance::tryWrite()
+{
+	if (::write(fd, outputBuffer.data(), outputBuffer.size()) >= 0)
+	{
+		return IoResult::complete;
+	}
+
+	const int error = errno;
+
+	if (error == EAGAIN || error == EWOULDBLOCK || error == EINTR)
+	{
+		return IoResult::pending;
+	}
+
+	close();
+	nativeError_ = error;
+	return IoResult::failed;
+}
+
+bool HidrawInstance::featureRequest(unsigned long request, const gsl::span<uint8_t>& buffer) const
+{
+	nativeError_ = 0;
+
+	int target = fd;
+
+	if (!isOpen())
+	{
+		target = ::open(nodePath().c_str(), O_RDWR | O_CLOEXEC);
+
+		if (target < 0)
+		{
+			nativeError_ = errno;
+			return false;
+		}
+	}
+
+	const bool result = ioctl(target, request, buffer.data()) >= 0;
+
+	if (!result)
+	{
+		nativeError_ = errno;
+	}
+
+	if (target != fd)
+	{
+		::close(target);
+	}
+
+	return result;
+}
+
+const char* HidrawBackend::name() const
+{
+	return "hidraw";
+}
+
+std::shared_ptr<HidInstance> HidrawBackend::create(const std::wstring& path, const std::wstring& instanceId)
+{
+	return std::make_shared<HidrawInstance>(path, instanceId);
+}
+
+void HidrawBackend::enumerate(const std::function<bool(const std::wstring& path, const std::wstring& instanceId)>& fn)
+{
+	std::error_code ec;
+	std::vector<fs::path> nodes;
+
+	for (const auto& entry : fs::directory_iterator("/sys/class/hidraw", ec))
+	{
+		nodes.push_back(entry.path());
+	}
+
+	// directory order is arbitrary; keep enumeration stable
+	std::sort(nodes.begin(), nodes.end());
+
+	for (const auto& node : nodes)
+	{
+		const fs::path devicePath = fs::path("/dev") / node.filename();
+		const fs::path instancePath = fs::canonical(node / "device", ec);
+
+		if (fn(devicePath.wstring(), ec ? std::wstring() : instancePath.wstring()))
+		{
+			break;
+		}
+	}
+}
+
+bool HidrawBackend::waitAny(const std::vector<HidInstance*>& instances, std::chrono::microseconds timeout, std::vector<HidInstance*>& ready)
+{
+	ready.clear();
+
+	// reused between calls so that waiting doesn't allocate
+	thread_local std::vector<pollfd> fds;
+	fds.clear();
+
+	for (HidInstance* instance : instances)
+	{
+		const auto hidraw = static_cast<HidrawInstance*>(instance);
+
+		if (!hidraw->isOpen() || !hidraw->pendingRead_)
+		{
+			ready.push_back(instance);
+			continue;
+		}
+
+		fds.push_back({ hidraw->fd, POLLIN, 0 });
+		fds.push_back({ hidraw->wakeFd, POLLIN, 0 });
+	}
+
+	if (!ready.empty() || fds.empty())
+	{
+		return !ready.empty();
+	}
+
+	timespec ts {};
+
+	if (ppoll(fds.data(), fds.size(), toTimespec(timeout, ts), nullptr) <= 0)
+	{
+		return false;
+	}
+
+	for (size_t i = 0; i < fds.size(); i += 2)
+	{
+		HidInstance* instance = instances[i / 2];
+		const auto hidraw = static_cast<HidrawInstance*>(instance);
+
+		if (fds[i + 1].revents & POLLIN)
+		{
+			uint64_t value;
+			(void)::read(hidraw->wakeFd, &value, sizeof(value));
+		}
+
+		if ((fds[i].revents & (POLLIN | POLLERR | POLLHUP)) || (fds[i + 1].revents & POLLIN))
+		{
+			ready.push_back(instance);
+		}
+	}
+
+	return !ready.empty();
+}
+
+#endif
@@ -0,0 +1,97 @@
+#pragma once
+
+#ifdef __linux__
+
+#include <string>
+
+#include "hid_backend.h"
+#include "hid_instance.h"
+
+namespace hid
+{
+	/**
+	 * \brief \c HidInstance implemented on top of the Linux \c /dev/hidraw interface.
+	 * Asynchronous I/O uses non-blocking file descriptors; metadata is read from sysfs.
+	 */
+	class HidrawInstance : public HidInstance
+	{
+		friend class HidrawBackend;
+
+		enum class IoResult
+		{
+			complete,
+			pending,
+			failed
+		};
+
+		int fd = -1;
+		int wakeFd = -1;
+		bool numberedReports_ = false;
+
+	public:
+		HidrawInstance(std::wstring path, std::wstring instanceId);
+		explicit HidrawInstance(std::wstring path);
+
+		~HidrawInstance() override;
+
+		bool isOpen() const override;
+
+		bool readMetadata() override;
+		bool readCaps() override;
+		bool readSerial() override;
+		bool readAttributes() override;
+		bool getFeature(const gsl::span<uint8_t>& buffer) const override;
+		bool setFeature(const gsl::span<uint8_t>& buffer) const override;
+
+		bool open(HidOpenFlags_t openFlags) override;
+		void close() override;
+
+		using HidInstance::read;
+		bool read(void* buffer, size_t size) const override;
+
+		bool readAsync() override;
+
+		using HidInstance::write;
+		bool write(const void* buffer, size_t size) const override;
+
+		bool writeAsync() override;
+
+		bool asyncReadInProgress() override;
+		bool asyncWriteInProgress() override;
+
+		void cancelAsyncReadAndWait() override;
+		void cancelAsyncWriteAndWait() override;
+
+		bool waitForRead(std::chrono::microseconds timeout) override;
+		void interruptWait() override;
+
+		using HidInstance::setOutputReport;
+		bool setOutputReport(const gsl::span<uint8_t>& buffer) const override;
+
+	private:
+		std::string nodePath() const;
+		std::string sysfsPath() const;
+		std::string readUevent(const std::string& key) const;
+
+		IoResult tryRead();
+		IoResult tryWrite();
+
+		bool featureRequest(unsigned long request, const gsl::span<uint8_t>& buffer) const;
+	};
+
+	/**
+	 * \brief Enumerates \c /sys/class/hidraw and creates \c HidrawInstance objects.
+	 */
+	class HidrawBackend : public HidBackend
+	{
+	public:
+		const char* name() const override;
+
+		using HidBackend::create;
+		std::shared_ptr<HidInstance> create(const std::wstring& path, const std::wstring& instanceId) override;
+		void enumerate(const std::function<bool(const std::wstring& path, const std::wstring& instanceId)>& fn) override;
+		bool waitAny(const std::vector<HidInstance*>& instances, std::chrono::microseconds timeout, std::vector<HidInstance*>& ready) override;
+	};
+}
+
+#endif
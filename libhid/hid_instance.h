@@ -1,13 +1,11 @@
 #pragma once
 
-#include <Windows.h>
-
+#include <chrono>
 #include <cstdint>
 #include <string>
 #include <vector>
 
 #include <gsl/span>
-#include "hid_handle.h"
 
 namespace hid
 {
@@ -46,25 +44,32 @@ namespace hid
 	{
 		uint16_t vendorId;
 		uint16_t productId;
+
+		/**
+		 * \brief The device release number in binary-coded decimal.
+		 * The hidraw backend reads it from the parent USB device, so it is \c 0 for devices
+		 * that aren't connected over USB, e.g. over Bluetooth.
+		 */
 		uint16_t versionNumber;
 	};
 
+	/**
+	 * \brief Platform-neutral interface to a single HID device.
+	 * Each \c HidBackend provides its own implementation.
+	 * \sa HidBackend
+	 */
 	class HidInstance
 	{
+	protected:
 		HidOpenFlags_t flags = 0;
 
-		Handle handle = Handle(nullptr, true);
-
 		HidCaps caps_ {};
 		HidAttributes attributes_ {};
 
-		OVERLAPPED overlappedIn = {};
-		OVERLAPPED overlappedOut = {};
-
 		bool pendingRead_ = false;
 		bool pendingWrite_ = false;
 
-		size_t nativeError_ = 0;
+		mutable size_t nativeError_ = 0;
 
 	public:
 		std::wstring path;
@@ -81,62 +86,78 @@ namespace hid
 
 		HidInstance(std::wstring path, std::wstring instanceId);
 		explicit HidInstance(std::wstring path);
-		HidInstance(HidInstance&& other) noexcept;
-
-		~HidInstance();
 
-		HidInstance& operator=(HidInstance&& other) noexcept;
+		virtual ~HidInstance() = default;
 
-		bool isOpen() const;
+		virtual bool isOpen() const = 0;
 		bool isExclusive() const;
 		bool isAsync() const;
 		const HidCaps& caps() const;
 		const HidAttributes& attributes() const;
 
-		bool readMetadata();
-		bool readCaps();
-		bool readSerial();
-		bool readAttributes();
-		bool getFeature(const gsl::span<uint8_t>& buffer) const;
-		bool setFeature(const gsl::span<uint8_t>& buffer) const;
+		virtual bool readMetadata() = 0;
+		virtual bool readCaps() = 0;
+		virtual bool readSerial() = 0;
+		virtual bool readAttributes() = 0;
+		virtual bool getFeature(const gsl::span<uint8_t>& buffer) const = 0;
+		virtual bool setFeature(const gsl::span<uint8_t>& buffer) const = 0;
 
-		bool open(HidOpenFlags_t openFlags);
-		void close();
+		virtual bool open(HidOpenFlags_t openFlags) = 0;
+		virtual void close() = 0;
 
+		/**
+		 * \brief The last error reported by the native API, e.g. \c GetLastError on Windows or \c errno on Linux.
+		 */
 		inline auto nativeError() const
 		{
 			return nativeError_;
 		}
 
-		bool read(void* buffer, size_t size) const;
+		virtual bool read(void* buffer, size_t size) const = 0;
 		bool read(const gsl::span<uint8_t>& buffer) const;
 		bool read();
 
-		bool readAsync();
+		/**
+		 * \brief Collects the oldest completed asynchronous read into \c inputBuffer,
+		 * posting new reads as needed. Backends queue reports that arrive in the meantime,
+		 * so calling this until it returns \c false drains every report received so far.
+		 * \return \c true if a report was copied into \c inputBuffer.
+		 */
+		virtual bool readAsync() = 0;
 
-		bool write(const void* buffer, size_t size) const;
+		virtual bool write(const void* buffer, size_t size) const = 0;
 		bool write(const gsl::span<const uint8_t>& buffer) const;
 		bool write() const;
 
-		bool writeAsync();
+		virtual bool writeAsync() = 0;
 
 		bool asyncReadPending() const;
-		bool asyncReadInProgress();
+		virtual bool asyncReadInProgress() = 0;
 		bool asyncWritePending() const;
-		bool asyncWriteInProgress();
-
-		void cancelAsyncReadAndWait();
-		void cancelAsyncWriteAndWait();
-
-		bool setOutputReport(const gsl::span<uint8_t>& buffer) const;
+		virtual bool asyncWriteInProgress() = 0;
+
+		virtual void cancelAsyncReadAndWait() = 0;
+		virtual void cancelAsyncWriteAndWait() = 0;
+
+		/**
+		 * \brief Timeout for \c waitForRead which never expires.
+		 */
+		static constexpr std::chrono::microseconds infiniteWait = std::chrono::microseconds::max();
+
+		/**
+		 * \brief Blocks until a pending asynchronous read completes, \c interruptWait is called, or \p timeout elapses.
+		 * Returns immediately if no read is pending or the device is closed.
+		 * \param timeout Maximum time to wait, or \c infiniteWait.
+		 * \return \c true if the pending read should be checked for completion; \c false on timeout or interruption.
+		 */
+		virtual bool waitForRead(std::chrono::microseconds timeout) = 0;
+
+		/**
+		 * \brief Wakes a thread blocked in \c waitForRead. May be called from any thread.
+		 */
+		virtual void interruptWait() = 0;
+
+		virtual bool setOutputReport(const gsl::span<uint8_t>& buffer) const = 0;
 		bool setOutputReport();
-
-	private:
-		void cancelAsyncAndWait(OVERLAPPED* overlapped);
-		bool asyncInProgress(OVERLAPPED* overlapped);
-
-		bool readCaps(HANDLE h);
-		bool readSerial(HANDLE h);
-		bool readAttributes(HANDLE h);
 	};
 }
@@ -0,0 +1,742 @@
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+#include "hid_loopback.h"
+
+using namespace hid;
+
+namespace
+{
+	/**
+	 * \brief Sleeps until \p poll reports an instance as ready, the earliest due report
+	 * it returns becomes due, or \p timeout elapses. Under a virtual clock, time cannot
+	 * pass while waiting, so this only polls once.
+	 */
+	template <typename Poll>
+	bool waitLoopback(LoopbackClock& clock, std::chrono::microseconds timeout, Poll poll)
+	{
+		using steady = std::chrono::steady_clock;
+
+		const steady::time_point deadline = timeout == HidInstance::infiniteWait
+		                                    ? steady::time_point::max()
+		                                    : steady::now() + timeout;
+
+		while (true)
+		{
+			const uint64_t generation = clock.generation();
+			LoopbackClock::duration due = LoopbackClock::duration::max();
+
+			if (poll(due))
+			{
+				return true;
+			}
+
+			if (clock.mode() != LoopbackClock::Mode::realTime)
+			{
+				// nothing else can make the clock move while we wait
+				return clock.mode() == LoopbackClock::Mode::fastForward;
+			}
+
+			steady::time_point until = deadline;
+
+			if (due != LoopbackClock::duration::max())
+			{
+				const auto remaining = std::chrono::duration_cast<steady::duration>(due - clock.now());
+				until = std::min(until, steady::now() + remaining);
+			}
+
+			if (!clock.wait(generation, until) && until == deadline)
+			{
+				return false;
+			}
+		}
+	}
+}
+
+LoopbackClock::LoopbackClock(Mode mode)
+	: mode_(Mode::manual)
+{
+	setMode(mode);
+}
+
+LoopbackClock::Mode LoopbackClock::mode() const
+{
+	return mode_;
+}
+
+void LoopbackClock::setMode(Mode value)
+{
+	// fold real time that has already passed into the tick count
+	ticks = now().count();
+	epoch = steadyTicks();
+	mode_ = value;
+}
+
+LoopbackClock::duration LoopbackClock::now() const
+{
+	if (mode_ == Mode::realTime)
+	{
+		return duration(ticks + (steadyTicks() - epoch));
+	}
+
+	return duration(ticks);
+}
+
+void LoopbackClock::set(duration value)
+{
+	ticks = value.count();
+	epoch = steadyTicks();
+	notify();
+}
+
+void LoopbackClock::advance(duration amount)
+{
+	ticks += amount.count();
+	notify();
+}
+
+void LoopbackClock::notify()
+{
+	{
+		std::lock_guard<std::mutex> guard(signalLock);
+		++generation_;
+	}
+
+	signal.notify_all();
+}
+
+uint64_t LoopbackClock::generation() const
+{
+	std::lock_guard<std::mutex> guard(signalLock);
+	return generation_;
+}
+
+bool LoopbackClock::wait(uint64_t generation, std::chrono::steady_clock::time_point until)
+{
+	std::unique_lock<std::mutex> guard(signalLock);
+
+	const auto notified = [&]() { return generation_ != generation; };
+
+	if (until == std::chrono::steady_clock::time_point::max())
+	{
+		signal.wait(guard, notified);
+		return true;
+	}
+
+	return signal.wait_until(guard, until, notified);
+}
+
+int64_t LoopbackClock::steadyTicks()
+{
+	return std::chrono::duration_cast<duration>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+LoopbackDevice::LoopbackDevice(std::shared_ptr<LoopbackClock> clock)
+	: clock(std::move(clock))
+{
+}
+
+void LoopbackDevice::queueInput(LoopbackClock::duration time, std::vector<uint8_t> data)
+{
+	{
+		std::lock_guard<std::mutex> guard(sync);
+		inputScript.push_back({ time, std::move(data) });
+	}
+
+	clock->notify();
+}
+
+void LoopbackDevice::setInputScript(std::vector<LoopbackReport> script, bool loop, LoopbackClock::duration period)
+{
+	{
+		std::lock_guard<std::mutex> guard(sync);
+
+		inputScript = std::move(script);
+		scriptPosition = 0;
+		loopOffset = {};
+		looping = loop;
+
+		if (looping && !inputScript.empty())
+		{
+			loopPeriod = inputScript.back().time - inputScript.front().time + period;
+		}
+	}
+
+	clock->notify();
+}
+
+size_t LoopbackDevice::pendingInputCount() const
+{
+	std::lock_guard<std::mutex> guard(sync);
+	return inputScript.size() - scriptPosition;
+}
+
+void LoopbackDevice::setFeatureResponse(std::vector<uint8_t> data)
+{
+	if (data.empty())
+	{
+		return;
+	}
+
+	std::lock_guard<std::mutex> guard(sync);
+
+	const uint8_t reportId = data[0];
+	featureResponses[reportId] = std::move(data);
+}
+
+std::vector<LoopbackReport> LoopbackDevice::outputReports() const
+{
+	std::lock_guard<std::mutex> guard(sync);
+	return outputReports_;
+}
+
+std::vector<LoopbackReport> LoopbackDevice::featureReports() const
+{
+	std::lock_guard<std::mutex> guard(sync);
+	return featureReports_;
+}
+
+size_t LoopbackDevice::outputCount() const
+{
+	std::lock_guard<std::mutex> guard(sync);
+	return outputCount_;
+}
+
+size_t LoopbackDevice::featureCount() const
+{
+	std::lock_guard<std::mutex> guard(sync);
+	return featureCount_;
+}
+
+void LoopbackDevice::clearRecorded()
+{
+	std::lock_guard<std::mutex> guard(sync);
+
+	outputReports_.clear();
+	featureReports_.clear();
+	outputCount_ = 0;
+	featureCount_ = 0;
+}
+
+bool LoopbackDevice::connected() const
+{
+	std::lock_guard<std::mutex> guard(sync);
+	return connected_;
+}
+
+void LoopbackDevice::disconnect()
+{
+	{
+		std::lock_guard<std::mutex> guard(sync);
+		connected_ = false;
+	}
+
+	clock->notify();
+}
+
+void LoopbackDevice::reconnect()
+{
+	{
+		std::lock_guard<std::mutex> guard(sync);
+		connected_ = true;
+	}
+
+	clock->notify();
+}
+
+std::optional<LoopbackClock::duration> LoopbackDevice::nextInputTime() const
+{
+	if (scriptPosition < inputScript.size())
+	{
+		return inputScript[scriptPosition].time + loopOffset;
+	}
+
+	if (looping && !inputScript.empty())
+	{
+		return inputScript.front().time + loopOffset + loopPeriod;
+	}
+
+	return std::nullopt;
+}
+
+bool LoopbackDevice::readInput(uint8_t* buffer, size_t size)
+{
+	std::lock_guard<std::mutex> guard(sync);
+
+	if (scriptPosition >= inputScript.size())
+	{
+		if (!looping || inputScript.empty())
+		{
+			return false;
+		}
+
+		scriptPosition = 0;
+		loopOffset += loopPeriod;
+	}
+
+	const LoopbackReport& report = inputScript[scriptPosition];
+	const LoopbackClock::duration time = report.time + loopOffset;
+
+	if (time > clock->now())
+	{
+		if (clock->mode() != LoopbackClock::Mode::fastForward)
+		{
+			return false;
+		}
+
+		clock->set(time);
+	}
+
+	const size_t length = std::min(size, report.data.size());
+	std::memcpy(buffer, report.data.data(), length);
+	std::memset(buffer + length, 0, size - length);
+
+	++scriptPosition;
+	return true;
+}
+
+void LoopbackDevice::record(std::vector<LoopbackReport>& reports, size_t& count, const uint8_t* data, size_t size)
+{
+	std::lock_guard<std::mutex> guard(sync);
+
+	++count;
+
+	if (recordReports)
+	{
+		reports.push_back({ clock->now(), std::vector<uint8_t>(data, data + size) });
+	}
+}
+
+LoopbackInstance::LoopbackInstance(std::shared_ptr<LoopbackDevice> device)
+	: HidInstance(device->path, device->instanceId),
+	  device(std::move(device))
+{
+}
+
+LoopbackInstance::~LoopbackInstance()
+{
+	close();
+}
+
+bool LoopbackInstance::isOpen() const
+{
+	return open_;
+}
+
+bool LoopbackInstance::readMetadata()
+{
+	return (readCaps() | readAttributes() | readSerial());
+}
+
+bool LoopbackInstance::readCaps()
+{
+	if (!checkConnected())
+	{
+		return false;
+	}
+
+	caps_ = device->caps;
+
+	inputBuffer.resize(caps().inputReportSize);
+	outputBuffer.resize(caps().outputReportSize);
+
+	return true;
+}
+
+bool LoopbackInstance::readSerial()
+{
+	if (!checkConnected())
+	{
+		return false;
+	}
+
+	serialString = device->serialString;
+	return !serialString.empty();
+}
+
+bool LoopbackInstance::readAttributes()
+{
+	if (!checkConnected())
+	{
+		return false;
+	}
+
+	attributes_ = device->attributes;
+	return true;
+}
+
+bool LoopbackInstance::getFeature(const gsl::span<uint8_t>& buffer) const
+{
+	if (buffer.empty() || !checkConnected())
+	{
+		return false;
+	}
+
+	device->record(device->featureReports_, device->featureCount_, buffer.data(), buffer.size_bytes());
+
+	std::lock_guard<std::mutex> guard(device->sync);
+
+	const auto it = device->featureResponses.find(buffer[0]);
+
+	if (it != device->featureResponses.end())
+	{
+		const size_t length = std::min(buffer.size(), it->second.size());
+		std::memcpy(buffer.data(), it->second.data(), length);
+	}
+
+	return true;
+}
+
+bool LoopbackInstance::setFeature(const gsl::span<uint8_t>& buffer) const
+{
+	if (!isOpen() || !checkConnected())
+	{
+		return false;
+	}
+
+	device->record(device->featureReports_, device->featureCount_, buffer.data(), buffer.size_bytes());
+	return true;
+}
+
+bool LoopbackInstance::open(HidOpenFlags_t openFlags)
+{
+	close();
+
+	if (!checkConnected())
+	{
+		return false;
+	}
+
+	const bool exclusive = !!(openFlags & HidOpenFlags::exclusive);
+
+	{
+		std::lock_guard<std::mutex> guard(device->sync);
+
+		// mimic Windows share modes: exclusive access requires that nobody else has the device open
+		if (device->openedExclusive || (exclusive && device->openCount > 0))
+		{
+			nativeError_ = 32; // ERROR_SHARING_VIOLATION
+			return false;
+		}
+
+		++device->openCount;
+		device->openedExclusive = exclusive;
+	}
+
+	nativeError_ = 0;
+	flags = openFlags;
+	open_ = true;
+
+	return true;
+}
+
+void LoopbackInstance::close()
+{
+	if (open_)
+	{
+		interruptWait();
+
+		std::lock_guard<std::mutex> guard(device->sync);
+
+		--device->openCount;
+
+		if (isExclusive())
+		{
+			device->openedExclusive = false;
+		}
+	}
+
+	open_ = false;
+	pendingRead_ = false;
+	pendingWrite_ = false;
+	flags = 0;
+}
+
+bool LoopbackInstance::read(void* buffer, size_t size) const
+{
+	if (!isOpen())
+	{
+		return false;
+	}
+
+	return tryRead(static_cast<uint8_t*>(buffer), size);
+}
+
+bool LoopbackInstance::readAsync()
+{
+	if (!isOpen())
+	{
+		pendingRead_ = false;
+		return false;
+	}
+
+	const bool result = tryRead(inputBuffer.data(), inputBuffer.size());
+
+	pendingRead_ = !result && isOpen();
+	return result;
+}
+
+bool LoopbackInstance::write(const void* buffer, size_t size) const
+{
+	if (!isOpen() || !checkConnected())
+	{
+		return false;
+	}
+
+	device->record(device->outputReports_, device->outputCount_, static_cast<const uint8_t*>(buffer), size);
+	return true;
+}
+
+bool LoopbackInstance::writeAsync()
+{
+	pendingWrite_ = false;
+
+	if (!isOpen())
+	{
+		return false;
+	}
+
+	if (!write(outputBuffer))
+	{
+		close();
+		return false;
+	}
+
+	return true;
+}
+
+bool LoopbackInstance::asyncReadInProgress()
+{
+	if (!pendingRead_)
+	{
+		return false;
+	}
+
+	pendingRead_ = isOpen() && !tryRead(inputBuffer.data(), inputBuffer.size()) && isOpen();
+	return pendingRead_;
+}
+
+bool LoopbackInstance::asyncWriteInProgress()
+{
+	// writes complete immediately
+	return false;
+}
+
+void LoopbackInstance::cancelAsyncReadAndWait()
+{
+	pendingRead_ = false;
+}
+
+void LoopbackInstance::cancelAsyncWriteAndWait()
+{
+	pendingWrite_ = false;
+}
+
+bool LoopbackInstance::waitForRead(std::chrono::microseconds timeout)
+{
+	if (!isOpen() || !pendingRead_)
+	{
+		return true;
+	}
+
+	LoopbackInstance* instance = this;
+
+	return waitLoopback(*device->clock, timeout, [&](LoopbackClock::duration& due)
+	{
+		return instance->readyForRead(due);
+	}) && !consumeWake();
+}
+
+void LoopbackInstance::interruptWait()
+{
+	{
+		std::lock_guard<std::mutex> guard(device->sync);
+		wakeRequested = true;
+	}
+
+	device->clock->notify();
+}
+
+bool LoopbackInstance::readyForRead(LoopbackClock::duration& due)
+{
+	std::lock_guard<std::mutex> guard(device->sync);
+
+	if (wakeRequested || !device->connected_ || !isOpen() || !pendingRead_)
+	{
+		return true;
+	}
+
+	const std::optional<LoopbackClock::duration> next = device->nextInputTime();
+
+	if (!next.has_value())
+	{
+		return false;
+	}
+
+	if (*next <= device->clock->now())
+	{
+		return true;
+	}
+
+	due = std::min(due, *next);
+	return false;
+}
+
+bool LoopbackInstance::consumeWake()
+{
+	std::lock_guard<std::mutex> guard(device->sync);
+
+	const bool result = wakeRequested;
+	wakeRequested = false;
+	return result;
+}
+
+bool LoopbackInstance::setOutputReport(const gsl::span<uint8_t>& buffer) const
+{
+	return write(buffer.data(), buffer.size_bytes());
+}
+
+bool LoopbackInstance::tryRead(uint8_t* buffer, size_t size) const
+{
+	if (!checkConnected())
+	{
+		// like a real device, an unplugged device closes its handle
+		const_cast<LoopbackInstance*>(this)->close();
+		return false;
+	}
+
+	return device->readInput(buffer, size);
+}
+
+bool LoopbackInstance::checkConnected() const
+{
+	if (device->connected())
+	{
+		return true;
+	}
+
+	nativeError_ = disconnectedError;
+	return false;
+}
+
+LoopbackBackend::LoopbackBackend(std::shared_ptr<LoopbackClock> clock)
+	: clock(std::move(clock))
+{
+}
+
+const char* LoopbackBackend::name() const
+{
+	return "loopback";
+}
+
+std::shared_ptr<HidInstance> LoopbackBackend::create(const std::wstring& path, const std::wstring& instanceId)
+{
+	auto device = find(path);
+
+	if (device == nullptr)
+	{
+		// an unknown path behaves like a device that was unplugged before it could be opened
+		device = std::make_shared<LoopbackDevice>(clock);
+		device->path = path;
+		device->instanceId = instanceId;
+		device->disconnect();
+	}
+
+	return std::make_shared<LoopbackInstance>(std::move(device));
+}
+
+void LoopbackBackend::enumerate(const std::function<bool(const std::wstring& path, const std::wstring& instanceId)>& fn)
+{
+	for (const auto& device : devices())
+	{
+		if (!device->connected())
+		{
+			continue;
+		}
+
+		if (fn(device->path, device->instanceId))
+		{
+			break;
+		}
+	}
+}
+
+bool LoopbackBackend::waitAny(const std::vector<HidInstance*>& instances, std::chrono::microseconds timeout, std::vector<HidInstance*>& ready)
+{
+	ready.clear();
+
+	if (instances.empty())
+	{
+		return false;
+	}
+
+	const bool woken = waitLoopback(*clock, timeout, [&](LoopbackClock::duration& due)
+	{
+		for (HidInstance* instance : instances)
+		{
+			if (static_cast<LoopbackInstance*>(instance)->readyForRead(due))
+			{
+				ready.push_back(instance);
+			}
+		}
+
+		return !ready.empty();
+	});
+
+	if (woken && ready.empty())
+	{
+		// fast-forward: every instance gets to jump to its next report
+		ready.assign(instances.begin(), instances.end());
+	}
+
+	for (HidInstance* instance : ready)
+	{
+		static_cast<LoopbackInstance*>(instance)->consumeWake();
+	}
+
+	return !ready.empty();
+}
+
+std::shared_ptr<LoopbackDevice> LoopbackBackend::addDevice(HidCaps caps, HidAttributes attributes, std::wstring serialString, std::wstring path)
+{
+	auto device = std::make_shared<LoopbackDevice>(clock);
+
+	device->caps = caps;
+	device->attributes = attributes;
+	device->serialString = std::move(serialString);
+
+	std::lock_guard<std::mutex> guard(sync);
+
+	device->path = path.empty() ? L"loopback:" + std::to_wstring(devices_.size()) : std::move(path);
+	device->instanceId = device->path;
+
+	devices_.push_back(device);
+	return device;
+}
+
+void LoopbackBackend::removeDevice(const std::shared_ptr<LoopbackDevice>& device)
+{
+	device->disconnect();
+
+	std::lock_guard<std::mutex> guard(sync);
+	devices_.erase(std::remove(devices_.begin(), devices_.end(), device), devices_.end());
+}
+
+std::vector<std::shared_ptr<LoopbackDevice>> LoopbackBackend::devices() const
+{
+	std::lock_guard<std::mutex> guard(sync);
+	return devices_;
+}
+
+std::shared_ptr<LoopbackDevice> LoopbackBackend::find(const std::wstring& path) const
+{
+	std::lock_guard<std::mutex> guard(sync);
+
+	const auto it = std::find_if(devices_.begin(), devices_.end(), [&](const auto& device)
+	{
+		return device->path == path;
+	});
+
+	return it == devices_.end() ? nullptr : *it;
+}
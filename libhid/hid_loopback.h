@@ -0,0 +1,269 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "hid_backend.h"
+#include "hid_instance.h"
+
+namespace hid
+{
+	/**
+	 * \brief Clock shared by a \c LoopbackBackend and its devices.
+	 * Scripted input reports become readable once the clock reaches their time stamp.
+	 */
+	class LoopbackClock
+	{
+	public:
+		using duration = std::chrono::nanoseconds;
+
+		enum class Mode
+		{
+			/** \brief Time only moves when \c advance or \c set is called. */
+			manual,
+			/** \brief Time follows \c std::chrono::steady_clock from the moment the mode was set. */
+			realTime,
+			/** \brief Like \c manual, but a read that finds no due report jumps straight to the next one. */
+			fastForward
+		};
+
+		explicit LoopbackClock(Mode mode = Mode::manual);
+
+		Mode mode() const;
+		void setMode(Mode value);
+
+		duration now() const;
+		void set(duration value);
+		void advance(duration amount);
+
+		/**
+		 * \brief Wakes threads waiting for input on any device that shares this clock.
+		 */
+		void notify();
+
+		/**
+		 * \brief Current notification count; pass it to \c wait to avoid missing a \c notify.
+		 */
+		uint64_t generation() const;
+
+		/**
+		 * \brief Waits until \c notify is called after \p generation was read, or until \p until.
+		 * \return \c true if notified.
+		 */
+		bool wait(uint64_t generation, std::chrono::steady_clock::time_point until);
+
+	private:
+		std::atomic<Mode> mode_;
+		std::atomic<int64_t> ticks = 0;
+		std::atomic<int64_t> epoch = 0;
+
+		mutable std::mutex signalLock;
+		std::condition_variable signal;
+		uint64_t generation_ = 0;
+
+		static int64_t steadyTicks();
+	};
+
+	struct LoopbackReport
+	{
+		LoopbackClock::duration time;
+		std::vector<uint8_t> data;
+	};
+
+	/**
+	 * \brief A scripted device. Outlives the \c LoopbackInstance objects that are opened on it,
+	 * so scripts and recordings survive the create/open/close cycle of the code under test.
+	 */
+	class LoopbackDevice
+	{
+		friend class LoopbackInstance;
+
+		mutable std::mutex sync;
+		std::shared_ptr<LoopbackClock> clock;
+
+		std::vector<LoopbackReport> inputScript;
+		size_t scriptPosition = 0;
+		LoopbackClock::duration loopOffset {};
+		LoopbackClock::duration loopPeriod {};
+		bool looping = false;
+
+		std::map<uint8_t, std::vector<uint8_t>> featureResponses;
+
+		std::vector<LoopbackReport> outputReports_;
+		std::vector<LoopbackReport> featureReports_;
+		size_t outputCount_ = 0;
+		size_t featureCount_ = 0;
+
+		bool connected_ = true;
+		size_t openCount = 0;
+		bool openedExclusive = false;
+
+	public:
+		std::wstring path;
+		std::wstring instanceId;
+		std::wstring serialString;
+
+		HidCaps caps {};
+		HidAttributes attributes {};
+
+		/**
+		 * \brief If \c false, written reports are only counted, not stored.
+		 */
+		std::atomic<bool> recordReports = true;
+
+		explicit LoopbackDevice(std::shared_ptr<LoopbackClock> clock);
+
+		/**
+		 * \brief Queues an input report to be returned once the clock reaches \p time.
+		 * Reports must be queued in chronological order.
+		 */
+		void queueInput(LoopbackClock::duration time, std::vector<uint8_t> data);
+
+		/**
+		 * \brief Replaces the input queue with \p script. If \p loop is \c true, the script
+		 * restarts (shifted by its own length plus \p period) whenever it runs out, which
+		 * allows open-ended runs without allocating per report.
+		 * \param period Time between the last and the first report when looping.
+		 */
+		void setInputScript(std::vector<LoopbackReport> script, bool loop, LoopbackClock::duration period = {});
+
+		/**
+		 * \brief Number of queued input reports that have not been read yet.
+		 */
+		size_t pendingInputCount() const;
+
+		/**
+		 * \brief Sets the data returned by \c HidInstance::getFeature for report ID \p data[0].
+		 */
+		void setFeatureResponse(std::vector<uint8_t> data);
+
+		std::vector<LoopbackReport> outputReports() const;
+		std::vector<LoopbackReport> featureReports() const;
+		size_t outputCount() const;
+		size_t featureCount() const;
+		void clearRecorded();
+
+		bool connected() const;
+
+		/**
+		 * \brief Simulates unplugging the device; open instances fail their next I/O.
+		 */
+		void disconnect();
+		void reconnect();
+
+	private:
+		std::optional<LoopbackClock::duration> nextInputTime() const;
+		bool readInput(uint8_t* buffer, size_t size);
+		void record(std::vector<LoopbackReport>& reports, size_t& count, const uint8_t* data, size_t size);
+	};
+
+	/**
+	 * \brief \c HidInstance that reads from and writes to a \c LoopbackDevice.
+	 */
+	class LoopbackInstance : public HidInstance
+	{
+		friend class LoopbackBackend;
+
+		std::shared_ptr<LoopbackDevice> device;
+		bool open_ = false;
+		bool wakeRequested = false; // guarded by device->sync
+
+	public:
+		/**
+		 * \brief Error reported when the device has been disconnected.
+		 * Matches \c ERROR_DEVICE_NOT_CONNECTED so existing Windows handling applies unchanged.
+		 */
+		static constexpr size_t disconnectedError = 1167;
+
+		explicit LoopbackInstance(std::shared_ptr<LoopbackDevice> device);
+		~LoopbackInstance() override;
+
+		bool isOpen() const override;
+
+		bool readMetadata() override;
+		bool readCaps() override;
+		bool readSerial() override;
+		bool readAttributes() override;
+		bool getFeature(const gsl::span<uint8_t>& buffer) const override;
+		bool setFeature(const gsl::span<uint8_t>& buffer) const override;
+
+		bool open(HidOpenFlags_t openFlags) override;
+		void close() override;
+
+		using HidInstance::read;
+		bool read(void* buffer, size_t size) const override;
+
+		bool readAsync() override;
+
+		using HidInstance::write;
+		bool write(const void* buffer, size_t size) const override;
+
+		bool writeAsync() override;
+
+		bool asyncReadInProgress() override;
+		bool asyncWriteInProgress() override;
+
+		void cancelAsyncReadAndWait() override;
+		void cancelAsyncWriteAndWait() override;
+
+		/**
+		 * \brief Sleeps until the next scripted report is due when the clock runs in real time.
+		 * Under a virtual clock, time cannot pass while waiting, so this returns immediately.
+		 */
+		bool waitForRead(std::chrono::microseconds timeout) override;
+		void interruptWait() override;
+
+		using HidInstance::setOutputReport;
+		bool setOutputReport(const gsl::span<uint8_t>& buffer) const override;
+
+	private:
+		bool tryRead(uint8_t* buffer, size_t size) const;
+		bool checkConnected() const;
+
+		/**
+		 * \brief Checks without blocking if a wait on this instance would return.
+		 * \param due Lowered to the time of the next scripted report if none is due yet.
+		 */
+		bool readyForRead(LoopbackClock::duration& due);
+		bool consumeWake();
+	};
+
+	/**
+	 * \brief In-memory backend for deterministic tests and benchmarks of the device loop.
+	 * Devices are added with \c addDevice and then enumerated like real hardware.
+	 */
+	class LoopbackBackend : public HidBackend
+	{
+		mutable std::mutex sync;
+		std::vector<std::shared_ptr<LoopbackDevice>> devices_;
+
+	public:
+		const std::shared_ptr<LoopbackClock> clock;
+
+		explicit LoopbackBackend(std::shared_ptr<LoopbackClock> clock = std::make_shared<LoopbackClock>());
+
+		const char* name() const override;
+
+		using HidBackend::create;
+		std::shared_ptr<HidInstance> create(const std::wstring& path, const std::wstring& instanceId) override;
+		void enumerate(const std::function<bool(const std::wstring& path, const std::wstring& instanceId)>& fn) override;
+		bool waitAny(const std::vector<HidInstance*>& instances, std::chrono::microseconds timeout, std::vector<HidInstance*>& ready) override;
+
+		/**
+		 * \brief Adds a device. Its path defaults to \c "loopback:<n>" if left empty.
+		 */
+		std::shared_ptr<LoopbackDevice> addDevice(HidCaps caps, HidAttributes attributes, std::wstring serialString = {}, std::wstring path = {});
+		void removeDevice(const std::shared_ptr<LoopbackDevice>& device);
+
+		std::vector<std::shared_ptr<LoopbackDevice>> devices() const;
+		std::shared_ptr<LoopbackDevice> find(const std::wstring& path) const;
+	};
+}
@@ -1,13 +1,19 @@
+#ifdef _WIN32
 #include <Windows.h>
 #include <initguid.h> // for GUID_DEVINTERFACE_USB_HUB
 #include <usbiodef.h>
 #include <hidsdi.h>
 #include <SetupAPI.h>
+#endif
+
 #include <functional>
 
+#include "hid_backend.h"
 #include "hid_instance.h"
 #include "hid_util.h"
 
+#ifdef _WIN32
+
 // TODO: handle *A and *W variants of these methods and structures!
 
 template <typename T>
@@ -121,14 +127,25 @@ bool hid::enumerateGuid(const std::function<bool(const std::wstring& path, const
 	return false;
 }
 
+void hid::enumerateUsb(const std::function<bool(const std::wstring& path, const std::wstring& instanceId)>& fn) noexcept
+{
+	enumerateGuid(fn, GUID_DEVINTERFACE_USB_HUB);
+}
+
+#endif
+
 void hid::enumerateHid(const std::function<bool(std::shared_ptr<HidInstance> instance)>& fn) noexcept
 {
-	GUID guid = {};
-	HidD_GetHidGuid(&guid);
+	const auto backend_ = backend();
 
-	const auto callback = [fn](const std::wstring& path, const std::wstring& instanceId) -> bool
+	if (backend_ == nullptr)
 	{
-		auto hid = std::make_shared<HidInstance>(path, instanceId);
+		return;
+	}
+
+	const auto callback = [&](const std::wstring& path, const std::wstring& instanceId) -> bool
+	{
+		auto hid = backend_->create(path, instanceId);
 
 		if (hid->readMetadata())
 		{
@@ -138,10 +155,5 @@ void hid::enumerateHid(const std::function<bool(std::shared_ptr<HidInstance> ins
 		return false;
 	};
 
-	enumerateGuid(callback, guid);
-}
-
-void hid::enumerateUsb(const std::function<bool(const std::wstring& path, const std::wstring& instanceId)>& fn) noexcept
-{
-	enumerateGuid(fn, GUID_DEVINTERFACE_USB_HUB);
+	backend_->enumerate(callback);
 }
@@ -1,21 +1,32 @@
 #pragma once
 
+#ifdef _WIN32
 // Windows
 #include <Windows.h>
 #include <SetupAPI.h>
+#endif
 
 // STL
 #include <functional>
 #include <memory>
+#include <string>
 
 // libhid
 #include "hid_instance.h"
 
 namespace hid
 {
+#ifdef _WIN32
 	std::wstring getDevicePath(HDEVINFO devInfoSet, SP_DEVICE_INTERFACE_DATA* interface, SP_DEVINFO_DATA* data = nullptr) noexcept;
 	std::wstring getInstanceId(HDEVINFO devInfoSet, SP_DEVINFO_DATA* devInfoData) noexcept;
 	bool enumerateGuid(const std::function<bool(const std::wstring& path, const std::wstring& instanceId)>& fn, const GUID& guid) noexcept;
-	void enumerateHid(const std::function<bool(std::shared_ptr<HidInstance> instance)>& fn) noexcept;
 	void enumerateUsb(const std::function<bool(const std::wstring& path, const std::wstring& instanceId)>& fn) noexcept;
+#endif
+
+	/**
+	 * \brief Enumerates HID devices through the active \c HidBackend and reads their metadata.
+	 * \param fn Callback; return \c true to stop enumeration.
+	 * \sa backend
+	 */
+	void enumerateHid(const std::function<bool(std::shared_ptr<HidInstance> instance)>& fn) noexcept;
 }
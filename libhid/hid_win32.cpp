@@ -0,0 +1,673 @@
+#ifdef _WIN32
+
+#include <Windows.h>
+#include <hidsdi.h>
+#include <hidpi.h>
+
+#include <algorithm>
+#include <utility>
+
+#include "hid_handle.h"
+#include "hid_util.h"
+#include "hid_win32.h"
+
+using namespace hid;
+
+namespace
+{
+	DWORD waitMilliseconds(std::chrono::microseconds timeout)
+	{
+		if (timeout == HidInstance::infiniteWait)
+		{
+			return INFINITE;
+		}
+
+		// round up so that short timeouts don't degrade into a busy loop
+		const auto ms = std::chrono::ceil<std::chrono::milliseconds>(std::max(timeout, std::chrono::microseconds::zero()));
+		return static_cast<DWORD>(std::min<int64_t>(ms.count(), INFINITE - 1));
+	}
+}
+
+Win32HidInstance::Win32HidInstance(std::wstring path, std::wstring instanceId)
+	: HidInstance(std::move(path), std::move(instanceId))
+{
+	createEvents();
+}
+
+Win32HidInstance::Win32HidInstance(std::wstring path)
+	: HidInstance(std::move(path))
+{
+	createEvents();
+}
+
+Win32HidInstance::~Win32HidInstance()
+{
+	close();
+}
+
+bool Win32HidInstance::isOpen() const
+{
+	return handle.isValid();
+}
+
+bool Win32HidInstance::readMetadata()
+{
+	if (isOpen())
+	{
+		return (readCaps() | readAttributes() | readSerial());
+	}
+
+	nativeError_ = 0;
+
+	const Handle h = Handle(CreateFile(path.c_str(),
+	                                   GENERIC_READ,
+	                                   FILE_SHARE_READ | FILE_SHARE_WRITE,
+	                                   nullptr,
+	                                   OPEN_EXISTING,
+	                                   0,
+	                                   nullptr),
+	                        true);
+
+	if (!h.isValid())
+	{
+		nativeError_ = GetLastError();
+		return false;
+	}
+
+	return (readCaps(h.nativeHandle) | readAttributes(h.nativeHandle) | readSerial(h.nativeHandle));
+}
+
+bool Win32HidInstance::readCaps()
+{
+	return readCaps(handle.nativeHandle);
+}
+
+bool Win32HidInstance::readSerial()
+{
+	return readSerial(handle.nativeHandle);
+}
+
+bool Win32HidInstance::readAttributes()
+{
+	return readAttributes(handle.nativeHandle);
+}
+
+bool Win32HidInstance::getFeature(const gsl::span<uint8_t>& buffer) const
+{
+	nativeError_ = 0;
+
+	try
+	{
+		if (isOpen())
+		{
+			if (!HidD_GetFeature(handle.nativeHandle, buffer.data(), static_cast<ULONG>(buffer.size_bytes())))
+			{
+				nativeError_ = GetLastError();
+				return false;
+			}
+
+			return true;
+		}
+
+		const Handle h = Handle(CreateFile(path.c_str(),
+		                                   GENERIC_READ | GENERIC_WRITE,
+		                                   FILE_SHARE_READ | FILE_SHARE_WRITE,
+		                                   nullptr,
+		                                   OPEN_EXISTING,
+		                                   0,
+		                                   nullptr),
+		                        true);
+
+		if (!h.isValid())
+		{
+			nativeError_ = GetLastError();
+			return false;
+		}
+
+		if (!HidD_GetFeature(h.nativeHandle, buffer.data(), static_cast<ULONG>(buffer.size_bytes())))
+		{
+			nativeError_ = GetLastError();
+			return false;
+		}
+
+		return true;
+	}
+	catch (const std::exception&)
+	{
+		// ignored
+		return false;
+	}
+}
+
+bool Win32HidInstance::setFeature(const gsl::span<uint8_t>& buffer) const
+{
+	if (!isOpen())
+	{
+		return false;
+	}
+
+	if (!HidD_SetFeature(handle.nativeHandle, buffer.data(), static_cast<ULONG>(buffer.size_bytes())))
+	{
+		nativeError_ = GetLastError();
+		return false;
+	}
+
+	return true;
+}
+
+bool Win32HidInstance::open(HidOpenFlags_t openFlags)
+{
+	const bool exclusive = !!(openFlags & HidOpenFlags::exclusive);
+
+	if (exclusive != isExclusive())
+	{
+		close();
+	}
+
+	nativeError_ = 0;
+
+	const uint32_t shareFlags = exclusive ? 0 : FILE_SHARE_READ | FILE_SHARE_WRITE;
+	const uint32_t asyncFlags = !!(openFlags & HidOpenFlags::async) ? FILE_FLAG_OVERLAPPED : 0;
+
+	handle = Handle(CreateFile(path.c_str(),
+	                           GENERIC_READ | GENERIC_WRITE,
+	                           shareFlags,
+	                           nullptr,
+	                           OPEN_EXISTING,
+	                           asyncFlags,
+	                           nullptr),
+	                true);
+
+	if (!handle.isValid())
+	{
+		nativeError_ = GetLastError();
+		return false;
+	}
+
+	flags = openFlags;
+
+	if (isAsync())
+	{
+		resetOverlapped();
+	}
+
+	return true;
+}
+
+void Win32HidInstance::close()
+{
+	if (isAsync())
+	{
+		cancelAsyncReadAndWait();
+		cancelAsyncWriteAndWait();
+
+		resetOverlapped();
+
+		pendingRead_ = false;
+		pendingWrite_ = false;
+	}
+
+	if (isOpen())
+	{
+		handle.close();
+	}
+
+	flags = 0;
+}
+
+bool Win32HidInstance::read(void* buffer, size_t size) const
+{
+	if (!isOpen())
+	{
+		return false;
+	}
+
+	return ReadFile(handle.nativeHandle, buffer, static_cast<DWORD>(size), nullptr, nullptr) != 0;
+}
+
+bool Win32HidInstance::readAsync()
+{
+	if (!isOpen() || !isAsync() || !postReads())
+	{
+		return false;
+	}
+
+	ReadSlot& slot = readSlots[readHead];
+	DWORD bytesRead = 0;
+
+	if (!GetOverlappedResult(handle.nativeHandle, &slot.overlapped, &bytesRead, FALSE))
+	{
+		const DWORD error = GetLastError();
+
+		switch (error)
+		{
+			case ERROR_IO_INCOMPLETE:
+			case ERROR_IO_PENDING:
+				pendingRead_ = true;
+				return false;
+
+			default:
+				close();
+				nativeError_ = error;
+				return false;
+		}
+	}
+
+	slot.posted = false;
+
+	const size_t size = std::min(static_cast<size_t>(bytesRead), inputBuffer.size());
+	std::copy_n(slot.buffer.begin(), size, inputBuffer.begin());
+
+	readHead = (readHead + 1) % readSlots.size();
+
+	// re-queue the slot behind the reads that are still in flight
+	pendingRead_ = postRead(slot);
+	return true;
+}
+
+bool Win32HidInstance::write(const void* buffer, size_t size) const
+{
+	return WriteFile(handle.nativeHandle, buffer, static_cast<DWORD>(size), nullptr, nullptr);
+}
+
+bool Win32HidInstance::writeAsync()
+{
+	if (pendingWrite_)
+	{
+		return asyncWriteInProgress();
+	}
+
+	pendingWrite_ = !WriteFile(handle.nativeHandle, outputBuffer.data(), static_cast<DWORD>(outputBuffer.size()), nullptr, &overlappedOut);
+	return !pendingWrite_;
+}
+
+bool Win32HidInstance::asyncReadInProgress()
+{
+	if (!pendingRead_)
+	{
+		return false;
+	}
+
+	const ReadSlot& slot = readSlots[readHead];
+
+	pendingRead_ = isOpen() && slot.posted && !HasOverlappedIoCompleted(&slot.overlapped);
+	return pendingRead_;
+}
+
+bool Win32HidInstance::asyncWriteInProgress()
+{
+	if (!pendingWrite_)
+	{
+		return false;
+	}
+
+	pendingWrite_ = asyncInProgress(&overlappedOut);
+	return pendingWrite_;
+}
+
+void Win32HidInstance::cancelAsyncReadAndWait()
+{
+	if (!isOpen() || !isAsync())
+	{
+		return;
+	}
+
+	for (ReadSlot& slot : readSlots)
+	{
+		if (slot.posted)
+		{
+			cancelAsyncAndWait(&slot.overlapped);
+			slot.posted = false;
+		}
+	}
+
+	readHead = 0;
+	pendingRead_ = false;
+}
+
+void Win32HidInstance::cancelAsyncWriteAndWait()
+{
+	if (!isOpen() || !isAsync() || !asyncWritePending())
+	{
+		return;
+	}
+
+	cancelAsyncAndWait(&overlappedOut);
+	pendingWrite_ = false;
+}
+
+bool Win32HidInstance::waitForRead(std::chrono::microseconds timeout)
+{
+	if (readCompleted())
+	{
+		return true;
+	}
+
+	const HANDLE handles[] = { readSlots[readHead].event.nativeHandle, wakeEvent.nativeHandle };
+	return WaitForMultipleObjects(2, handles, FALSE, waitMilliseconds(timeout)) == WAIT_OBJECT_0;
+}
+
+void Win32HidInstance::interruptWait()
+{
+	SetEvent(wakeEvent.nativeHandle);
+}
+
+bool Win32HidInstance::setOutputReport(const gsl::span<uint8_t>& buffer) const
+{
+	if (!isOpen())
+	{
+		return false;
+	}
+
+	if (!HidD_SetOutputReport(handle.nativeHandle, reinterpret_cast<PVOID>(buffer.data()), static_cast<ULONG>(buffer.size_bytes())))
+	{
+		nativeError_ = GetLastError();
+		return false;
+	}
+
+	return true;
+}
+
+void Win32HidInstance::createEvents()
+{
+	for (ReadSlot& slot : readSlots)
+	{
+		slot.event = Handle(CreateEvent(nullptr, TRUE, FALSE, nullptr), true);
+	}
+
+	writeEvent = Handle(CreateEvent(nullptr, TRUE, FALSE, nullptr), true);
+	wakeEvent  = Handle(CreateEvent(nullptr, FALSE, FALSE, nullptr), true);
+}
+
+void Win32HidInstance::resetOverlapped()
+{
+	for (ReadSlot& slot : readSlots)
+	{
+		slot.overlapped = {};
+		slot.overlapped.hEvent = slot.event.nativeHandle;
+		slot.posted = false;
+	}
+
+	readHead = 0;
+
+	overlappedOut = {};
+	overlappedOut.hEvent = writeEvent.nativeHandle;
+}
+
+bool Win32HidInstance::postRead(ReadSlot& slot)
+{
+	if (slot.buffer.size() != inputBuffer.size())
+	{
+		slot.buffer.resize(inputBuffer.size());
+	}
+
+	slot.overlapped = {};
+	slot.overlapped.hEvent = slot.event.nativeHandle;
+
+	if (!ReadFile(handle.nativeHandle, slot.buffer.data(), static_cast<DWORD>(slot.buffer.size()), nullptr, &slot.overlapped))
+	{
+		const DWORD error = GetLastError();
+
+		if (error != ERROR_IO_PENDING)
+		{
+			close();
+			nativeError_ = error;
+			return false;
+		}
+	}
+
+	// a read that completed immediately is still collected through GetOverlappedResult
+	slot.posted = true;
+	return true;
+}
+
+bool Win32HidInstance::readCompleted() const
+{
+	const ReadSlot& slot = readSlots[readHead];
+	return !isOpen() || !isAsync() || !slot.posted || HasOverlappedIoCompleted(&slot.overlapped);
+}
+
+bool Win32HidInstance::postReads()
+{
+	for (size_t i = 0; i < readSlots.size(); ++i)
+	{
+		ReadSlot& slot = readSlots[(readHead + i) % readSlots.size()];
+
+		if (!slot.posted && !postRead(slot))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void Win32HidInstance::cancelAsyncAndWait(OVERLAPPED* overlapped)
+{
+	const bool cancelSuccess = CancelIoEx(handle.nativeHandle, overlapped) != 0;
+
+	if (cancelSuccess)
+	{
+		DWORD bytesWritten = 0;
+		GetOverlappedResult(handle.nativeHandle, overlapped, &bytesWritten, TRUE);
+		return;
+	}
+
+	const DWORD error = GetLastError();
+
+	switch (error)
+	{
+		case ERROR_NOT_FOUND:
+		case ERROR_OPERATION_ABORTED:
+			return;
+
+		default:
+			throw;
+	}
+}
+
+bool Win32HidInstance::asyncInProgress(OVERLAPPED* overlapped)
+{
+	if (!isOpen() || !isAsync())
+	{
+		return false;
+	}
+
+	DWORD bytesWritten = 0;
+	const bool result = GetOverlappedResult(handle.nativeHandle, overlapped, &bytesWritten, FALSE) != 0;
+
+	if (result)
+	{
+		return false;
+	}
+
+	const DWORD error = GetLastError();
+
+	switch (error)
+	{
+		case ERROR_SUCCESS:
+			return false;
+
+		case ERROR_IO_INCOMPLETE:
+		case ERROR_IO_PENDING:
+			return true;
+
+		default:
+			close();
+			nativeError_ = error;
+			return false;
+	}
+}
+
+bool Win32HidInstance::readCaps(HANDLE h)
+{
+	bool result;
+
+	nativeError_ = 0;
+
+	HIDP_CAPS c = {};
+	PHIDP_PREPARSED_DATA ptr = nullptr;
+
+	if ((result = !!HidD_GetPreparsedData(h, &ptr)))
+	{
+		if ((result = !!HidP_GetCaps(ptr, &c)))
+		{
+			caps_.usage = c.Usage;
+			caps_.usagePage = c.UsagePage;
+			caps_.inputReportSize = c.InputReportByteLength;
+			caps_.outputReportSize = c.OutputReportByteLength;
+			caps_.featureReportSize = c.FeatureReportByteLength;
+			caps_.linkCollectionNodes = c.NumberLinkCollectionNodes;
+			caps_.inputButtonCaps = c.NumberInputButtonCaps;
+			caps_.inputValueCaps = c.NumberInputValueCaps;
+			caps_.inputDataIndices = c.NumberInputDataIndices;
+			caps_.outputButtonCaps = c.NumberOutputButtonCaps;
+			caps_.outputValueCaps = c.NumberOutputValueCaps;
+			caps_.outputDataIndices = c.NumberOutputDataIndices;
+			caps_.featureButtonCaps = c.NumberFeatureButtonCaps;
+			caps_.featureValueCaps = c.NumberFeatureValueCaps;
+			caps_.featureDataIndices = c.NumberFeatureDataIndices;
+		}
+		else
+		{
+			nativeError_ = GetLastError();
+		}
+
+		HidD_FreePreparsedData(ptr);
+	}
+	else
+	{
+		nativeError_ = GetLastError();
+	}
+
+	if (result)
+	{
+		inputBuffer.resize(caps().inputReportSize);
+		outputBuffer.resize(caps().outputReportSize);
+	}
+
+	return result;
+}
+
+bool Win32HidInstance::readSerial(HANDLE h)
+{
+	nativeError_ = 0;
+
+	// 4093 is the maximum allowed size according to Microsoft's documentation for HidD_GetSerialNumberString.
+	std::vector<uint8_t> buffer(4093);
+
+	const bool result = HidD_GetSerialNumberString(h, buffer.data(), static_cast<ULONG>(buffer.size())) != 0;
+
+	if (!result)
+	{
+		nativeError_ = GetLastError();
+		return result;
+	}
+
+	auto* wstr_ptr = reinterpret_cast<wchar_t*>(buffer.data());
+	const size_t length = wcsnlen(wstr_ptr, buffer.size());
+	serialString = std::wstring(wstr_ptr, length);
+
+	return result;
+}
+
+bool Win32HidInstance::readAttributes(HANDLE h)
+{
+	nativeError_ = 0;
+
+	HIDD_ATTRIBUTES attributes {};
+	const bool result = HidD_GetAttributes(h, &attributes);
+
+	attributes_.vendorId = attributes.VendorID;
+	attributes_.productId = attributes.ProductID;
+	attributes_.versionNumber = attributes.VersionNumber;
+
+	if (!result)
+	{
+		nativeError_ = GetLastError();
+	}
+
+	return result;
+}
+
+const char* Win32HidBackend::name() const
+{
+	return "win32";
+}
+
+std::shared_ptr<HidInstance> Win32HidBackend::create(const std::wstring& path, const std::wstring& instanceId)
+{
+	return std::make_shared<Win32HidInstance>(path, instanceId);
+}
+
+void Win32HidBackend::enumerate(const std::function<bool(const std::wstring& path, const std::wstring& instanceId)>& fn)
+{
+	GUID guid = {};
+	HidD_GetHidGuid(&guid);
+
+	enumerateGuid(fn, guid);
+}
+
+bool Win32HidBackend::waitAny(const std::vector<HidInstance*>& instances, std::chrono::microseconds timeout, std::vector<HidInstance*>& ready)
+{
+	ready.clear();
+
+	std::array<HANDLE, MAXIMUM_WAIT_OBJECTS> handles {};
+	DWORD count = 0;
+
+	for (HidInstance* instance : instances)
+	{
+		const auto win32 = static_cast<Win32HidInstance*>(instance);
+
+		if (win32->readCompleted())
+		{
+			ready.push_back(instance);
+			continue;
+		}
+
+		if (count + 2 > handles.size())
+		{
+			break;
+		}
+
+		handles[count++] = win32->readSlots[win32->readHead].event.nativeHandle;
+		handles[count++] = win32->wakeEvent.nativeHandle;
+	}
+
+	if (!ready.empty() || !count)
+	{
+		return !ready.empty();
+	}
+
+	const DWORD result = WaitForMultipleObjects(count, handles.data(), FALSE, waitMilliseconds(timeout));
+
+	if (result == WAIT_TIMEOUT || result == WAIT_FAILED)
+	{
+		return false;
+	}
+
+	// The wait consumed the wake event that ended it (if any); the
+	// others are checked (and consumed) individually below.
+	const DWORD signaled = result - WAIT_OBJECT_0;
+
+	for (DWORD i = 0; i < count; i += 2)
+	{
+		HidInstance* instance = instances[i / 2];
+		const auto win32 = static_cast<Win32HidInstance*>(instance);
+
+		if (i + 1 == signaled || win32->readCompleted() ||
+		    WaitForSingleObject(handles[i + 1], 0) == WAIT_OBJECT_0)
+		{
+			ready.push_back(instance);
+		}
+	}
+
+	return !ready.empty();
+}
+
+size_t Win32HidBackend::maxWaitCount() const
+{
+	return MAXIMUM_WAIT_OBJECTS / 2;
+}
+
+#endif
@@ -0,0 +1,132 @@
+#pragma once
+
+#ifdef _WIN32
+
+#include <Windows.h>
+
+#include <array>
+#include <vector>
+
+#include "hid_backend.h"
+#include "hid_handle.h"
+#include "hid_instance.h"
+
+namespace hid
+{
+	/**
+	 * \brief \c HidInstance implemented with the Win32 HID API and overlapped I/O.
+	 */
+	class Win32HidInstance : public HidInstance
+	{
+		friend class Win32HidBackend;
+
+	public:
+		/**
+		 * \brief Number of asynchronous reads kept in flight at once.
+		 */
+		static constexpr size_t readQueueSize = 4;
+
+	private:
+		struct ReadSlot
+		{
+			OVERLAPPED overlapped = {};
+			Handle event;
+			std::vector<uint8_t> buffer;
+			bool posted = false;
+		};
+
+		Handle handle = Handle(nullptr, true);
+
+		// Reads are posted and completed in ring order starting at readHead,
+		// so reports that arrive while the owning thread is busy queue up here.
+		std::array<ReadSlot, readQueueSize> readSlots;
+		size_t readHead = 0;
+
+		OVERLAPPED overlappedOut = {};
+
+		// manual-reset events signaled by overlapped I/O; they live as long as the
+		// instance so that a thread waiting on them survives a concurrent close()
+		Handle writeEvent;
+		Handle wakeEvent;
+
+	public:
+		Win32HidInstance(std::wstring path, std::wstring instanceId);
+		explicit Win32HidInstance(std::wstring path);
+
+		~Win32HidInstance() override;
+
+		bool isOpen() const override;
+
+		bool readMetadata() override;
+		bool readCaps() override;
+		bool readSerial() override;
+		bool readAttributes() override;
+		bool getFeature(const gsl::span<uint8_t>& buffer) const override;
+		bool setFeature(const gsl::span<uint8_t>& buffer) const override;
+
+		bool open(HidOpenFlags_t openFlags) override;
+		void close() override;
+
+		using HidInstance::read;
+		bool read(void* buffer, size_t size) const override;
+
+		bool readAsync() override;
+
+		using HidInstance::write;
+		bool write(const void* buffer, size_t size) const override;
+
+		bool writeAsync() override;
+
+		bool asyncReadInProgress() override;
+		bool asyncWriteInProgress() override;
+
+		void cancelAsyncReadAndWait() override;
+		void cancelAsyncWriteAndWait() override;
+
+		bool waitForRead(std::chrono::microseconds timeout) override;
+		void interruptWait() override;
+
+		using HidInstance::setOutputReport;
+		bool setOutputReport(const gsl::span<uint8_t>& buffer) const override;
+
+	private:
+		void createEvents();
+		void resetOverlapped();
+
+		bool postRead(ReadSlot& slot);
+		bool postReads();
+
+		/**
+		 * \brief Indicates that a wait on this instance would return immediately.
+		 */
+		bool readCompleted() const;
+
+		void cancelAsyncAndWait(OVERLAPPED* overlapped);
+		bool asyncInProgress(OVERLAPPED* overlapped);
+
+		bool readCaps(HANDLE h);
+		bool readSerial(HANDLE h);
+		bool readAttributes(HANDLE h);
+	};
+
+	/**
+	 * \brief Enumerates devices through SetupAPI and creates \c Win32HidInstance objects.
+	 */
+	class Win32HidBackend : public HidBackend
+	{
+	public:
+		const char* name() const override;
+
+		using HidBackend::create;
+		std::shared_ptr<HidInstance> create(const std::wstring& path, const std::wstring& instanceId) override;
+		void enumerate(const std::function<bool(const std::wstring& path, const std::wstring& instanceId)>& fn) override;
+		bool waitAny(const std::vector<HidInstance*>& instances, std::chrono::microseconds timeout, std::vector<HidInstance*>& ready) override;
+
+		/**
+		 * \brief Each instance needs a read and a wake event, so this is half of \c MAXIMUM_WAIT_OBJECTS.
+		 */
+		size_t maxWaitCount() const override;
+	};
+}
+
+#endif